@@ -68,6 +68,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "weapon.h"
 #include "gameconfigfile.h"
 #include "gamecontrol.h"
+#include "timedemo.h"
 #include "m_argv.h"
 #include "statistics.h"
 #include "menu/menu.h"
@@ -777,6 +778,7 @@ bool gRestartGame = false;
 
 void ProcessFrame(void)
 {
+    FTimeDemoSection timedemo(TDS_Game);
     char buffer[128];
     for (int i = connecthead; i >= 0; i = connectpoint2[i])
     {
@@ -1146,6 +1148,14 @@ int GameInterface::app_main()
     LoadSavedInfo();
     gDemo.LoadDemoInfo();
     Printf("There are %d demo(s) in the loop\n", gDemo.at59ef);
+    const char* timedemo = TIMEDEMO_GetDemo();
+    if (timedemo)
+    {
+        // Played once instead of the demo loop, CDemo::Playback quits when it is over.
+        if (!gDemo.SetupPlayback(timedemo))
+            ThrowError("Unable to play demo %s", timedemo);
+        bQuickStart = 1;
+    }
     Printf("Loading control setup\n");
     ctrlInit();
     timerInit(120);
@@ -1187,7 +1197,7 @@ RESTART:
         goto RESTART;
     }
     UpdateNetworkMenus();
-    if (!gDemo.at0 && gDemo.at59ef > 0 && gGameOptions.nGameType == 0 && !bNoDemo && demo_playloop)
+    if (!gDemo.at0 && gDemo.at59ef > 0 && gGameOptions.nGameType == 0 && !bNoDemo && demo_playloop && !timedemo)
         gDemo.SetupPlayback(NULL);
     gQuitGame = 0;
     gRestartGame = 0;
@@ -1195,7 +1205,7 @@ RESTART:
     {
         inputState.ClearAllInput();
     }
-    else if (gDemo.at1 && !bAddUserMap && !bNoDemo && demo_playloop)
+    else if (gDemo.at1 && ((!bAddUserMap && !bNoDemo && demo_playloop) || timedemo))
         gDemo.Playback();
     if (gDemo.at59ef > 0)
         M_ClearMenus();
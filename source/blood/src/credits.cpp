@@ -25,7 +25,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include "build.h"
 #include "compat.h"
-#include "SmackerDecoder.h"
+#include "movieplayer.h"
 #include "common_game.h"
 #include "blood.h"
 #include "config.h"
@@ -38,6 +38,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "animtexture.h"
 #include "../glbackend/glbackend.h"
 #include "raze_sound.h"
+#include "i_time.h"
 
 BEGIN_BLD_NS
 
@@ -161,21 +162,14 @@ void credPlaySmk(const char *_pzSMK, const char *_pzWAV, int nWav)
     {
         return;
     }
-    SmackerHandle hSMK = Smacker_Open(pzSMK);
-    if (!hSMK.isValid)
+    auto decoder = OpenMovieDecoder(pzSMK);
+    if (!decoder)
     {
         return;
     }
-    uint32_t nWidth, nHeight;
-    Smacker_GetFrameSize(hSMK, nWidth, nHeight);
-    uint8_t palette[768];
-    AnimTextures animtex;
-    TArray<uint8_t> pFrame(nWidth * nHeight + std::max(nWidth, nHeight), true);
-    animtex.SetSize(nWidth, nHeight);
-    int nFrameRate = Smacker_GetFrameRate(hSMK);
-    int nFrames = Smacker_GetNumFrames(hSMK);
-
-    Smacker_GetPalette(hSMK, palette);
+    MoviePlayer player(decoder);
+    uint32_t nWidth = player.GetWidth(), nHeight = player.GetHeight();
+
     Mus_Stop();
 
     int nScale;
@@ -212,35 +206,36 @@ void credPlaySmk(const char *_pzSMK, const char *_pzWAV, int nWav)
     UpdateDacs(0, true);
 
     gameHandleEvents();
-    ClockTicks nStartTime = totalclock;
+    uint64_t nStartTime = I_msTime();
 
     inputState.ClearAllInput();
     
-    int nFrame = 0;
+    // Frames are decoded on the player's thread and shown when they are due.
+    int nFrame = -1;
     hw_int_useindexedcolortextures = false;
     do
     {
         gameHandleEvents();
-        if (scale((int)(totalclock-nStartTime), nFrameRate, kTicRate) < nFrame)
-            continue;
 
         if (inputState.CheckAllInput())
             break;
 
+        uint64_t nTime = I_msTime() - nStartTime;
+        auto tex = player.GetFrameAt(nTime);
+        if (!tex || player.GetFrameNumber() == nFrame)
+        {
+            player.WaitForFrame(nTime);
+            continue;
+        }
+        nFrame = player.GetFrameNumber();
+
         videoClearScreen(0);
-        Smacker_GetPalette(hSMK, palette);
-        Smacker_GetFrame(hSMK, pFrame.Data());
-        animtex.SetFrame(palette, pFrame.Data());
-        rotatesprite_fs(160<<16, 100<<16, nScale, 0, -1, 0, 0, nStat, animtex.GetFrame());
+        rotatesprite_fs(160<<16, 100<<16, nScale, 0, -1, 0, 0, nStat, tex);
 
         videoNextPage();
-
-        nFrame++;
-        Smacker_GetNextFrame(hSMK);
-    } while(nFrame < nFrames);
+    } while(!player.Finished(I_msTime() - nStartTime));
     hw_int_useindexedcolortextures = hw_useindexedcolortextures;
 
-    Smacker_Close(hSMK);
     inputState.ClearAllInput();
     soundEngine->StopAllChannels();
 }
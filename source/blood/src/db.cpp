@@ -756,6 +756,7 @@ int dbLoadMap(const char *pPath, int *pX, int *pY, int *pZ, short *pAngle, short
     numsectors = mapHeader.at1f;
     numwalls = mapHeader.at21;
     dbInit();
+    sectorGridInvalidate();
     if (byte_1A76C8)
     {
         IOBuffer1.Read(&byte_19AE44, 128);
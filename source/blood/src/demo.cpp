@@ -47,6 +47,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "menu/menu.h"
 #include "gameconfigfile.h"
 #include "findfile.h"
+#include "timedemo.h"
 
 BEGIN_BLD_NS
 
@@ -364,6 +365,8 @@ _DEMOPLAYBACK:
                 if (v4 >= atf.nInputCount)
                 {
                     ready2send = 0;
+                    if (TIMEDEMO_GetDemo())
+                        TIMEDEMO_DemoEnded();
                     if (at59ef != 1)
                     {
                         v4 = 0;
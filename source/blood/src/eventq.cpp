@@ -39,6 +39,13 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "view.h"
 #include "nnexts.h"
 #include "secrets.h"
+#ifdef _DEBUG
+#include "c_dispatch.h"
+#include "printf.h"
+#include "v_text.h"
+#include "stats.h"
+#include <set>
+#endif
 
 BEGIN_BLD_NS
 
@@ -66,16 +73,63 @@ public:
     void Kill(int, int, CALLBACK_ID);
 };
 
+// Events are keyed by their target so that evKill only has to look at the events of that target.
+static uint32_t evKey(const EVENT& evn)
+{
+    return evn.index | (evn.type << 14);
+}
+
+static PriorityQueue<EVENT>* evNewQueue(void)
+{
+    if (VanillaMode())
+        return new VanillaPriorityQueue<EVENT>();
+    else
+        return new KeyedPriorityQueue<EVENT, evKey>();
+}
+
+#ifdef _DEBUG
+enum
+{
+    kEventOpPost,
+    kEventOpKill,
+    kEventOpKillCallback,
+    kEventOpProcess,
+};
+
+struct EventQueueOp
+{
+    uint8_t op;
+    unsigned int nTime;
+    EVENT event;
+};
+
+// Queue traffic recorded for bench_eventq.
+static TArray<EventQueueOp> evRecording;
+static bool evRecord;
+
+static void evRecordOp(int op, unsigned int nTime, const EVENT& event)
+{
+    evRecording.Push({ (uint8_t)op, nTime, event });
+}
+#endif
+
 EventQueue eventQ;
 void EventQueue::Kill(int a1, int a2)
 {
-    PQueue->Kill([=](EVENT nItem)->bool {return nItem.index == a1 && nItem.type == a2; });
+    EVENT evn = { (unsigned int)a1, (unsigned int)a2 };
+#ifdef _DEBUG
+    if (evRecord) evRecordOp(kEventOpKill, 0, evn);
+#endif
+    PQueue->KillKey(evKey(evn), [=](EVENT nItem)->bool {return nItem.index == a1 && nItem.type == a2; });
 }
 
 void EventQueue::Kill(int a1, int a2, CALLBACK_ID a3)
 {
     EVENT evn = { (unsigned int)a1, (unsigned int)a2, kCmdCallback, (unsigned int)a3 };
-    PQueue->Kill([=](EVENT nItem)->bool {return !memcmp(&nItem, &evn, sizeof(EVENT)); });
+#ifdef _DEBUG
+    if (evRecord) evRecordOp(kEventOpKillCallback, 0, evn);
+#endif
+    PQueue->KillKey(evKey(evn), [=](EVENT nItem)->bool {return !memcmp(&nItem, &evn, sizeof(EVENT)); });
 }
 
 RXBUCKET rxBucket[kChannelMax+1];
@@ -267,10 +321,7 @@ void evInit(void)
 {
     if (eventQ.PQueue)
         delete eventQ.PQueue;
-    if (VanillaMode())
-        eventQ.PQueue = new VanillaPriorityQueue<EVENT>();
-    else
-        eventQ.PQueue = new StdPriorityQueue<EVENT>();
+    eventQ.PQueue = evNewQueue();
     eventQ.PQueue->Clear();
     int nCount = 0;
     for (int i = 0; i < numsectors; i++)
@@ -493,6 +544,9 @@ void evPost(int nIndex, int nType, unsigned int nDelta, COMMAND_ID command) {
     evn.index = nIndex;
     evn.type = nType;
     evn.cmd = command;
+#ifdef _DEBUG
+    if (evRecord) evRecordOp(kEventOpPost, (int)gFrameClock+nDelta, evn);
+#endif
     eventQ.PQueue->Insert((int)gFrameClock+nDelta, evn);
 }
 
@@ -502,6 +556,9 @@ void evPost(int nIndex, int nType, unsigned int nDelta, CALLBACK_ID callback) {
     evn.type = nType;
     evn.cmd = kCmdCallback;
     evn.funcID = callback;
+#ifdef _DEBUG
+    if (evRecord) evRecordOp(kEventOpPost, (int)gFrameClock+nDelta, evn);
+#endif
     eventQ.PQueue->Insert((int)gFrameClock+nDelta, evn);
 }
 
@@ -518,6 +575,9 @@ void evProcess(unsigned int nTime)
             bDone = 0;
         if (!bDone)
             break;
+#endif
+#ifdef _DEBUG
+    if (evRecord) evRecordOp(kEventOpProcess, nTime, {});
 #endif
     while(eventQ.IsNotEmpty(nTime))
     {
@@ -568,10 +628,7 @@ void EventQLoadSave::Load()
     if (eventQ.PQueue)
         delete eventQ.PQueue;
     Read(&eventQ, sizeof(eventQ));
-    if (VanillaMode())
-        eventQ.PQueue = new VanillaPriorityQueue<EVENT>();
-    else
-        eventQ.PQueue = new StdPriorityQueue<EVENT>();
+    eventQ.PQueue = evNewQueue();
     int nEvents;
     Read(&nEvents, sizeof(nEvents));
     for (int i = 0; i < nEvents; i++)
@@ -588,10 +645,10 @@ void EventQLoadSave::Load()
 
 void EventQLoadSave::Save()
 {
-    EVENT events[1024];
-    unsigned int eventstime[1024];
     Write(&eventQ, sizeof(eventQ));
     int nEvents = eventQ.PQueue->Size();
+    TArray<EVENT> events(nEvents, true);
+    TArray<unsigned int> eventstime(nEvents, true);
     Write(&nEvents, sizeof(nEvents));
     for (int i = 0; i < nEvents; i++)
     {
@@ -609,6 +666,134 @@ void EventQLoadSave::Save()
     Write(bucketHead, sizeof(bucketHead));
 }
 
+#ifdef _DEBUG
+// The queue used outside vanilla mode before the keyed heap, kept as the
+// reference for bench_eventq.
+template<typename T> class StdPriorityQueue : public PriorityQueue<T>
+{
+public:
+    std::multiset<queueItem<T>> stdQueue;
+    ~StdPriorityQueue()
+    {
+        stdQueue.clear();
+    }
+    uint32_t Size(void) { return stdQueue.size(); };
+    void Clear(void)
+    {
+        stdQueue.clear();
+    }
+    void Insert(uint32_t nPriority, T data)
+    {
+        stdQueue.insert({ nPriority, data });
+    }
+    T Remove(void)
+    {
+        dassert(stdQueue.size() > 0);
+        T data = stdQueue.begin()->at4;
+        stdQueue.erase(stdQueue.begin());
+        return data;
+    }
+    uint32_t LowestPriority(void)
+    {
+        return stdQueue.begin()->at0;
+    }
+    void Kill(std::function<bool(T)> pMatch)
+    {
+        for (auto i = stdQueue.begin(); i != stdQueue.end();)
+        {
+            if (pMatch(i->at4))
+                i = stdQueue.erase(i);
+            else
+                i++;
+        }
+    }
+};
+
+//
+// bench_eventq
+//
+// 'bench_eventq record' starts recording all posted, killed and processed
+// events, 'bench_eventq stop' ends it. Without arguments the recording is
+// replayed against StdPriorityQueue and the keyed queue, and the order in
+// which both hand out the events is compared.
+//
+static double evReplay(PriorityQueue<EVENT>* pQueue, int repeats, TArray<EVENT>& output)
+{
+    cycle_t time;
+    time.Reset();
+
+    for (int r = 0; r < repeats; r++)
+    {
+        output.Clear();
+        pQueue->Clear();
+        time.Clock();
+        for (auto& op : evRecording)
+        {
+            EVENT evn = op.event;
+            switch (op.op)
+            {
+            case kEventOpPost:
+                pQueue->Insert(op.nTime, evn);
+                break;
+            case kEventOpKill:
+                pQueue->KillKey(evKey(evn), [=](EVENT nItem)->bool {return nItem.index == evn.index && nItem.type == evn.type; });
+                break;
+            case kEventOpKillCallback:
+                pQueue->KillKey(evKey(evn), [=](EVENT nItem)->bool {return !memcmp(&nItem, &evn, sizeof(EVENT)); });
+                break;
+            case kEventOpProcess:
+                while (pQueue->Size() > 0 && op.nTime >= pQueue->LowestPriority())
+                    output.Push(pQueue->Remove());
+                break;
+            }
+        }
+        time.Unclock();
+    }
+    return time.TimeMS();
+}
+
+CCMD(bench_eventq)
+{
+    if (argv.argc() > 1 && !stricmp(argv[1], "record"))
+    {
+        evRecording.Clear();
+        evRecord = true;
+        Printf("bench_eventq: recording\n");
+        return;
+    }
+    if (argv.argc() > 1 && !stricmp(argv[1], "stop"))
+    {
+        evRecord = false;
+        Printf("bench_eventq: %u operations recorded\n", evRecording.Size());
+        return;
+    }
+    if (evRecording.Size() == 0)
+    {
+        Printf("bench_eventq: nothing recorded. Use 'bench_eventq record' first\n");
+        return;
+    }
+
+    int const repeats = argv.argc() > 1 ? max(1, (int)strtol(argv[1], nullptr, 10)) : 10;
+    TArray<EVENT> stdoutput, keyedoutput;
+    StdPriorityQueue<EVENT> stdqueue;
+    KeyedPriorityQueue<EVENT, evKey> keyedqueue;
+
+    double stdtime = evReplay(&stdqueue, repeats, stdoutput);
+    double keyedtime = evReplay(&keyedqueue, repeats, keyedoutput);
+
+    unsigned mismatches = abs((int)stdoutput.Size() - (int)keyedoutput.Size());
+    for (unsigned i = 0; i < min(stdoutput.Size(), keyedoutput.Size()); i++)
+        if (memcmp(&stdoutput[i], &keyedoutput[i], sizeof(EVENT)))
+            mismatches++;
+
+    Printf("bench_eventq: %u operations x %d, %u events processed\n", evRecording.Size(), repeats, keyedoutput.Size());
+    Printf("  std::multiset: %.3f ms\n", stdtime);
+    Printf("  keyed heap:    %.3f ms\n", keyedtime);
+    if (mismatches)
+        Printf(TEXTCOLOR_RED "  %u mismatches!\n", mismatches);
+}
+#endif
+
 static EventQLoadSave *myLoadSave;
 
 void EventQLoadSaveConstruct(void)
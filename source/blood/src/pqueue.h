@@ -21,9 +21,9 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 */
 //-------------------------------------------------------------------------
 #pragma once
-#include <set>
 #include <functional>
 #include "common_game.h"
+#include "tarray.h"
 
 BEGIN_BLD_NS
 
@@ -69,6 +69,8 @@ public:
     virtual T Remove(void) = 0;
     virtual uint32_t LowestPriority(void) = 0;
     virtual void Kill(std::function<bool(T)> pMatch) = 0;
+    // Like Kill, but only items with the given key are considered.
+    virtual void KillKey(uint32_t nKey, std::function<bool(T)> pMatch) { Kill(pMatch); }
 };
 
 template<typename T> class VanillaPriorityQueue : public PriorityQueue<T>
@@ -148,42 +150,169 @@ public:
     }
 };
 
-template<typename T> class StdPriorityQueue : public PriorityQueue<T>
+// Binary heap over a pool of nodes, ordered by priority and then by insertion
+// order, so that items of equal priority come out in the order they were
+// inserted, as they did from the std::multiset this replaced. Every node is
+// also linked into a list of the items sharing its key, which lets KillKey
+// remove them without scanning the entire queue.
+template<typename T, uint32_t(*KeyOf)(const T&)> class KeyedPriorityQueue : public PriorityQueue<T>
 {
-public:
-    std::multiset<queueItem<T>> stdQueue;
-    ~StdPriorityQueue()
+    struct Node
+    {
+        uint32_t priority;
+        uint32_t heapPos;
+        uint64_t serial;
+        T data;
+        int prev, next; // key list links, next is also used for the free list
+    };
+    TArray<Node> nodes;
+    TArray<int> heap;
+    TMap<uint32_t, int> keyHeads;
+    int freeList = -1;
+    uint64_t nextSerial = 0;
+
+    bool Before(int a, int b) const
+    {
+        auto& na = nodes[a];
+        auto& nb = nodes[b];
+        return na.priority < nb.priority || (na.priority == nb.priority && na.serial < nb.serial);
+    }
+    void Place(uint32_t pos, int n)
+    {
+        heap[pos] = n;
+        nodes[n].heapPos = pos;
+    }
+    void Upheap(uint32_t pos)
+    {
+        int n = heap[pos];
+        while (pos > 0)
+        {
+            uint32_t parent = (pos - 1) >> 1;
+            if (!Before(n, heap[parent]))
+                break;
+            Place(pos, heap[parent]);
+            pos = parent;
+        }
+        Place(pos, n);
+    }
+    void Downheap(uint32_t pos)
     {
-        stdQueue.clear();
+        int n = heap[pos];
+        uint32_t count = heap.Size();
+        while (true)
+        {
+            uint32_t child = pos * 2 + 1;
+            if (child >= count)
+                break;
+            if (child + 1 < count && Before(heap[child + 1], heap[child]))
+                child++;
+            if (!Before(heap[child], n))
+                break;
+            Place(pos, heap[child]);
+            pos = child;
+        }
+        Place(pos, n);
     }
-    uint32_t Size(void) { return stdQueue.size(); };
+    void Delete(int n)
+    {
+        auto& node = nodes[n];
+        if (node.prev >= 0)
+            nodes[node.prev].next = node.next;
+        else if (node.next >= 0)
+            keyHeads[KeyOf(node.data)] = node.next;
+        else
+            keyHeads.Remove(KeyOf(node.data));
+        if (node.next >= 0)
+            nodes[node.next].prev = node.prev;
+
+        uint32_t pos = node.heapPos;
+        int last;
+        heap.Pop(last);
+        if (last != n)
+        {
+            Place(pos, last);
+            if (pos > 0 && Before(last, heap[(pos - 1) >> 1]))
+                Upheap(pos);
+            else
+                Downheap(pos);
+        }
+        node.next = freeList;
+        freeList = n;
+    }
+public:
+    ~KeyedPriorityQueue() {}
+    uint32_t Size(void) { return heap.Size(); };
     void Clear(void)
     {
-        stdQueue.clear();
+        nodes.Clear();
+        heap.Clear();
+        keyHeads.Clear();
+        freeList = -1;
+        nextSerial = 0;
     }
     void Insert(uint32_t nPriority, T data)
     {
-        stdQueue.insert({ nPriority, data });
+        int n = freeList;
+        if (n >= 0)
+            freeList = nodes[n].next;
+        else
+            n = nodes.Reserve(1);
+
+        auto& node = nodes[n];
+        node.priority = nPriority;
+        node.serial = nextSerial++;
+        node.data = data;
+        node.prev = -1;
+
+        uint32_t key = KeyOf(data);
+        int* head = keyHeads.CheckKey(key);
+        if (head)
+        {
+            node.next = *head;
+            nodes[*head].prev = n;
+            *head = n;
+        }
+        else
+        {
+            node.next = -1;
+            keyHeads.Insert(key, n);
+        }
+        heap.Push(n);
+        Upheap(heap.Size() - 1);
     }
     T Remove(void)
     {
-        dassert(stdQueue.size() > 0);
-        T data = stdQueue.begin()->at4;
-        stdQueue.erase(stdQueue.begin());
+        dassert(heap.Size() > 0);
+        int n = heap[0];
+        T data = nodes[n].data;
+        Delete(n);
         return data;
     }
     uint32_t LowestPriority(void)
     {
-        return stdQueue.begin()->at0;
+        dassert(heap.Size() > 0);
+        return nodes[heap[0]].priority;
     }
     void Kill(std::function<bool(T)> pMatch)
     {
-        for (auto i = stdQueue.begin(); i != stdQueue.end();)
+        TArray<int> matches;
+        for (auto n : heap)
         {
-            if (pMatch(i->at4))
-                i = stdQueue.erase(i);
-            else
-                i++;
+            if (pMatch(nodes[n].data))
+                matches.Push(n);
+        }
+        for (auto n : matches)
+            Delete(n);
+    }
+    void KillKey(uint32_t nKey, std::function<bool(T)> pMatch)
+    {
+        int* head = keyHeads.CheckKey(nKey);
+        for (int n = head ? *head : -1; n >= 0;)
+        {
+            int next = nodes[n].next;
+            if (pMatch(nodes[n].data))
+                Delete(n);
+            n = next;
         }
     }
 };
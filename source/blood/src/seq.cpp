@@ -40,6 +40,12 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "tile.h"
 #include "view.h"
 #include "raze_sound.h"
+#ifdef _DEBUG
+#include "c_dispatch.h"
+#include "printf.h"
+#include "v_text.h"
+#include "stats.h"
+#endif
 
 BEGIN_BLD_NS
 
@@ -48,6 +54,7 @@ BEGIN_BLD_NS
 
 static ACTIVE activeList[kMaxSequences];
 static int activeCount = 0;
+static SEQINST *activeInst[kMaxSequences];
 static int nClients = 0;
 static void(*clientCallback[kMaxClients])(int, int);
 
@@ -93,6 +100,70 @@ SEQINST siFloor[kMaxXSectors];
 SEQINST siSprite[kMaxXSprites];
 SEQINST siMasked[kMaxXWalls];
 
+// activeList slot of every running instance, so that neither spawning nor
+// killing has to search the list. activeInst holds the instance of every
+// slot for seqProcess. Neither is saved, both are rebuilt after loading.
+static short activeWall[kMaxXWalls];
+static short activeCeiling[kMaxXSectors];
+static short activeFloor[kMaxXSectors];
+static short activeSprite[kMaxXSprites];
+static short activeMasked[kMaxXWalls];
+
+#ifdef _DEBUG
+enum
+{
+    kSeqOpAdd,
+    kSeqOpRestart,
+    kSeqOpRemove,
+    kSeqOpProcess,
+    kSeqOpKillAll,
+};
+
+struct SeqOp
+{
+    uint8_t op;
+    uint8_t type;
+    uint16_t xindex;
+};
+
+// Active list traffic recorded for bench_seq.
+static TArray<SeqOp> seqRecording;
+static bool seqRecord;
+
+static void seqRecordOp(int op, int type, int xindex)
+{
+    seqRecording.Push({ (uint8_t)op, (uint8_t)type, (uint16_t)xindex });
+}
+#endif
+
+static short &ActiveSlot(int type, int xindex)
+{
+    switch (type)
+    {
+    case 0:
+        return activeWall[xindex];
+    case 1:
+        return activeCeiling[xindex];
+    case 2:
+        return activeFloor[xindex];
+    case 3:
+        return activeSprite[xindex];
+    default:
+        return activeMasked[xindex];
+    }
+}
+
+static void RemoveActive(int i)
+{
+#ifdef _DEBUG
+    if (seqRecord) seqRecordOp(kSeqOpRemove, activeList[i].type, activeList[i].xindex);
+#endif
+    activeCount--;
+    activeList[i] = activeList[activeCount];
+    activeInst[i] = activeInst[activeCount];
+    ActiveSlot(activeList[i].type, activeList[i].xindex) = i;
+}
+
 void UpdateSprite(int nXSprite, SEQFRAME *pFrame)
 {
     dassert(nXSprite > 0 && nXSprite < kMaxXSprites);
@@ -394,12 +465,11 @@ void seqSpawn(int a1, int a2, int a3, int a4)
         if (hSeq == pInst->hSeq)
             return;
         UnlockInstance(pInst);
-        for (i = 0; i < activeCount; i++)
-        {
-            if (activeList[i].type == a2 && activeList[i].xindex == a3)
-                break;
-        }
-        dassert(i < activeCount);
+        i = ActiveSlot(a2, a3);
+        dassert(i < activeCount && activeList[i].type == a2 && activeList[i].xindex == a3);
+#ifdef _DEBUG
+        if (seqRecord) seqRecordOp(kSeqOpRestart, a2, a3);
+#endif
     }
     Seq *pSeq = (Seq*)gSysRes.Load(hSeq);
     if (memcmp(pSeq->signature, "SEQ\x1a", 4) != 0)
@@ -423,7 +493,12 @@ void seqSpawn(int a1, int a2, int a3, int a4)
         dassert(activeCount < kMaxSequences);
         activeList[activeCount].type = a2;
         activeList[activeCount].xindex = a3;
+        activeInst[activeCount] = pInst;
+        ActiveSlot(a2, a3) = activeCount;
         activeCount++;
+#ifdef _DEBUG
+        if (seqRecord) seqRecordOp(kSeqOpAdd, a2, a3);
+#endif
     }
     pInst->Update(&activeList[i]);
 }
@@ -433,41 +508,25 @@ void seqKill(int a1, int a2)
     SEQINST *pInst = GetInstance(a1, a2);
     if (!pInst || !pInst->at13)
         return;
-    int i;
-    for (i = 0; i < activeCount; i++)
-    {
-        if (activeList[i].type == a1 && activeList[i].xindex == a2)
-            break;
-    }
-    dassert(i < activeCount);
-    activeCount--;
-    activeList[i] = activeList[activeCount];
+    int i = ActiveSlot(a1, a2);
+    dassert(i < activeCount && activeList[i].type == a1 && activeList[i].xindex == a2);
+    RemoveActive(i);
     pInst->at13 = 0;
     UnlockInstance(pInst);
 }
 
 void seqKillAll(void)
 {
-    for (int i = 0; i < kMaxXWalls; i++)
-    {
-        if (siWall[i].at13)
-            UnlockInstance(&siWall[i]);
-        if (siMasked[i].at13)
-            UnlockInstance(&siMasked[i]);
-    }
-    for (int i = 0; i < kMaxXSectors; i++)
-    {
-        if (siCeiling[i].at13)
-            UnlockInstance(&siCeiling[i]);
-        if (siFloor[i].at13)
-            UnlockInstance(&siFloor[i]);
-    }
-    for (int i = 0; i < kMaxXSprites; i++)
+    // Only instances in the active list can be running.
+    for (int i = 0; i < activeCount; i++)
     {
-        if (siSprite[i].at13)
-            UnlockInstance(&siSprite[i]);
+        if (activeInst[i]->at13)
+            UnlockInstance(activeInst[i]);
     }
     activeCount = 0;
+#ifdef _DEBUG
+    if (seqRecord) seqRecordOp(kSeqOpKillAll, 0, 0);
+#endif
 }
 
 int seqGetStatus(int a1, int a2)
@@ -488,9 +547,12 @@ int seqGetID(int a1, int a2)
 
 void seqProcess(int a1)
 {
+#ifdef _DEBUG
+    if (seqRecord) seqRecordOp(kSeqOpProcess, 0, 0);
+#endif
     for (int i = 0; i < activeCount; i++)
     {
-        SEQINST *pInst = GetInstance(activeList[i].type, activeList[i].xindex);
+        SEQINST *pInst = activeInst[i];
         Seq *pSeq = pInst->pSequence;
         dassert(pInst->frameIndex < pSeq->nFrames);
         pInst->at10 -= a1;
@@ -533,7 +595,7 @@ void seqProcess(int a1)
                         }
                         }
                     }
-                    activeList[i--] = activeList[--activeCount];
+                    RemoveActive(i--);
                     break;
                 }
             }
@@ -542,6 +604,174 @@ void seqProcess(int a1)
     }
 }
 
+#ifdef _DEBUG
+static volatile int seqBenchSink;
+
+// The active list as it was kept before: every restart and kill searches the
+// list, every tick looks up the instance, and killing everything walks all
+// instance arrays.
+static double seqReplayLinear(int repeats, TArray<ACTIVE>& output, unsigned& checksum)
+{
+    cycle_t time;
+    time.Reset();
+    TArray<ACTIVE> list(kMaxSequences, true);
+
+    for (int r = 0; r < repeats; r++)
+    {
+        int count = 0;
+        checksum = 0;
+        time.Clock();
+        for (auto& op : seqRecording)
+        {
+            int i;
+            switch (op.op)
+            {
+            case kSeqOpAdd:
+                if (count < kMaxSequences)
+                    list[count++] = { op.type, op.xindex };
+                break;
+            case kSeqOpRestart:
+            case kSeqOpRemove:
+                for (i = 0; i < count; i++)
+                    if (list[i].type == op.type && list[i].xindex == op.xindex)
+                        break;
+                if (i < count && op.op == kSeqOpRemove)
+                    list[i] = list[--count];
+                break;
+            case kSeqOpProcess:
+                for (i = 0; i < count; i++)
+                {
+                    SEQINST *pInst = GetInstance(list[i].type, list[i].xindex);
+                    if (pInst) checksum += pInst->frameIndex + 1;
+                }
+                break;
+            case kSeqOpKillAll:
+            {
+                int running = 0;
+                for (i = 0; i < kMaxXWalls; i++)
+                    running += siWall[i].at13 + siMasked[i].at13;
+                for (i = 0; i < kMaxXSectors; i++)
+                    running += siCeiling[i].at13 + siFloor[i].at13;
+                for (i = 0; i < kMaxXSprites; i++)
+                    running += siSprite[i].at13;
+                seqBenchSink = running;
+                count = 0;
+                break;
+            }
+            }
+        }
+        time.Unclock();
+        output.Resize(count);
+        memcpy(output.Data(), list.Data(), count * sizeof(ACTIVE));
+    }
+    return time.TimeMS();
+}
+
+static double seqReplayIndexed(int repeats, TArray<ACTIVE>& output, unsigned& checksum)
+{
+    cycle_t time;
+    time.Reset();
+    TArray<ACTIVE> list(kMaxSequences, true);
+    TArray<SEQINST*> inst(kMaxSequences, true);
+    TArray<short> slots(5 * 65536, true);
+
+    for (int r = 0; r < repeats; r++)
+    {
+        int count = 0;
+        checksum = 0;
+        for (auto& slot : slots)
+            slot = -1;
+        time.Clock();
+        for (auto& op : seqRecording)
+        {
+            int i;
+            switch (op.op)
+            {
+            case kSeqOpAdd:
+                if (count < kMaxSequences)
+                {
+                    list[count] = { op.type, op.xindex };
+                    inst[count] = GetInstance(op.type, op.xindex);
+                    slots[op.type * 65536 + op.xindex] = count++;
+                }
+                break;
+            case kSeqOpRestart:
+                seqBenchSink = slots[op.type * 65536 + op.xindex];
+                break;
+            case kSeqOpRemove:
+                i = slots[op.type * 65536 + op.xindex];
+                if (i >= 0 && i < count && list[i].type == op.type && list[i].xindex == op.xindex)
+                {
+                    slots[op.type * 65536 + op.xindex] = -1;
+                    count--;
+                    list[i] = list[count];
+                    inst[i] = inst[count];
+                    slots[list[i].type * 65536 + list[i].xindex] = i;
+                }
+                break;
+            case kSeqOpProcess:
+                for (i = 0; i < count; i++)
+                    if (inst[i]) checksum += inst[i]->frameIndex + 1;
+                break;
+            case kSeqOpKillAll:
+            {
+                int running = 0;
+                for (i = 0; i < count; i++)
+                    if (inst[i]) running += inst[i]->at13;
+                seqBenchSink = running;
+                count = 0;
+                break;
+            }
+            }
+        }
+        time.Unclock();
+        output.Resize(count);
+        memcpy(output.Data(), list.Data(), count * sizeof(ACTIVE));
+    }
+    return time.TimeMS();
+}
+
+CCMD(bench_seq)
+{
+    if (argv.argc() > 1 && !stricmp(argv[1], "record"))
+    {
+        seqRecording.Clear();
+        seqRecord = true;
+        Printf("bench_seq: recording\n");
+        return;
+    }
+    if (argv.argc() > 1 && !stricmp(argv[1], "stop"))
+    {
+        seqRecord = false;
+        Printf("bench_seq: %u operations recorded\n", seqRecording.Size());
+        return;
+    }
+    if (seqRecording.Size() == 0)
+    {
+        Printf("bench_seq: nothing recorded. Use 'bench_seq record' first\n");
+        return;
+    }
+
+    int const repeats = argv.argc() > 1 ? max(1, (int)strtol(argv[1], nullptr, 10)) : 10;
+    TArray<ACTIVE> linearoutput, indexedoutput;
+    unsigned linearsum, indexedsum;
+
+    double lineartime = seqReplayLinear(repeats, linearoutput, linearsum);
+    double indexedtime = seqReplayIndexed(repeats, indexedoutput, indexedsum);
+
+    unsigned mismatches = abs((int)linearoutput.Size() - (int)indexedoutput.Size()) + (linearsum != indexedsum);
+    for (unsigned i = 0; i < min(linearoutput.Size(), indexedoutput.Size()); i++)
+        if (linearoutput[i].type != indexedoutput[i].type || linearoutput[i].xindex != indexedoutput[i].xindex)
+            mismatches++;
+
+    Printf("bench_seq: %u operations x %d, %u sequences left running\n", seqRecording.Size(), repeats, indexedoutput.Size());
+    Printf("  linear search: %.3f ms\n", lineartime);
+    Printf("  slot index:    %.3f ms\n", indexedtime);
+    if (mismatches)
+        Printf(TEXTCOLOR_RED "  %u mismatches!\n", mismatches);
+}
+#endif
+
 class SeqLoadSave : public LoadSave {
     virtual void Load(void);
     virtual void Save(void);
@@ -578,6 +808,8 @@ void SeqLoadSave::Load(void)
     for (int i = 0; i < activeCount; i++)
     {
         SEQINST *pInst = GetInstance(activeList[i].type, activeList[i].xindex);
+        activeInst[i] = pInst;
+        ActiveSlot(activeList[i].type, activeList[i].xindex) = i;
         if (pInst->at13)
         {
             int nSeq = pInst->at8;
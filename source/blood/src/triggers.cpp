@@ -820,9 +820,11 @@ void PathSound(int nSector, int nSound)
 
 void DragPoint(int nWall, int x, int y)
 {
+    sectorGridBeginUpdate();
     viewInterpolateWall(nWall, &wall[nWall]);
     wall[nWall].x = x;
     wall[nWall].y = y;
+    sectorGridUpdateSector(sectorofwall(nWall));
 
     int vsi = numwalls;
     int vb = nWall;
@@ -834,6 +836,7 @@ void DragPoint(int nWall, int x, int y)
             viewInterpolateWall(vb, &wall[vb]);
             wall[vb].x = x;
             wall[vb].y = y;
+            sectorGridUpdateSector(sectorofwall(vb));
         }
         else
         {
@@ -846,6 +849,7 @@ void DragPoint(int nWall, int x, int y)
                     viewInterpolateWall(vb, &wall[vb]);
                     wall[vb].x = x;
                     wall[vb].y = y;
+                    sectorGridUpdateSector(sectorofwall(vb));
                 }
                 else
                     break;
@@ -855,6 +859,7 @@ void DragPoint(int nWall, int x, int y)
         }
         vsi--;
     } while (vb != nWall && vsi > 0);
+    sectorGridEndUpdate();
 }
 
 void TranslateSector(int nSector, int a2, int a3, int a4, int a5, int a6, int a7, int a8, int a9, int a10, int a11, char a12)
@@ -872,6 +877,7 @@ void TranslateSector(int nSector, int a2, int a3, int a4, int a5, int a6, int a7
     int vbp = interpolate(a8, a11, a3);
     int v14 = vbp - v44;
     int nWall = sector[nSector].wallptr;
+    sectorGridBeginUpdate();
     if (a12)
     {
         for (int i = 0; i < sector[nSector].wallnum; nWall++, i++)
@@ -922,6 +928,7 @@ void TranslateSector(int nSector, int a2, int a3, int a4, int a5, int a6, int a7
             }
         }
     }
+    sectorGridEndUpdate();
     for (int nSprite = headspritesect[nSector]; nSprite >= 0; nSprite = nextspritesect[nSprite])
     {
         spritetype *pSprite = &sprite[nSprite];
@@ -900,7 +900,26 @@ void   neartag(int32_t xs, int32_t ys, int32_t zs, int16_t sectnum, int16_t ange
                int32_t (*blacklist_sprite_func)(int32_t)) ATTRIBUTE((nonnull(6,7,8)));
 int32_t   cansee(int32_t x1, int32_t y1, int32_t z1, int16_t sect1,
                  int32_t x2, int32_t y2, int32_t z2, int16_t sect2);
+
+// Caller-owned scratch state for cansee_r(). The visited set is stamped with
+// a generation counter, so starting a new query does not need to clear it.
+// Zero-initialize before first use.
+typedef struct {
+    uint32_t generation;
+    uint32_t visited[MAXSECTORS];
+    int16_t  sectlist[MAXSECTORS];
+} canseectx_t;
+
+int32_t   cansee_r(canseectx_t *ctx, int32_t x1, int32_t y1, int32_t z1, int16_t sect1,
+                   int32_t x2, int32_t y2, int32_t z2, int16_t sect2) ATTRIBUTE((nonnull(1)));
 int32_t   inside(int32_t x, int32_t y, int16_t sectnum);
+void   sectorGridInvalidate(void);
+void   sectorGridUpdateSector(int sectnum);
+void   sectorGridBeginUpdate(void);
+void   sectorGridEndUpdate(void);
+void   sectorGridUpdateWallPtr(void const *ptr);
+int16_t const *sectorGridCandidates(int32_t x, int32_t y, int *count) ATTRIBUTE((nonnull(3)));
+bool   sectorGridInBox(int sectnum, int32_t x, int32_t y);
 void   dragpoint(int16_t pointhighlight, int32_t dax, int32_t day, uint8_t flags);
 void   setfirstwall(int16_t sectnum, int16_t newfirstwall);
 int32_t try_facespr_intersect(uspriteptr_t const spr, vec3_t const in,
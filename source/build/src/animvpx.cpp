@@ -457,7 +457,20 @@ int32_t animvpx_render_frame(animvpx_codec_ctx *codec, double animvpx_aspect)
     static_cast<VPXTexture*>(vpxtex[which]->GetTexture())->SetFrame(codec->pic, codec->width, codec->height);
     vpxtex[which]->CleanHardwareData();
 
-    float vid_wbyh = ((float)codec->width)/codec->height;
+    animvpx_render_texture(vpxtex[which], codec->width, codec->height, animvpx_aspect);
+
+    t = timerGetTicks()-t;
+    codec->sumtimes[2] += t;
+    codec->maxtimes[2] = max(codec->maxtimes[2], t);
+    codec->numframes++;
+
+    return 0;
+}
+
+// draws a frame that was decoded elsewhere, e.g. by the movie player.
+void animvpx_render_texture(FGameTexture *tex, int32_t width, int32_t height, double animvpx_aspect)
+{
+    float vid_wbyh = ((float)width)/height;
     if (animvpx_aspect > 0)
         vid_wbyh = animvpx_aspect;
     float scr_wbyh = ((float)xdim)/ydim;
@@ -477,15 +490,8 @@ int32_t animvpx_render_frame(animvpx_codec_ctx *codec, double animvpx_aspect)
 
     x *= screen->GetWidth() / 2;
     y *= screen->GetHeight() / 2;
-    DrawTexture(twod, vpxtex[which], screen->GetWidth() / 2 - int(x), screen->GetHeight()/2 - int(y), DTA_DestWidth, 2*int(x), DTA_DestHeight, 2*int(y), 
+    DrawTexture(twod, tex, screen->GetWidth() / 2 - int(x), screen->GetHeight()/2 - int(y), DTA_DestWidth, 2*int(x), DTA_DestHeight, 2*int(y), 
         DTA_Masked, false, DTA_KeepRatio, true, DTA_LegacyRenderStyle, STYLE_Normal, TAG_DONE);
-
-    t = timerGetTicks()-t;
-    codec->sumtimes[2] += t;
-    codec->maxtimes[2] = max(codec->maxtimes[2], t);
-    codec->numframes++;
-
-    return 0;
 }
 
 void animvpx_print_stats(const animvpx_codec_ctx *codec)
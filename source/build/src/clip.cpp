@@ -11,6 +11,10 @@
 #include "clip.h"
 #include "engine_priv.h"
 
+#ifndef NO_SSE
+#include <emmintrin.h>
+#endif
+
 
 static int16_t clipnum;
 static linetype clipit[MAXCLIPNUM];
@@ -898,6 +902,177 @@ int32_t clipmovex(vec3_t *pos, int16_t *sectnum,
     return ret;
 }
 
+//
+// wall culling (internal)
+//
+// clipmove and hitscan first reject walls with a few cheap, independent tests.
+// These are evaluated for up to CLIPWALLBATCH consecutive walls at a time on a
+// structure-of-arrays copy of the wall endpoints, returning a bit mask of the
+// walls that survive. The SSE2 kernels reproduce the scalar int32 and int64
+// arithmetic exactly, so the result never depends on which path was taken.
+//
+#define CLIPWALLBATCH 16
+
+struct clipwallsoa_t
+{
+    int32_t x1[CLIPWALLBATCH], y1[CLIPWALLBATCH];
+    int32_t x2[CLIPWALLBATCH], y2[CLIPWALLBATCH];
+};
+
+static FORCE_INLINE void clipwallsoa_gather(clipwallsoa_t *soa, int const startwall, int const count)
+{
+    auto wal = (uwallptr_t)&wall[startwall];
+
+    for (int i = 0; i < count; i++, wal++)
+    {
+        auto const wal2 = (uwallptr_t)&wall[wal->point2];
+        soa->x1[i] = wal->x;  soa->y1[i] = wal->y;
+        soa->x2[i] = wal2->x; soa->y2[i] = wal2->y;
+    }
+}
+
+static FORCE_INLINE int clipmove_keepwall(clipwallsoa_t const *soa, int const i, vec2_t const clipMin, vec2_t const clipMax, vec2_t const pos)
+{
+    int32_t const x1 = soa->x1[i], y1 = soa->y1[i], x2 = soa->x2[i], y2 = soa->y2[i];
+
+    if ((x1 < clipMin.x && x2 < clipMin.x) || (x1 > clipMax.x && x2 > clipMax.x) ||
+        (y1 < clipMin.y && y2 < clipMin.y) || (y1 > clipMax.y && y2 > clipMax.y))
+        return 0;
+
+    vec2_t const d = { x2-x1, y2-y1 };
+
+    if (d.x * (pos.y-y1) < (pos.x-x1) * d.y)
+        return 0;  //If wall's not facing you
+
+    vec2_t const r = { (d.y > 0) ? clipMax.x : clipMin.x, (d.x > 0) ? clipMin.y : clipMax.y };
+
+    return d.x * (r.y - y1) < d.y * (r.x - x1);
+}
+
+static FORCE_INLINE int hitscan_keepwall(clipwallsoa_t const *soa, int const i, vec3_t const *sv)
+{
+    return compat_maybe_truncate_to_int32((coord_t)(soa->x1[i]-sv->x)*(soa->y2[i]-sv->y))
+        >= compat_maybe_truncate_to_int32((coord_t)(soa->x2[i]-sv->x)*(soa->y1[i]-sv->y));
+}
+
+#ifndef NO_SSE
+// SSE2 has no 32 bit low multiply. Same result as the wrapping scalar product.
+static FORCE_INLINE __m128i clip_mullo_epi32(__m128i const a, __m128i const b)
+{
+    __m128i const even = _mm_mul_epu32(a, b);
+    __m128i const odd  = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+static FORCE_INLINE __m128i clip_select(__m128i const mask, __m128i const a, __m128i const b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+#endif
+
+static uint32_t clipmove_cullwalls(int const startwall, int const count, vec2_t const clipMin, vec2_t const clipMax, vec2_t const pos)
+{
+    clipwallsoa_t soa;
+    clipwallsoa_gather(&soa, startwall, count);
+
+    uint32_t mask = 0;
+    int i = 0;
+
+#ifndef NO_SSE
+    __m128i const minx = _mm_set1_epi32(clipMin.x), miny = _mm_set1_epi32(clipMin.y);
+    __m128i const maxx = _mm_set1_epi32(clipMax.x), maxy = _mm_set1_epi32(clipMax.y);
+    __m128i const px   = _mm_set1_epi32(pos.x),     py   = _mm_set1_epi32(pos.y);
+    __m128i const zero = _mm_setzero_si128();
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i const x1 = _mm_loadu_si128((__m128i const *)&soa.x1[i]);
+        __m128i const y1 = _mm_loadu_si128((__m128i const *)&soa.y1[i]);
+        __m128i const x2 = _mm_loadu_si128((__m128i const *)&soa.x2[i]);
+        __m128i const y2 = _mm_loadu_si128((__m128i const *)&soa.y2[i]);
+
+        __m128i reject = _mm_and_si128(_mm_cmplt_epi32(x1, minx), _mm_cmplt_epi32(x2, minx));
+        reject = _mm_or_si128(reject, _mm_and_si128(_mm_cmpgt_epi32(x1, maxx), _mm_cmpgt_epi32(x2, maxx)));
+        reject = _mm_or_si128(reject, _mm_and_si128(_mm_cmplt_epi32(y1, miny), _mm_cmplt_epi32(y2, miny)));
+        reject = _mm_or_si128(reject, _mm_and_si128(_mm_cmpgt_epi32(y1, maxy), _mm_cmpgt_epi32(y2, maxy)));
+
+        __m128i const dx = _mm_sub_epi32(x2, x1);
+        __m128i const dy = _mm_sub_epi32(y2, y1);
+
+        reject = _mm_or_si128(reject, _mm_cmplt_epi32(clip_mullo_epi32(dx, _mm_sub_epi32(py, y1)), clip_mullo_epi32(_mm_sub_epi32(px, x1), dy)));
+
+        __m128i const rx = clip_select(_mm_cmpgt_epi32(dy, zero), maxx, minx);
+        __m128i const ry = clip_select(_mm_cmpgt_epi32(dx, zero), miny, maxy);
+        __m128i const vx = clip_mullo_epi32(dx, _mm_sub_epi32(ry, y1));
+        __m128i const vy = clip_mullo_epi32(dy, _mm_sub_epi32(rx, x1));
+
+        __m128i const keep = _mm_andnot_si128(reject, _mm_cmplt_epi32(vx, vy));
+        mask |= (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(keep)) << i;
+    }
+#endif
+
+    for (; i < count; i++)
+        mask |= clipmove_keepwall(&soa, i, clipMin, clipMax, pos) << i;
+
+    return mask;
+}
+
+static uint32_t hitscan_cullwalls(int const startwall, int const count, vec3_t const *sv)
+{
+    clipwallsoa_t soa;
+    clipwallsoa_gather(&soa, startwall, count);
+
+    uint32_t mask = 0;
+    int i = 0;
+
+#ifndef NO_SSE
+    __m128i const sx = _mm_set1_epi32(sv->x), sy = _mm_set1_epi32(sv->y);
+    // Products of values below 2^26 are exact in a double.
+    __m128i const rangemin = _mm_set1_epi32(-(1 << 26)), rangemax = _mm_set1_epi32(1 << 26);
+    bool const truncate = enginecompatibility_mode != ENGINECOMPATIBILITY_NONE;
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i const ax = _mm_sub_epi32(_mm_loadu_si128((__m128i const *)&soa.x1[i]), sx);
+        __m128i const ay = _mm_sub_epi32(_mm_loadu_si128((__m128i const *)&soa.y2[i]), sy);
+        __m128i const bx = _mm_sub_epi32(_mm_loadu_si128((__m128i const *)&soa.x2[i]), sx);
+        __m128i const by = _mm_sub_epi32(_mm_loadu_si128((__m128i const *)&soa.y1[i]), sy);
+
+        if (truncate)
+        {
+            __m128i const reject = _mm_cmplt_epi32(clip_mullo_epi32(ax, ay), clip_mullo_epi32(bx, by));
+            mask |= (uint32_t)(~_mm_movemask_ps(_mm_castsi128_ps(reject)) & 15) << i;
+            continue;
+        }
+
+        __m128i inrange = _mm_and_si128(_mm_cmpgt_epi32(ax, rangemin), _mm_cmplt_epi32(ax, rangemax));
+        inrange = _mm_and_si128(inrange, _mm_and_si128(_mm_cmpgt_epi32(ay, rangemin), _mm_cmplt_epi32(ay, rangemax)));
+        inrange = _mm_and_si128(inrange, _mm_and_si128(_mm_cmpgt_epi32(bx, rangemin), _mm_cmplt_epi32(bx, rangemax)));
+        inrange = _mm_and_si128(inrange, _mm_and_si128(_mm_cmpgt_epi32(by, rangemin), _mm_cmplt_epi32(by, rangemax)));
+
+        if (_mm_movemask_ps(_mm_castsi128_ps(inrange)) != 15)
+        {
+            for (int j = i; j < i + 4; j++)
+                mask |= hitscan_keepwall(&soa, j, sv) << j;
+            continue;
+        }
+
+        __m128d const lo = _mm_cmpge_pd(_mm_mul_pd(_mm_cvtepi32_pd(ax), _mm_cvtepi32_pd(ay)), _mm_mul_pd(_mm_cvtepi32_pd(bx), _mm_cvtepi32_pd(by)));
+        __m128i const axh = _mm_shuffle_epi32(ax, _MM_SHUFFLE(1, 0, 3, 2)), ayh = _mm_shuffle_epi32(ay, _MM_SHUFFLE(1, 0, 3, 2));
+        __m128i const bxh = _mm_shuffle_epi32(bx, _MM_SHUFFLE(1, 0, 3, 2)), byh = _mm_shuffle_epi32(by, _MM_SHUFFLE(1, 0, 3, 2));
+        __m128d const hi = _mm_cmpge_pd(_mm_mul_pd(_mm_cvtepi32_pd(axh), _mm_cvtepi32_pd(ayh)), _mm_mul_pd(_mm_cvtepi32_pd(bxh), _mm_cvtepi32_pd(byh)));
+
+        mask |= (uint32_t)(_mm_movemask_pd(lo) | (_mm_movemask_pd(hi) << 2)) << i;
+    }
+#endif
+
+    for (; i < count; i++)
+        mask |= hitscan_keepwall(&soa, i, sv) << i;
+
+    return mask;
+}
+
 //
 // raytrace (internal)
 //
@@ -1158,28 +1333,28 @@ int32_t clipmove(vec3_t * const pos, int16_t * const sectnum, int32_t xvect, int
         int const  startwall = sec->wallptr;
         int const  endwall   = startwall + sec->wallnum;
         auto       wal       = (uwallptr_t)&wall[startwall];
+        uint32_t   wallmask  = 0;
 
         for (native_t j=startwall; j<endwall; j++, wal++)
         {
-            auto const wal2 = (uwallptr_t)&wall[wal->point2];
+            int const batchidx = (j-startwall) & (CLIPWALLBATCH-1);
 
-            if ((wal->x < clipMin.x && wal2->x < clipMin.x) || (wal->x > clipMax.x && wal2->x > clipMax.x) ||
-                (wal->y < clipMin.y && wal2->y < clipMin.y) || (wal->y > clipMax.y && wal2->y > clipMax.y))
+            if (batchidx == 0)
+                wallmask = clipmove_cullwalls(j, min<int>(endwall-j, CLIPWALLBATCH), clipMin, clipMax, pos->vec2);
+
+            // outside the clip box, not facing you, or not reached
+            if ((wallmask & (1u << batchidx)) == 0)
                 continue;
 
+            auto const wal2 = (uwallptr_t)&wall[wal->point2];
+
             vec2_t p1 = wal->pos;
             vec2_t p2 = wal2->pos;
             vec2_t d  = { p2.x-p1.x, p2.y-p1.y };
 
-            if (d.x * (pos->y-p1.y) < (pos->x-p1.x) * d.y)
-                continue;  //If wall's not facing you
-
             vec2_t const r = { (d.y > 0) ? clipMax.x : clipMin.x, (d.x > 0) ? clipMin.y : clipMax.y };
             vec2_t       v = { d.x * (r.y - p1.y), d.y * (r.x - p1.x) };
 
-            if (v.x >= v.y)
-                continue;
-
             int clipyou = 0;
 
 #ifdef HAVE_CLIPSHAPE_FEATURE
@@ -2373,8 +2548,18 @@ restart_grand:
         ////////// Walls //////////
 
         startwall = sec->wallptr; endwall = startwall + sec->wallnum;
+        uint32_t wallmask = 0;
         for (z=startwall; z<endwall; z++)
         {
+            int const batchidx = (z-startwall) & (CLIPWALLBATCH-1);
+
+            if (batchidx == 0)
+                wallmask = hitscan_cullwalls(z, min(endwall-z, CLIPWALLBATCH), sv);
+
+            // wall facing away from the start point
+            if ((wallmask & (1u << batchidx)) == 0)
+                continue;
+
             auto const wal  = (uwallptr_t)&wall[z];
             auto const wal2 = (uwallptr_t)&wall[wal->point2];
 
@@ -2384,8 +2569,6 @@ restart_grand:
 
             x1 = wal->x; y1 = wal->y; x2 = wal2->x; y2 = wal2->y;
 
-            if (compat_maybe_truncate_to_int32((coord_t)(x1-sv->x)*(y2-sv->y))
-                < compat_maybe_truncate_to_int32((coord_t)(x2-sv->x)*(y1-sv->y))) continue;
             if (rintersect(sv->x,sv->y,sv->z, vx,vy,vz, x1,y1, x2,y2, &intx,&inty,&intz) == -1) continue;
 
             if (enginecompatibility_mode == ENGINECOMPATIBILITY_19950829)
@@ -28,6 +28,7 @@
 #include "menu.h"
 #include "version.h"
 #include "earcut.hpp"
+#include "timedemo.h"
 
 #ifdef USE_OPENGL
 # include "mdsprite.h"
@@ -2222,6 +2223,7 @@ void set_globalang(fix16_t const ang)
 int32_t renderDrawRoomsQ16(int32_t daposx, int32_t daposy, int32_t daposz,
                            fix16_t daang, fix16_t dahoriz, int16_t dacursectnum)
 {
+    FTimeDemoSection timedemo(TDS_DrawRooms);
     int32_t i;
 
     beforedrawrooms = 0;
@@ -2531,6 +2533,7 @@ static void sortsprites(int const start, int const end)
 //
 void renderDrawMasks(void)
 {
+    FTimeDemoSection timedemo(TDS_DrawMasks);
 # define debugmask_add(dispidx, idx) do {} while (0)
     int32_t i = spritesortcnt-1;
     int32_t numSprites = spritesortcnt;
@@ -3438,6 +3441,7 @@ static FORCE_INLINE int32_t have_maptext(void)
 static void enginePrepareLoadBoard(FileReader & fr, vec3_t *dapos, int16_t *daang, int16_t *dacursectnum)
 {
     initspritelists();
+    sectorGridInvalidate();
 
     show2dsector.Zero();
     Bmemset(show2dsprite, 0, sizeof(show2dsprite));
@@ -4032,6 +4036,7 @@ void videoNextPage(void)
 {
 	static bool recursion;
 
+	TIMEDEMO_Begin(TDS_2D);
 	if (!recursion)
 	{
 		// This protection is needed because the menu can call scripts from inside its drawers and the scripts can call the busy-looping Screen_Play script event
@@ -4065,6 +4070,8 @@ void videoNextPage(void)
     numframes++;
     twod->SetSize(screen->GetWidth(), screen->GetHeight());
     twodpsp.SetSize(screen->GetWidth(), screen->GetHeight());
+    TIMEDEMO_End(TDS_2D);
+    TIMEDEMO_EndFrame();
 }
 
 //
@@ -4447,18 +4454,40 @@ int32_t nextsectorneighborz(int16_t sectnum, int32_t refz, int16_t topbottom, in
 //
 // cansee
 //
-int32_t cansee_old(int32_t xs, int32_t ys, int32_t zs, int16_t sectnums, int32_t xe, int32_t ye, int32_t ze, int16_t sectnume)
+static inline void cansee_begin(canseectx_t *ctx)
+{
+    if (++ctx->generation == 0)
+    {
+        Bmemset(ctx->visited, 0, sizeof(ctx->visited));
+        ctx->generation = 1;
+    }
+}
+
+static inline bool cansee_visited(canseectx_t const *ctx, int32_t sectnum)
+{
+    return ctx->visited[sectnum] == ctx->generation;
+}
+
+static inline void cansee_visit(canseectx_t *ctx, int32_t sectnum)
+{
+    ctx->visited[sectnum] = ctx->generation;
+}
+
+static int32_t cansee_old(canseectx_t *ctx, int32_t xs, int32_t ys, int32_t zs, int16_t sectnums, int32_t xe, int32_t ye, int32_t ze, int16_t sectnume)
 {
     sectortype *sec, *nsec;
     walltype *wal, *wal2;
-    int32_t intx, inty, intz, i, cnt, nextsector, dasectnum, dacnt, danum;
+    int32_t intx, inty, intz, cnt, nextsector, dasectnum, dacnt, danum;
+    int16_t *const sectlist = ctx->sectlist;
 
     if ((xs == xe) && (ys == ye) && (sectnums == sectnume)) return 1;
-    
-    clipsectorlist[0] = sectnums; danum = 1;
+
+    cansee_begin(ctx);
+    cansee_visit(ctx, sectnums);
+    sectlist[0] = sectnums; danum = 1;
     for(dacnt=0;dacnt<danum;dacnt++)
     {
-        dasectnum = clipsectorlist[dacnt]; sec = &sector[dasectnum];
+        dasectnum = sectlist[dacnt]; sec = &sector[dasectnum];
         
         for(cnt=sec->wallnum,wal=&wall[sec->wallptr];cnt>0;cnt--,wal++)
         {
@@ -4473,26 +4502,28 @@ int32_t cansee_old(int32_t xs, int32_t ys, int32_t zs, int16_t sectnums, int32_t
                 if (intz <= nsec->ceilingz) return 0;
                 if (intz >= nsec->floorz) return 0;
 
-                for(i=danum-1;i>=0;i--)
-                    if (clipsectorlist[i] == nextsector) break;
-                if (i < 0) clipsectorlist[danum++] = nextsector;
+                if (!cansee_visited(ctx, nextsector))
+                {
+                    cansee_visit(ctx, nextsector);
+                    sectlist[danum++] = nextsector;
+                }
             }
         }
 
-        if (clipsectorlist[dacnt] == sectnume)
+        if (sectlist[dacnt] == sectnume)
             return 1;
     }
     return 0;
 }
 
-int32_t cansee(int32_t x1, int32_t y1, int32_t z1, int16_t sect1, int32_t x2, int32_t y2, int32_t z2, int16_t sect2)
+int32_t cansee_r(canseectx_t *ctx, int32_t x1, int32_t y1, int32_t z1, int16_t sect1, int32_t x2, int32_t y2, int32_t z2, int16_t sect2)
 {
     if (enginecompatibility_mode == ENGINECOMPATIBILITY_19950829)
-        return cansee_old(x1, y1, z1, sect1, x2, y2, z2, sect2);
+        return cansee_old(ctx, x1, y1, z1, sect1, x2, y2, z2, sect2);
     int32_t dacnt, danum;
     const int32_t x21 = x2-x1, y21 = y2-y1, z21 = z2-z1;
+    int16_t *const sectlist = ctx->sectlist;
 
-    static uint8_t sectbitmap[(MAXSECTORS+7)>>3];
 #ifdef YAX_ENABLE
     int16_t pendingsectnum;
     vec3_t pendingvec;
@@ -4505,7 +4536,7 @@ int32_t cansee(int32_t x1, int32_t y1, int32_t z1, int16_t sect1, int32_t x2, in
 
     Bmemset(&pendingvec, 0, sizeof(vec3_t));  // compiler-happy
 #endif
-    Bmemset(sectbitmap, 0, sizeof(sectbitmap));
+    cansee_begin(ctx);
 #ifdef YAX_ENABLE
 restart_grand:
 #endif
@@ -4515,12 +4546,12 @@ restart_grand:
 #ifdef YAX_ENABLE
     pendingsectnum = -1;
 #endif
-    sectbitmap[sect1>>3] |= pow2char[sect1&7];
-    clipsectorlist[0] = sect1; danum = 1;
+    cansee_visit(ctx, sect1);
+    sectlist[0] = sect1; danum = 1;
 
     for (dacnt=0; dacnt<danum; dacnt++)
     {
-        const int32_t dasectnum = clipsectorlist[dacnt];
+        const int32_t dasectnum = sectlist[dacnt];
         auto const sec = (usectorptr_t)&sector[dasectnum];
         uwallptr_t wal;
         bssize_t cnt;
@@ -4570,9 +4601,9 @@ restart_grand:
                             if (ns < 0)
                                 continue;
 
-                            if (!(sectbitmap[ns>>3] & pow2char[ns&7]) && pendingsectnum==-1)
+                            if (!cansee_visited(ctx, ns) && pendingsectnum==-1)
                             {
-                                sectbitmap[ns>>3] |= pow2char[ns&7];
+                                cansee_visit(ctx, ns);
                                 pendingsectnum = ns;
                                 pendingvec.x = x;
                                 pendingvec.y = y;
@@ -4640,10 +4671,10 @@ restart_grand:
                 return 0;
 
 add_nextsector:
-            if (!(sectbitmap[nexts>>3] & pow2char[nexts&7]))
+            if (!cansee_visited(ctx, nexts))
             {
-                sectbitmap[nexts>>3] |= pow2char[nexts&7];
-                clipsectorlist[danum++] = nexts;
+                cansee_visit(ctx, nexts);
+                sectlist[danum++] = nexts;
             }
         }
 
@@ -4659,12 +4690,20 @@ add_nextsector:
 #endif
     }
 
-    if (sectbitmap[sect2>>3] & pow2char[sect2&7])
+    if (cansee_visited(ctx, sect2))
         return 1;
 
     return 0;
 }
 
+int32_t cansee(int32_t x1, int32_t y1, int32_t z1, int16_t sect1, int32_t x2, int32_t y2, int32_t z2, int16_t sect2)
+{
+    // One context per thread: it is too large to set up on every call, and
+    // sharing one would make cansee() unsafe to call from worker threads.
+    static thread_local canseectx_t canseectx;
+    return cansee_r(&canseectx, x1, y1, z1, sect1, x2, y2, z2, sect2);
+}
+
 //
 // neartag
 //
@@ -4782,6 +4821,8 @@ void dragpoint(int16_t pointhighlight, int32_t dax, int32_t day, uint8_t flags)
         Bmemset(walbitmap, 0, (numwalls+7)>>3);
     yaxwalls[numyaxwalls++] = pointhighlight;
 
+    sectorGridBeginUpdate();
+
     for (i=0; i<numyaxwalls; i++)
     {
         int32_t clockwise = 0;
@@ -4797,6 +4838,7 @@ void dragpoint(int16_t pointhighlight, int32_t dax, int32_t day, uint8_t flags)
             wall[w].x = dax;
             wall[w].y = day;
             walbitmap[w>>3] |= pow2char[w&7];
+            sectorGridUpdateSector(sectorofwall(w));
 
             for (YAX_ITER_WALLS(w, j, tmpcf))
             {
@@ -4847,6 +4889,8 @@ void dragpoint(int16_t pointhighlight, int32_t dax, int32_t day, uint8_t flags)
         }
     }
 
+    sectorGridEndUpdate();
+
     if (editstatus)
     {
         int32_t w;
@@ -5010,9 +5054,19 @@ void updatesector(int32_t const x, int32_t const y, int16_t * const sectnum)
 
     // we need to support passing in a sectnum of -1, unfortunately
 
-    for (int i = numsectors - 1; i >= 0; --i)
-        if (inside_p(x, y, i))
-            SET_AND_RETURN(*sectnum, i);
+    int count;
+    if (auto const candidates = sectorGridCandidates(x, y, &count))
+    {
+        for (int i = 0; i < count; i++)
+            if (inside_p(x, y, candidates[i]))
+                SET_AND_RETURN(*sectnum, candidates[i]);
+    }
+    else
+    {
+        for (int i = numsectors - 1; i >= 0; --i)
+            if (inside_p(x, y, i))
+                SET_AND_RETURN(*sectnum, i);
+    }
 
     *sectnum = -1;
 }
@@ -5037,9 +5091,19 @@ void updatesectorexclude(int32_t const x, int32_t const y, int16_t * const sectn
         while (--wallsleft);
     }
 
-    for (bssize_t i=numsectors-1; i>=0; --i)
-        if (inside_exclude_p(x, y, i, excludesectbitmap))
-            SET_AND_RETURN(*sectnum, i);
+    int count;
+    if (auto const candidates = sectorGridCandidates(x, y, &count))
+    {
+        for (int i = 0; i < count; i++)
+            if (inside_exclude_p(x, y, candidates[i], excludesectbitmap))
+                SET_AND_RETURN(*sectnum, candidates[i]);
+    }
+    else
+    {
+        for (bssize_t i=numsectors-1; i>=0; --i)
+            if (inside_exclude_p(x, y, i, excludesectbitmap))
+                SET_AND_RETURN(*sectnum, i);
+    }
 
     *sectnum = -1;
 }
@@ -5108,9 +5172,19 @@ void updatesectorz(int32_t const x, int32_t const y, int32_t const z, int16_t *
     }
 
     // we need to support passing in a sectnum of -1, unfortunately
-    for (int i = numsectors - 1; i >= 0; --i)
-        if (inside_z_p(x, y, z, i))
-            SET_AND_RETURN(*sectnum, i);
+    int count;
+    if (auto const candidates = sectorGridCandidates(x, y, &count))
+    {
+        for (int i = 0; i < count; i++)
+            if (inside_z_p(x, y, z, candidates[i]))
+                SET_AND_RETURN(*sectnum, candidates[i]);
+    }
+    else
+    {
+        for (int i = numsectors - 1; i >= 0; --i)
+            if (inside_z_p(x, y, z, i))
+                SET_AND_RETURN(*sectnum, i);
+    }
 
     *sectnum = -1;
 }
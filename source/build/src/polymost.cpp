@@ -4359,6 +4359,7 @@ static void polymost_precache(int32_t dapicnum, int32_t dapalnum, int32_t datype
     hicprecaching = 1;
     int palid = TRANSLATION(Translation_Remap + curbasepal, dapalnum);
     GLInterface.SetTexture(dapicnum, tileGetTexture(dapicnum), palid, CLAMP_NONE);
+    GLInterface.PrecacheTexture(dapicnum, tileGetTexture(dapicnum), palid);
     hicprecaching = 0;
 
     if (datype == 0 || !hw_models) return;
@@ -4373,7 +4374,11 @@ static void polymost_precache(int32_t dapicnum, int32_t dapalnum, int32_t datype
 	{
         auto tex = mdloadskin((md2model_t *)models[mid], 0, dapalnum, i, nullptr);
         int palid = TRANSLATION(Translation_Remap + curbasepal, dapalnum);
-        if (tex) GLInterface.SetTexture(-1, tex, palid, CLAMP_NONE);
+        if (tex)
+        {
+            GLInterface.SetTexture(-1, tex, palid, CLAMP_NONE);
+            GLInterface.PrecacheTexture(-1, tex, palid);
+        }
 	}
 }
 
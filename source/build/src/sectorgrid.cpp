@@ -0,0 +1,463 @@
+// "Build Engine & Tools" Copyright (c) 1993-1997 Ken Silverman
+// Ken Silverman's official web site: "http://www.advsys.net/ken"
+// See the included license file "BUILDLIC.TXT" for license info.
+//
+// Uniform grid over the sector bounding boxes, used by updatesector[z] when
+// the neighbor walk fails, instead of testing every sector with inside().
+//
+// Each cell lists the sectors whose bounding box overlaps it, sorted by
+// descending sector number, so that testing a cell's list in order returns
+// the same sector as the linear scan from numsectors-1 down to 0.
+//
+// A moving sector is registered with one cell of slack around its box, and
+// with the box it had on the previous update, so that geometry interpolated
+// between the two stays covered while rendering. Movement within the slack
+// costs nothing; once the sector leaves it, it is re-registered and removed
+// from the cells it no longer touches.
+//
+// Code that moves many walls at once wraps the moves in
+// sectorGridBeginUpdate/sectorGridEndUpdate. In between, updates only mark
+// their sector, and each marked sector is re-registered once at the end.
+
+#include "build.h"
+#include "baselayer.h"
+#include "engine_priv.h"
+#ifdef _DEBUG
+#include "c_dispatch.h"
+#include "printf.h"
+#include "v_text.h"
+#include "stats.h"
+#endif
+
+#define SECTORGRID_MINSHIFT 9   // no cells smaller than 512 units
+#define SECTORGRID_MAXDIM   128
+
+struct sectorbox_t
+{
+    int32_t x1, y1, x2, y2;
+};
+
+static struct
+{
+    bool valid;
+    sectortype const *sector;
+    int32_t numsectors, numwalls;
+    int32_t originx, originy;
+    int32_t shift;
+    int32_t width, height;
+    TArray<TArray<int16_t>> cells;
+    sectorbox_t box[MAXSECTORS];    // registered, what the cells and sectorGridInBox go by
+    sectorbox_t exact[MAXSECTORS];  // as of the last update
+    int32_t updatedepth;
+    int32_t numdirty;
+    int16_t dirty[MAXSECTORS];      // sectors updated inside sectorGridBeginUpdate/EndUpdate
+    uint8_t isdirty[(MAXSECTORS+7)>>3];
+} grid;
+
+struct sectorcells_t
+{
+    int32_t cx1, cy1, cx2, cy2;
+
+    bool contains(int cx, int cy) const { return cx >= cx1 && cx <= cx2 && cy >= cy1 && cy <= cy2; }
+};
+
+static void sectorGridGetBox(int sectnum, sectorbox_t *box)
+{
+    auto const sec = (usectorptr_t)&sector[sectnum];
+    auto wal = (uwallptr_t)&wall[sec->wallptr];
+
+    box->x1 = box->x2 = wal->x;
+    box->y1 = box->y2 = wal->y;
+
+    for (int i = sec->wallnum - 1; i > 0; i--)
+    {
+        wal++;
+        box->x1 = min(box->x1, wal->x);
+        box->y1 = min(box->y1, wal->y);
+        box->x2 = max(box->x2, wal->x);
+        box->y2 = max(box->y2, wal->y);
+    }
+}
+
+static bool sectorGridContains(sectorbox_t const &box)
+{
+    return box.x1 >= grid.originx && box.y1 >= grid.originy &&
+        ((box.x2 - grid.originx) >> grid.shift) < grid.width &&
+        ((box.y2 - grid.originy) >> grid.shift) < grid.height;
+}
+
+static sectorcells_t sectorGridCells(sectorbox_t const &box)
+{
+    return { (box.x1 - grid.originx) >> grid.shift, (box.y1 - grid.originy) >> grid.shift,
+             (box.x2 - grid.originx) >> grid.shift, (box.y2 - grid.originy) >> grid.shift };
+}
+
+// Index of sectnum in the cell, or of where it has to be inserted.
+// The list is sorted by descending sector number.
+static unsigned sectorGridFind(TArray<int16_t> const &cell, int sectnum)
+{
+    unsigned lo = 0, hi = cell.Size();
+
+    while (lo < hi)
+    {
+        unsigned const mid = (lo + hi) >> 1;
+        if (cell[mid] > sectnum)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+static void sectorGridMove(int sectnum, sectorbox_t const &from, sectorbox_t const &to)
+{
+    auto const oldcells = sectorGridCells(from), newcells = sectorGridCells(to);
+
+    for (int cy = oldcells.cy1; cy <= oldcells.cy2; cy++)
+    {
+        for (int cx = oldcells.cx1; cx <= oldcells.cx2; cx++)
+        {
+            if (newcells.contains(cx, cy))
+                continue;
+
+            auto &cell = grid.cells[cy * grid.width + cx];
+            unsigned const pos = sectorGridFind(cell, sectnum);
+
+            if (pos < cell.Size() && cell[pos] == sectnum)
+                cell.Delete(pos);
+        }
+    }
+
+    for (int cy = newcells.cy1; cy <= newcells.cy2; cy++)
+    {
+        for (int cx = newcells.cx1; cx <= newcells.cx2; cx++)
+        {
+            if (oldcells.contains(cx, cy))
+                continue;
+
+            auto &cell = grid.cells[cy * grid.width + cx];
+            unsigned const pos = sectorGridFind(cell, sectnum);
+
+            if (pos == cell.Size() || cell[pos] != sectnum)
+                cell.Insert(pos, (int16_t)sectnum);
+        }
+    }
+}
+
+static void sectorGridClearDirty(void)
+{
+    for (int i = 0; i < grid.numdirty; i++)
+        grid.isdirty[grid.dirty[i]>>3] &= ~pow2char[grid.dirty[i]&7];
+    grid.numdirty = 0;
+}
+
+static void sectorGridBuild(void)
+{
+    sectorGridClearDirty();
+    grid.cells.Clear();
+    grid.numsectors = numsectors;
+    grid.numwalls = numwalls;
+    grid.valid = false;
+
+    if (numsectors <= 0 || numwalls <= 0)
+        return;
+
+    sectorbox_t bounds;
+    for (int i = 0; i < numsectors; i++)
+    {
+        sectorGridGetBox(i, &grid.box[i]);
+        grid.exact[i] = grid.box[i];
+
+        if (i == 0)
+            bounds = grid.box[i];
+        else
+        {
+            bounds.x1 = min(bounds.x1, grid.box[i].x1);
+            bounds.y1 = min(bounds.y1, grid.box[i].y1);
+            bounds.x2 = max(bounds.x2, grid.box[i].x2);
+            bounds.y2 = max(bounds.y2, grid.box[i].y2);
+        }
+    }
+
+    // Leave some room around the map for sectors that move outwards.
+    int64_t const span = max<int64_t>((int64_t)bounds.x2 - bounds.x1, (int64_t)bounds.y2 - bounds.y1) + (2 << SECTORGRID_MINSHIFT);
+
+    grid.shift = SECTORGRID_MINSHIFT;
+    while ((span >> grid.shift) >= SECTORGRID_MAXDIM)
+        grid.shift++;
+
+    grid.originx = bounds.x1 - (1 << SECTORGRID_MINSHIFT);
+    grid.originy = bounds.y1 - (1 << SECTORGRID_MINSHIFT);
+    grid.width = (int32_t)((((int64_t)bounds.x2 + (1 << SECTORGRID_MINSHIFT) - grid.originx) >> grid.shift) + 1);
+    grid.height = (int32_t)((((int64_t)bounds.y2 + (1 << SECTORGRID_MINSHIFT) - grid.originy) >> grid.shift) + 1);
+    grid.cells.Resize(grid.width * grid.height);
+
+    // Inserting in descending order keeps every cell list sorted without shifting.
+    for (int i = numsectors - 1; i >= 0; i--)
+    {
+        auto const cells = sectorGridCells(grid.box[i]);
+
+        for (int cy = cells.cy1; cy <= cells.cy2; cy++)
+            for (int cx = cells.cx1; cx <= cells.cx2; cx++)
+                grid.cells[cy * grid.width + cx].Push((int16_t)i);
+    }
+
+    grid.valid = true;
+}
+
+//
+// sectorGridInvalidate
+//
+// Must be called whenever a new map or savegame has been loaded, while the
+// map's own sector array is active. The grid is rebuilt on the next lookup.
+//
+void sectorGridInvalidate(void)
+{
+    sectorGridClearDirty();
+    grid.valid = false;
+    grid.sector = sector;
+    grid.numsectors = -1;
+}
+
+static void sectorGridRegister(int sectnum)
+{
+    sectorbox_t newbox;
+    sectorGridGetBox(sectnum, &newbox);
+
+    sectorbox_t const lastbox = grid.exact[sectnum];
+    grid.exact[sectnum] = newbox;
+
+    auto &box = grid.box[sectnum];
+    if (newbox.x1 >= box.x1 && newbox.y1 >= box.y1 && newbox.x2 <= box.x2 && newbox.y2 <= box.y2)
+        return;
+
+    if (!sectorGridContains(newbox))
+    {
+        grid.valid = false;
+        return;
+    }
+
+    // The slack is clamped to the grid, points outside of it never get this far.
+    int32_t const slack = 1 << grid.shift;
+    int64_t const gridx2 = grid.originx + ((int64_t)grid.width << grid.shift) - 1;
+    int64_t const gridy2 = grid.originy + ((int64_t)grid.height << grid.shift) - 1;
+
+    sectorbox_t regbox;
+    regbox.x1 = min(lastbox.x1, max(grid.originx, newbox.x1 - slack));
+    regbox.y1 = min(lastbox.y1, max(grid.originy, newbox.y1 - slack));
+    regbox.x2 = max(lastbox.x2, (int32_t)min<int64_t>(gridx2, (int64_t)newbox.x2 + slack));
+    regbox.y2 = max(lastbox.y2, (int32_t)min<int64_t>(gridy2, (int64_t)newbox.y2 + slack));
+
+    sectorGridMove(sectnum, box, regbox);
+    box = regbox;
+}
+
+static void sectorGridFlush(void)
+{
+    for (int i = 0; i < grid.numdirty && grid.valid; i++)
+        sectorGridRegister(grid.dirty[i]);
+
+    sectorGridClearDirty();
+}
+
+//
+// sectorGridUpdateSector
+//
+// Must be called after the walls of a sector have been moved, unless the
+// movement went through dragpoint(), which does this by itself.
+//
+void sectorGridUpdateSector(int sectnum)
+{
+    if (!grid.valid || grid.sector != sector || (unsigned)sectnum >= (unsigned)grid.numsectors)
+        return;
+
+    if (grid.updatedepth == 0)
+    {
+        sectorGridRegister(sectnum);
+        return;
+    }
+
+    if (!(grid.isdirty[sectnum>>3] & pow2char[sectnum&7]))
+    {
+        grid.isdirty[sectnum>>3] |= pow2char[sectnum&7];
+        grid.dirty[grid.numdirty++] = sectnum;
+    }
+}
+
+//
+// sectorGridBeginUpdate, sectorGridEndUpdate
+//
+// Defer the updates in between until the outermost sectorGridEndUpdate, so
+// that a sector whose walls are moved one by one is only measured once.
+// Lookups in between still see the current geometry.
+//
+void sectorGridBeginUpdate(void)
+{
+    grid.updatedepth++;
+}
+
+void sectorGridEndUpdate(void)
+{
+    if (--grid.updatedepth == 0 && grid.numdirty && grid.sector == sector)
+        sectorGridFlush();
+}
+
+//
+// sectorGridUpdateWallPtr
+//
+// For code that animates raw pointers to map fields: if ptr points into the
+// wall array, updates the sector owning that wall.
+//
+void sectorGridUpdateWallPtr(void const *ptr)
+{
+    uintptr_t const offset = (uintptr_t)ptr - (uintptr_t)wall;
+
+    if (offset < sizeof(walltype) * (unsigned)numwalls)
+        sectorGridUpdateSector(sectorofwall(offset / sizeof(walltype)));
+}
+
+//
+// sectorGridCandidates
+//
+// Returns the sectors that may contain (x, y) in descending order, or nullptr
+// if no index is available and the caller has to check every sector.
+//
+int16_t const *sectorGridCandidates(int32_t x, int32_t y, int *count)
+{
+    // A clip map is temporarily swapped in. Let the caller scan it directly.
+    if (grid.sector != sector)
+        return nullptr;
+
+    if (grid.numdirty)
+        sectorGridFlush();
+
+    if (!grid.valid || grid.numsectors != numsectors || grid.numwalls != numwalls)
+    {
+        sectorGridBuild();
+        if (!grid.valid)
+            return nullptr;
+    }
+
+    static int16_t const nocandidates[1] = { -1 };
+
+    if (x < grid.originx || y < grid.originy)
+    {
+        *count = 0;
+        return nocandidates;
+    }
+
+    int const cx = (x - grid.originx) >> grid.shift;
+    int const cy = (y - grid.originy) >> grid.shift;
+
+    if (cx >= grid.width || cy >= grid.height)
+    {
+        *count = 0;
+        return nocandidates;
+    }
+
+    auto const &cell = grid.cells[cy * grid.width + cx];
+    *count = cell.Size();
+    return cell.Size() ? cell.Data() : nocandidates;
+}
+
+//
+// sectorGridInBox
+//
+// Quick reject for inside(): returns false only if (x, y) lies outside the
+// registered bounding box of the sector.
+//
+bool sectorGridInBox(int sectnum, int32_t x, int32_t y)
+{
+    if (grid.sector != sector)
+        return true;
+
+    if (grid.numdirty)
+        sectorGridFlush();
+
+    if (!grid.valid || grid.numsectors != numsectors || grid.numwalls != numwalls)
+    {
+        sectorGridBuild();
+        if (!grid.valid)
+            return true;
+    }
+
+    if ((unsigned)sectnum >= (unsigned)grid.numsectors)
+        return true;
+
+    auto const &box = grid.box[sectnum];
+    return x >= box.x1 && x <= box.x2 && y >= box.y1 && y <= box.y2;
+}
+
+#ifdef _DEBUG
+//
+// bench_updatesector
+//
+// Replays the positions of all sprites in the map against the linear sector
+// scan and the grid, and checks that both agree.
+//
+CCMD(bench_updatesector)
+{
+    int const repeats = argv.argc() > 1 ? max(1, (int)strtol(argv[1], nullptr, 10)) : 100;
+    TArray<vec2_t> positions;
+
+    for (int i = 0; i < MAXSPRITES; i++)
+        if (sprite[i].statnum < MAXSTATUS)
+            positions.Push({ sprite[i].x, sprite[i].y });
+
+    if (positions.Size() == 0 || numsectors <= 0)
+    {
+        Printf("bench_updatesector: no map loaded\n");
+        return;
+    }
+
+    cycle_t lineartime, gridtime;
+    lineartime.Reset();
+    gridtime.Reset();
+
+    TArray<int16_t> linearresult(positions.Size(), true);
+    TArray<int16_t> gridresult(positions.Size(), true);
+
+    lineartime.Clock();
+    for (int r = 0; r < repeats; r++)
+    {
+        for (unsigned p = 0; p < positions.Size(); p++)
+        {
+            int16_t sect = -1;
+            for (int i = numsectors - 1; i >= 0; --i)
+            {
+                if (inside_p(positions[p].x, positions[p].y, i))
+                {
+                    sect = i;
+                    break;
+                }
+            }
+            linearresult[p] = sect;
+        }
+    }
+    lineartime.Unclock();
+
+    gridtime.Clock();
+    for (int r = 0; r < repeats; r++)
+    {
+        for (unsigned p = 0; p < positions.Size(); p++)
+        {
+            int16_t sect = -1;
+            updatesector(positions[p].x, positions[p].y, &sect);
+            gridresult[p] = sect;
+        }
+    }
+    gridtime.Unclock();
+
+    int mismatches = 0;
+    for (unsigned p = 0; p < positions.Size(); p++)
+        if (linearresult[p] != gridresult[p])
+            mismatches++;
+
+    Printf("bench_updatesector: %u positions x %d, %d sectors, %dx%d cells\n", positions.Size(), repeats, numsectors, grid.width, grid.height);
+    Printf("  linear scan: %.3f ms\n", lineartime.TimeMS());
+    Printf("  sector grid: %.3f ms\n", gridtime.TimeMS());
+    if (mismatches)
+        Printf(TEXTCOLOR_RED "  %d mismatches!\n", mismatches);
+}
+#endif
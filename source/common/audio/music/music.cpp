@@ -47,6 +47,7 @@
 #include "filesystem.h"
 #include "cmdlib.h"
 #include "s_music.h"
+#include "s_soundinternal.h"
 #include "filereadermusicinterface.h"
 #include <zmusic.h>
 
@@ -376,6 +377,8 @@ bool S_ChangeMusic(const char* musicname, int order, bool looping, bool force)
 	}
 	else
 	{
+		// Sounds may still be decoded in the background, and ZMusic cannot create decoders on two threads at once.
+		if (soundEngine) soundEngine->FinishDecoding();
 		auto mreader = GetMusicReader(reader);	// this passes the file reader to the newly created wrapper.
 		mus_playing.handle = ZMusic_OpenSong(mreader, devp ? (EMidiDevice)devp->device : MDEV_DEFAULT, devp ? devp->args.GetChars() : "");
 		if (mus_playing.handle == nullptr)
@@ -34,6 +34,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <mutex>
 
 #include "oalsound.h"
 
@@ -487,3 +488,96 @@ SoundHandle SoundRenderer::LoadSoundVoc(uint8_t *sfxdata, int length)
 	return retval;
 }
 
+//==========================================================================
+//
+// SoundRenderer :: DecodeSound
+//
+// Decodes a compressed sound to PCM data for LoadSoundDecoded.
+// ZMusic's decoder creation is not thread safe (it probes and loads the
+// codec libraries on first use), so only reading the decoded data runs
+// in parallel.
+//
+//==========================================================================
+
+static std::mutex DecoderLock;
+
+bool SoundRenderer::DecodeSound(uint8_t *sfxdata, int length, FDecodedSound &decoded)
+{
+	ChannelConfig chans;
+	SampleType type;
+	int srate;
+	uint32_t loop_start = 0, loop_end = ~0u;
+	zmusic_bool startass = false, endass = false;
+
+	SoundDecoder *decoder;
+	{
+		std::lock_guard<std::mutex> lock(DecoderLock);
+		FindLoopTags(sfxdata, length, &loop_start, &startass, &loop_end, &endass);
+		decoder = CreateDecoder(sfxdata, length, true);
+	}
+	if (!decoder)
+		return false;
+
+	SoundDecoder_GetInfo(decoder, &srate, &chans, &type);
+	int samplesize = 0;
+	if (chans == ChannelConfig_Mono || chans == ChannelConfig_Stereo)
+	{
+		decoded.channels = chans == ChannelConfig_Mono ? 1 : 2;
+		if (type == SampleType_UInt8) decoded.bits = 8;
+		if (type == SampleType_Int16) decoded.bits = 16;
+		samplesize = decoded.channels * decoded.bits / 8;
+	}
+
+	if (samplesize == 0)
+	{
+		SoundDecoder_Close(decoder);
+		decoded.error.Format("Unsupported audio format: %s, %s\n", GetChannelConfigName(chans), GetSampleTypeName(type));
+		return true;
+	}
+
+	auto &data = decoded.data;
+	unsigned total = 0;
+	unsigned got;
+
+	data.resize(total + 32768);
+	while ((got = (unsigned)SoundDecoder_Read(decoder, (char*)&data[total], data.size() - total)) > 0)
+	{
+		total += got;
+		data.resize(total * 2);
+	}
+	data.resize(total);
+	SoundDecoder_Close(decoder);
+
+	decoded.frequency = srate;
+
+	if (!startass) loop_start = Scale(loop_start, srate, 1000);
+	if (!endass && loop_end != ~0u) loop_end = Scale(loop_end, srate, 1000);
+	const uint32_t samples = (uint32_t)data.size() / samplesize;
+	if (loop_start > samples) loop_start = 0;
+	if (loop_end > samples) loop_end = samples;
+
+	if ((loop_start > 0 || loop_end > 0) && loop_end > loop_start)
+	{
+		decoded.loopstart = loop_start;
+		decoded.loopend = loop_end;
+	}
+	return true;
+}
+
+//==========================================================================
+//
+// SoundRenderer :: LoadSoundDecoded
+//
+//==========================================================================
+
+SoundHandle SoundRenderer::LoadSoundDecoded(FDecodedSound &decoded)
+{
+	if (decoded.error.IsNotEmpty())
+	{
+		Printf("%s", decoded.error.GetChars());
+		SoundHandle retval = { NULL };
+		return retval;
+	}
+	return LoadSoundRaw(decoded.data.data(), (int)decoded.data.size(), decoded.frequency, decoded.channels, decoded.bits, decoded.loopstart, decoded.loopend);
+}
+
@@ -88,6 +88,18 @@ typedef bool (*SoundStreamCallback)(SoundStream *stream, void *buff, int len, vo
 struct SoundDecoder;
 class MIDIDevice;
 
+// PCM data of a compressed sound, as produced by SoundRenderer::DecodeSound.
+struct FDecodedSound
+{
+	std::vector<uint8_t> data;
+	int frequency = 0;
+	int channels = 0;
+	int bits = 0;
+	int loopstart = -1;
+	int loopend = -1;
+	FString error;		// set if the decoder's output format is not supported.
+};
+
 class SoundRenderer
 {
 public:
@@ -99,6 +111,9 @@ public:
 	virtual void SetMusicVolume (float volume) = 0;
 	virtual SoundHandle LoadSound(uint8_t *sfxdata, int length) = 0;
 	SoundHandle LoadSoundVoc(uint8_t *sfxdata, int length);
+	// Decoding does not touch the sound device, so it may run on any thread. LoadSoundDecoded may not.
+	static bool DecodeSound(uint8_t *sfxdata, int length, FDecodedSound &decoded);
+	SoundHandle LoadSoundDecoded(FDecodedSound &decoded);
 	virtual SoundHandle LoadSoundRaw(uint8_t *sfxdata, int length, int frequency, int channels, int bits, int loopstart, int loopend = -1) = 0;
 	virtual void UnloadSound (SoundHandle sfx) = 0;	// unloads a sound from memory
 	virtual unsigned int GetMSLength(SoundHandle sfx) = 0;	// Gets the length of a sound at its default frequency
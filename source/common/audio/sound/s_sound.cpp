@@ -41,6 +41,7 @@
 #include "m_swap.h"
 #include "superfasthash.h"
 #include "s_music.h"
+#include "parallel_for.h"
 
 
 enum
@@ -76,6 +77,8 @@ void SoundEngine::Init(TArray<uint8_t> &curve)
 
 void SoundEngine::Clear()
 {
+	FinishDecoding();
+	PendingSounds.Clear();
 	StopAllChannels();
 	UnloadAllSounds();
 	GetSounds().Clear();
@@ -92,6 +95,7 @@ void SoundEngine::Shutdown ()
 {
 	FSoundChan *chan, *next;
 
+	FinishDecoding();
 	StopAllChannels();
 
 	for (chan = FreeChannels; chan != NULL; chan = next)
@@ -130,13 +134,23 @@ void SoundEngine::CacheMarkedSounds()
 		MarkUsed(chan->SoundID);
 	}
 
+	TArray<sfxinfo_t*> marked;
 	for (unsigned i = 1; i < S_sfx.Size(); ++i)
 	{
 		if (S_sfx[i].bUsed)
 		{
-			CacheSound(&S_sfx[i]);
+			marked.Push(&S_sfx[i]);
 		}
 	}
+	DecodeSounds(marked);
+	FinishDecoding();
+
+	for (auto sfx : marked)
+	{
+		CacheSound(sfx);
+	}
+	PendingSounds.Clear();
+
 	for (unsigned i = 1; i < S_sfx.Size(); ++i)
 	{
 		if (!S_sfx[i].bUsed && S_sfx[i].link == sfxinfo_t::NO_LINK)
@@ -146,6 +160,139 @@ void SoundEngine::CacheMarkedSounds()
 	}
 }
 
+//==========================================================================
+//
+// Cache all sounds
+//
+// StartCachingAllSounds only reads the sounds and leaves the decoding
+// running in the background, so that the caller can load other things
+// before CacheAllSounds finishes the job.
+//
+//==========================================================================
+
+void SoundEngine::StartCachingAllSounds()
+{
+	TArray<sfxinfo_t*> all;
+	for (auto& sfx : S_sfx)
+	{
+		all.Push(&sfx);
+	}
+	DecodeSounds(all);
+}
+
+void SoundEngine::CacheAllSounds()
+{
+	// Sounds that StartCachingAllSounds already read are skipped here.
+	StartCachingAllSounds();
+	FinishDecoding();
+
+	for (auto& sfx : S_sfx)
+	{
+		CacheSound(&sfx);
+	}
+	PendingSounds.Clear();
+}
+
+//==========================================================================
+//
+// DecodeSounds
+//
+// Reads the lumps of the given sounds ahead of caching them and starts
+// decoding the ones that need a codec in the background. LoadSound picks
+// up the results. The lumps themselves are read here because the file
+// system is not thread safe, and the sound device is only touched by
+// LoadSound.
+//
+// ZMusic's decoders can run on any thread, but creating them is not
+// thread safe. The workers serialize that among themselves (see
+// SoundRenderer::DecodeSound), and the game thread calls FinishDecoding
+// before it can create one itself, in LoadSound or when opening music.
+//
+//==========================================================================
+
+void SoundEngine::DecodeSounds(const TArray<sfxinfo_t*>& sounds)
+{
+	if (!GSnd || GSnd->IsNull()) return;
+
+	// PendingSounds may not change while a task is working on its entries.
+	FinishDecoding();
+
+	TArray<sfxinfo_t*> work = sounds;
+	TArray<int> jobs;
+
+	for (unsigned w = 0; w < work.Size(); w++)
+	{
+		auto sfx = work[w];
+		if (sfx->bTentative) continue;
+
+		// Follow links the same way CacheSound does.
+		while (!sfx->bRandomHeader && sfx->link != sfxinfo_t::NO_LINK)
+		{
+			sfx = &S_sfx[sfx->link];
+		}
+		if (sfx->bRandomHeader)
+		{
+			for (auto choice : S_rnd[sfx->link].Choices)
+			{
+				work.Push(&S_sfx[choice]);
+			}
+			continue;
+		}
+
+		int lump = sfx->lumpnum;
+		if (lump == -1 || sfx->data.isValid() || PendingSounds.CheckKey(lump) || FindLoadedLump(sfx) >= 0) continue;
+
+		auto& pending = PendingSounds[lump];
+		pending.lumpdata = ReadSound(lump);
+
+		auto sfxdata = pending.lumpdata.Data();
+		int size = pending.lumpdata.Size();
+		if (sfx->bLoadRAW || size <= 8) continue;
+
+		// Only sounds that go through the codecs are worth decoding ahead. See LoadSound.
+		int32_t dmxlen = LittleLong(((int32_t *)sfxdata)[1]);
+		if (strncmp((const char *)sfxdata, "Creative Voice File", 19) == 0) continue;
+		if (sfxdata[0] == 3 && sfxdata[1] == 0 && dmxlen <= size - 8) continue;
+
+		jobs.Push(lump);
+	}
+	if (jobs.Size() == 0) return;
+
+	// PendingSounds is not modified again before FinishDecoding, so the entries stay where they are.
+	TArray<FPendingSound*> decode;
+	for (auto lump : jobs)
+	{
+		decode.Push(PendingSounds.CheckKey(lump));
+	}
+
+	DecodeTask = std::async(std::launch::async, [decode = std::move(decode)]()
+	{
+		parallel_for((int)decode.Size(), [&](int i)
+		{
+			auto pending = decode[i];
+			pending->decodeok = SoundRenderer::DecodeSound(pending->lumpdata.Data(), pending->lumpdata.Size(), pending->decoded);
+			pending->lumpdata.Reset();
+			pending->isdecoded = true;
+		});
+	});
+}
+
+//==========================================================================
+//
+// FinishDecoding
+//
+// Waits for the sounds DecodeSounds is still working on.
+//
+//==========================================================================
+
+void SoundEngine::FinishDecoding()
+{
+	if (DecodeTask.valid())
+	{
+		DecodeTask.get();
+	}
+}
+
 //==========================================================================
 //
 // S_CacheSound
@@ -182,7 +329,16 @@ void SoundEngine::CacheSound (sfxinfo_t *sfx)
 void SoundEngine::UnloadSound (sfxinfo_t *sfx)
 {
 	if (sfx->data.isValid())
+	{
 		GSnd->UnloadSound(sfx->data);
+
+		auto loaded = LoadedLumps.CheckKey(sfx->lumpnum);
+		if (loaded)
+		{
+			unsigned index = loaded->Find(unsigned(sfx - S_sfx.Data()));
+			if (index < loaded->Size()) loaded->Delete(index);
+		}
+	}
 	sfx->data.Clear();
 }
 
@@ -686,8 +842,6 @@ sfxinfo_t *SoundEngine::LoadSound(sfxinfo_t *sfx)
 
 	while (!sfx->data.isValid())
 	{
-		unsigned int i;
-
 		// If the sound doesn't exist, replace it with the empty sound.
 		if (sfx->lumpnum == -1)
 		{
@@ -696,23 +850,38 @@ sfxinfo_t *SoundEngine::LoadSound(sfxinfo_t *sfx)
 		
 		// See if there is another sound already initialized with this lump. If so,
 		// then set this one up as a link, and don't load the sound again.
-		for (i = 0; i < S_sfx.Size(); i++)
+		int i = FindLoadedLump(sfx);
+		if (i >= 0)
 		{
-			if (S_sfx[i].data.isValid() && S_sfx[i].link == sfxinfo_t::NO_LINK && S_sfx[i].lumpnum == sfx->lumpnum &&
-				(!sfx->bLoadRAW || (sfx->RawRate == S_sfx[i].RawRate)))	// Raw sounds with different sample rates may not share buffers, even if they use the same source data.
-			{
-				//DPrintf (DMSG_NOTIFY, "Linked %s to %s (%d)\n", sfx->name.GetChars(), S_sfx[i].name.GetChars(), i);
-				sfx->link = i;
-				// This is necessary to avoid using the rolloff settings of the linked sound if its
-				// settings are different.
-				if (sfx->Rolloff.MinDistance == 0) sfx->Rolloff = S_Rolloff;
-				return &S_sfx[i];
-			}
+			//DPrintf (DMSG_NOTIFY, "Linked %s to %s (%d)\n", sfx->name.GetChars(), S_sfx[i].name.GetChars(), i);
+			sfx->link = i;
+			// This is necessary to avoid using the rolloff settings of the linked sound if its
+			// settings are different.
+			if (sfx->Rolloff.MinDistance == 0) sfx->Rolloff = S_Rolloff;
+			return &S_sfx[i];
 		}
 
 		//DPrintf(DMSG_NOTIFY, "Loading sound \"%s\" (%td)\n", sfx->name.GetChars(), sfx - &S_sfx[0]);
 
-		auto sfxdata = ReadSound(sfx->lumpnum);
+		TArray<uint8_t> sfxdata;
+		FinishDecoding();
+		auto pending = PendingSounds.CheckKey(sfx->lumpnum);
+		if (pending && pending->isdecoded && !sfx->bLoadRAW)
+		{
+			// If decoding failed, the sound stays invalid and gets replaced with the empty sound below.
+			if (pending->decodeok) sfx->data = GSnd->LoadSoundDecoded(pending->decoded);
+			PendingSounds.Remove(sfx->lumpnum);
+		}
+		else if (pending && !pending->isdecoded)
+		{
+			sfxdata = std::move(pending->lumpdata);
+			PendingSounds.Remove(sfx->lumpnum);
+		}
+		else
+		{
+			sfxdata = ReadSound(sfx->lumpnum);
+		}
+
 		int size = sfxdata.Size();
 		if (size > 8)
 		{
@@ -750,11 +919,46 @@ sfxinfo_t *SoundEngine::LoadSound(sfxinfo_t *sfx)
 				continue;
 			}
 		}
+		else
+		{
+			// Keep the list in S_sfx order so that links go to the same sound as a linear search would.
+			auto& loaded = LoadedLumps[sfx->lumpnum];
+			unsigned index = unsigned(sfx - S_sfx.Data());
+			unsigned pos = 0;
+			while (pos < loaded.Size() && loaded[pos] < index) pos++;
+			loaded.Insert(pos, index);
+		}
 		break;
 	}
 	return sfx;
 }
 
+//==========================================================================
+//
+// FindLoadedLump
+//
+// Returns a loaded sound using the same lump as sfx that sfx can link to,
+// or -1 if there is none.
+//
+//==========================================================================
+
+int SoundEngine::FindLoadedLump(sfxinfo_t* sfx)
+{
+	auto loaded = LoadedLumps.CheckKey(sfx->lumpnum);
+	if (loaded == nullptr) return -1;
+
+	for (auto i : *loaded)
+	{
+		// The game may have rebuilt S_sfx behind our back, so check that the entry still applies.
+		if (i < S_sfx.Size() && S_sfx[i].data.isValid() && S_sfx[i].link == sfxinfo_t::NO_LINK && S_sfx[i].lumpnum == sfx->lumpnum &&
+			(!sfx->bLoadRAW || (sfx->RawRate == S_sfx[i].RawRate)))	// Raw sounds with different sample rates may not share buffers, even if they use the same source data.
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
 //==========================================================================
 //
 // S_CheckSingular
@@ -1384,6 +1588,7 @@ void SoundEngine::UnloadAllSounds()
 	{
 		UnloadSound(&S_sfx[i]);
 	}
+	LoadedLumps.Clear();
 }
 
 void SoundEngine::Reset()
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <future>
 #include "i_sound.h"
 
 struct FRandomSoundList
@@ -239,12 +240,28 @@ protected:
 	TMap<int, int> ResIdMap;
 	TArray<FRandomSoundList> S_rnd;
 
+	// Loaded sounds by lump, so that LoadSound can find a sound to link to.
+	TMap<int, TArray<unsigned>> LoadedLumps;
+
+	// Lumps read ahead by DecodeSounds, and decoded if they need a codec.
+	struct FPendingSound
+	{
+		TArray<uint8_t> lumpdata;
+		FDecodedSound decoded;
+		bool isdecoded = false;
+		bool decodeok = false;	// result of DecodeSound, only valid once isdecoded is set
+	};
+	TMap<int, FPendingSound> PendingSounds;
+	std::future<void> DecodeTask;	// decodes PendingSounds in the background, see DecodeSounds
+
 private:
 	void LinkChannel(FSoundChan* chan, FSoundChan** head);
 	void UnlinkChannel(FSoundChan* chan);
 	void ReturnChannel(FSoundChan* chan);
 	void RestartChannel(FSoundChan* chan);
 	void RestoreEvictedChannel(FSoundChan* chan);
+	int FindLoadedLump(sfxinfo_t* sfx);
+	void DecodeSounds(const TArray<sfxinfo_t*>& sounds);
 
 	bool IsChannelUsed(int sourcetype, const void* actor, int channel, int* seen);
 	// This is the actual sound positioning logic which needs to be provided by the client.
@@ -318,6 +335,9 @@ public:
 	void Reset();
 	void MarkUsed(int num);
 	void CacheMarkedSounds();
+	void StartCachingAllSounds();
+	void CacheAllSounds();
+	void FinishDecoding();
 	TArray<FSoundChan*> AllActiveChannels();
 
 	void MarkAllUnused()
@@ -40,6 +40,11 @@
 #include "templates.h"
 #include "palettecontainer.h"
 #include "files.h"
+#ifdef _DEBUG
+#include "c_dispatch.h"
+#include "v_text.h"
+#include "stats.h"
+#endif
 
 PaletteContainer GPalette;
 FColorMatcher ColorMatcher;
@@ -85,6 +90,7 @@ void PaletteContainer::SetPalette(const uint8_t* colors, int transparent_index)
 	}
 
 	uniqueRemaps[0]->crc32 = CalcCRC32((uint8_t*)uniqueRemaps[0]->Palette, sizeof(uniqueRemaps[0]->Palette));
+	ColorMatcher.SetPalette(BaseColors);	// the color matcher's cache is no longer valid.
 
 
 	// Find white and black from the original palette so that they can be
@@ -157,6 +163,8 @@ void PaletteContainer::Clear()
 {
 	remapArena.FreeAllBlocks();
 	uniqueRemaps.Reset();
+	remapHash.Clear();
+	remapHashNext.Reset();
 	TranslationTables.Reset();
 }
 
@@ -201,15 +209,32 @@ FRemapTable* PaletteContainer::AddRemap(FRemapTable* remap)
 
 	remap->crc32 = CalcCRC32((uint8_t*)remap->Palette, sizeof(remap->Palette));
 
-	for (auto uremap : uniqueRemaps)
+	auto isSame = [=](FRemapTable* uremap)
 	{
-		if (uremap->crc32 == remap->crc32 && uremap->NumEntries == remap->NumEntries && *uremap == *remap && remap->Inactive == uremap->Inactive)
-			return uremap;
+		return uremap->crc32 == remap->crc32 && uremap->NumEntries == remap->NumEntries && *uremap == *remap && remap->Inactive == uremap->Inactive;
+	};
+
+	// The identity table gets changed in place by SetPalette, so it is not in the hash and needs to be checked separately.
+	if (uniqueRemaps.Size() > 0 && isSame(uniqueRemaps[0]))
+		return uniqueRemaps[0];
+
+	auto head = remapHash.CheckKey(remap->crc32);
+	for (int i = head ? *head : -1; i >= 0; i = remapHashNext[i])
+	{
+		if (isSame(uniqueRemaps[i]))
+			return uniqueRemaps[i];
 	}
+
 	auto newremap = (FRemapTable*)remapArena.Alloc(sizeof(FRemapTable));
 	*newremap = *remap;
 	auto index = uniqueRemaps.Push(newremap);
 	newremap->Index = index;
+	if (index > 0)
+	{
+		remapHashNext.Push(head ? *head : -1);
+		remapHash[remap->crc32] = index;
+	}
+	else remapHashNext.Push(-1);
 	return newremap;
 }
 
@@ -820,4 +845,49 @@ bool FRemapTable::AddColors(int start, int count, const uint8_t*colors, int tran
 
 }
 
+#ifdef _DEBUG
+//----------------------------------------------------------------------------
+//
+// bench_colormatcher
+//
+// Matches a grid of colors against the current palette with BestColor and
+// the color matcher, and checks that both agree.
+//
+//----------------------------------------------------------------------------
 
+CCMD(bench_colormatcher)
+{
+	int const step = argv.argc() > 1 ? clamp((int)strtol(argv[1], nullptr, 10), 1, 64) : 4;
+	FColorMatcher matcher((uint32_t*)GPalette.BaseColors);
+	TArray<uint8_t> linearresult, matcherresult;
+
+	cycle_t lineartime, matchertime;
+	lineartime.Reset();
+	matchertime.Reset();
+
+	lineartime.Clock();
+	for (int r = 0; r < 256; r += step)
+		for (int g = 0; g < 256; g += step)
+			for (int b = 0; b < 256; b += step)
+				linearresult.Push((uint8_t)BestColor((uint32_t*)GPalette.BaseColors, r, g, b, 1, 255));
+	lineartime.Unclock();
+
+	matchertime.Clock();
+	for (int r = 0; r < 256; r += step)
+		for (int g = 0; g < 256; g += step)
+			for (int b = 0; b < 256; b += step)
+				matcherresult.Push(matcher.Pick(r, g, b));
+	matchertime.Unclock();
+
+	int mismatches = 0;
+	for (unsigned i = 0; i < linearresult.Size(); i++)
+		if (linearresult[i] != matcherresult[i])
+			mismatches++;
+
+	Printf("bench_colormatcher: %u colors\n", linearresult.Size());
+	Printf("  BestColor:     %.3f ms\n", lineartime.TimeMS());
+	Printf("  color matcher: %.3f ms (including cell setup)\n", matchertime.TimeMS());
+	if (mismatches)
+		Printf(TEXTCOLOR_RED "  %d mismatches!\n", mismatches);
+}
+#endif
@@ -96,6 +96,8 @@ public:
 
 private:
 	FMemArena remapArena;
+	TMap<int, int> remapHash;		// CRC32 -> last unique remap with that CRC, excluding the identity table
+	TArray<int> remapHashNext;		// previous unique remap with the same CRC, or -1
 	TArray<TAutoGrowArray<FRemapTablePtr, FRemapTable*>> TranslationTables;
 public:
 	void Init(int numslots);	// This cannot be a constructor!!!
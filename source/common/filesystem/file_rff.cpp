@@ -215,19 +215,25 @@ FileReader *FRFFLump::GetReader()
 
 int FRFFLump::FillCache()
 {
-	int res = FUncompressedLump::FillCache();
+	if (!(Flags & LUMPF_COMPRESSED))
+	{
+		return FUncompressedLump::FillCache();
+	}
+
+	// Encrypted lumps always need their own copy. Decrypting in the container's buffer would garble the data for the next FillCache.
+	Owner->Reader.Seek(Position, FileReader::SeekSet);
+	Cache = new char[LumpSize];
+	Owner->Reader.Read(Cache, LumpSize);
+	RefCount = 1;
 
-	if (Flags & LUMPF_COMPRESSED)
+	int cryptlen = MIN<int> (LumpSize, 256);
+	uint8_t *data = (uint8_t *)Cache;
+
+	for (int i = 0; i < cryptlen; ++i)
 	{
-		int cryptlen = MIN<int> (LumpSize, 256);
-		uint8_t *data = (uint8_t *)Cache;
-		
-		for (int i = 0; i < cryptlen; ++i)
-		{
-			data[i] ^= i >> 1;
-		}
+		data[i] ^= i >> 1;
 	}
-	return res;
+	return 1;
 }
 
 
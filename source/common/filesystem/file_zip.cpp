@@ -41,6 +41,7 @@
 #include "w_zip.h"
 
 #include "ancientzip.h"
+#include "lumpdircache.h"
 
 #define BUFREADCOMMENT (0x400)
 
@@ -170,13 +171,16 @@ FZipFile::FZipFile(const char * filename, FileReader &file)
 	Lumps = NULL;
 }
 
-bool FZipFile::Open(bool quiet, LumpFilterInfo* filter)
+//==========================================================================
+//
+// Reads the central directory into a form that can be cached.
+//
+//==========================================================================
+
+bool FZipFile::ReadDirectory(bool quiet, FZipDirectory &dir)
 {
 	uint32_t centraldir = Zip_FindCentralDir(Reader);
 	FZipEndOfCentralDirectory info;
-	int skipped = 0;
-
-	Lumps = NULL;
 
 	if (centraldir == 0)
 	{
@@ -196,8 +200,7 @@ bool FZipFile::Open(bool quiet, LumpFilterInfo* filter)
 		return false;
 	}
 
-	NumLumps = LittleShort(info.NumEntries);
-	Lumps = new FZipLump[NumLumps];
+	uint32_t numentries = LittleShort(info.NumEntries);
 
 	// Load the entire central directory. Too bad that this contains variable length entries...
 	int dirsize = LittleLong(info.DirectorySize);
@@ -206,24 +209,19 @@ bool FZipFile::Open(bool quiet, LumpFilterInfo* filter)
 	Reader.Read(directory, dirsize);
 
 	char *dirptr = (char*)directory;
-	FZipLump *lump_p = Lumps;
-
-	FString name0;
-	bool foundspeciallump = false;
+	dir.Entries.Resize(numentries);
+	dir.Names.Clear();
 
-	// Check if all files have the same prefix so that this can be stripped out.
-	// This will only be done if there is either a MAPINFO, ZMAPINFO or GAMEINFO lump in the subdirectory, denoting a ZDoom mod.
-	if (NumLumps > 1) for (uint32_t i = 0; i < NumLumps; i++)
+	for (uint32_t i = 0; i < numentries; i++)
 	{
 		FZipCentralDirectoryInfo *zip_fh = (FZipCentralDirectoryInfo *)dirptr;
+		char *nameptr = dirptr + sizeof(FZipCentralDirectoryInfo);
 
 		int len = LittleShort(zip_fh->NameLength);
-		FString name(dirptr + sizeof(FZipCentralDirectoryInfo), len);
-
-		dirptr += sizeof(FZipCentralDirectoryInfo) +
-			LittleShort(zip_fh->NameLength) +
-			LittleShort(zip_fh->ExtraLength) +
-			LittleShort(zip_fh->CommentLength);
+		dirptr += sizeof(FZipCentralDirectoryInfo) + 
+				  LittleShort(zip_fh->NameLength) + 
+				  LittleShort(zip_fh->ExtraLength) + 
+				  LittleShort(zip_fh->CommentLength);
 
 		if (dirptr > ((char*)directory) + dirsize)	// This directory entry goes beyond the end of the file.
 		{
@@ -232,6 +230,56 @@ bool FZipFile::Open(bool quiet, LumpFilterInfo* filter)
 			return false;
 		}
 
+		auto &entry = dir.Entries[i];
+		entry.UncompressedSize = LittleLong(zip_fh->UncompressedSize);
+		entry.CompressedSize = LittleLong(zip_fh->CompressedSize);
+		entry.CRC32 = zip_fh->CRC32;
+		entry.LocalHeaderOffset = LittleLong(zip_fh->LocalHeaderOffset);
+		entry.NameOffset = dir.Names.Size();
+		entry.NameLength = (uint16_t)len;
+		entry.Method = LittleShort(zip_fh->Method);
+		entry.Flags = LittleShort(zip_fh->Flags);
+		entry.Padding = 0;
+		if (len > 0) memcpy(&dir.Names[dir.Names.Reserve(len)], nameptr, len);
+	}
+	free(directory);
+	return true;
+}
+
+//==========================================================================
+//
+// Zip file
+//
+//==========================================================================
+
+bool FZipFile::Open(bool quiet, LumpFilterInfo* filter)
+{
+	FZipDirectory dir;
+	int skipped = 0;
+
+	Lumps = NULL;
+
+	if (!lumpDirCache.FindZipDirectory(FileName, Reader.GetLength(), dir))
+	{
+		if (!ReadDirectory(quiet, dir)) return false;
+		lumpDirCache.StoreZipDirectory(FileName, Reader.GetLength(), dir);
+	}
+
+	NumLumps = dir.Entries.Size();
+	Lumps = new FZipLump[NumLumps];
+
+	FZipLump *lump_p = Lumps;
+
+	FString name0;
+	bool foundspeciallump = false;
+
+	// Check if all files have the same prefix so that this can be stripped out.
+	// This will only be done if there is either a MAPINFO, ZMAPINFO or GAMEINFO lump in the subdirectory, denoting a ZDoom mod.
+	if (NumLumps > 1) for (uint32_t i = 0; i < NumLumps; i++)
+	{
+		auto &entry = dir.Entries[i];
+		FString name(dir.Names.Data() + entry.NameOffset, entry.NameLength);
+
 		name.ToLower();
 		if (i == 0)
 		{
@@ -264,50 +312,34 @@ bool FZipFile::Open(bool quiet, LumpFilterInfo* filter)
 	// If it ran through the list without finding anything it should not attempt any path remapping.
 	if (!foundspeciallump) name0 = "";
 
-	dirptr = (char*)directory;
 	lump_p = Lumps;
-	for (uint32_t i = 0; i < NumLumps; i++)
+	for (uint32_t i = 0; i < dir.Entries.Size(); i++)
 	{
-		FZipCentralDirectoryInfo *zip_fh = (FZipCentralDirectoryInfo *)dirptr;
-
-		int len = LittleShort(zip_fh->NameLength);
-		FString name(dirptr + sizeof(FZipCentralDirectoryInfo), len);
+		auto &entry = dir.Entries[i];
+		FString name(dir.Names.Data() + entry.NameOffset, entry.NameLength);
 		if (name0.IsNotEmpty()) name = name.Mid(name0.Len());
-		dirptr += sizeof(FZipCentralDirectoryInfo) + 
-				  LittleShort(zip_fh->NameLength) + 
-				  LittleShort(zip_fh->ExtraLength) + 
-				  LittleShort(zip_fh->CommentLength);
-
-		if (dirptr > ((char*)directory) + dirsize)	// This directory entry goes beyond the end of the file.
-		{
-			free(directory);
-			if (!quiet) Printf(TEXTCOLOR_RED "\n%s: Central directory corrupted.", FileName.GetChars());
-			return false;
-		}
 		
 		// skip Directories
-		if (name.IsEmpty() || (name.Back() == '/' && LittleLong(zip_fh->UncompressedSize) == 0))
+		if (name.IsEmpty() || (name.Back() == '/' && entry.UncompressedSize == 0))
 		{
 			skipped++;
 			continue;
 		}
 
 		// Ignore unknown compression formats
-		zip_fh->Method = LittleShort(zip_fh->Method);
-		if (zip_fh->Method != METHOD_STORED &&
-			zip_fh->Method != METHOD_DEFLATE &&
-			zip_fh->Method != METHOD_LZMA &&
-			zip_fh->Method != METHOD_BZIP2 &&
-			zip_fh->Method != METHOD_IMPLODE &&
-			zip_fh->Method != METHOD_SHRINK)
+		if (entry.Method != METHOD_STORED &&
+			entry.Method != METHOD_DEFLATE &&
+			entry.Method != METHOD_LZMA &&
+			entry.Method != METHOD_BZIP2 &&
+			entry.Method != METHOD_IMPLODE &&
+			entry.Method != METHOD_SHRINK)
 		{
-			if (!quiet) Printf(TEXTCOLOR_YELLOW "\n%s: '%s' uses an unsupported compression algorithm (#%d).\n", FileName.GetChars(), name.GetChars(), zip_fh->Method);
+			if (!quiet) Printf(TEXTCOLOR_YELLOW "\n%s: '%s' uses an unsupported compression algorithm (#%d).\n", FileName.GetChars(), name.GetChars(), entry.Method);
 			skipped++;
 			continue;
 		}
 		// Also ignore encrypted entries
-		zip_fh->Flags = LittleShort(zip_fh->Flags);
-		if (zip_fh->Flags & ZF_ENCRYPTED)
+		if (entry.Flags & ZF_ENCRYPTED)
 		{
 			if (!quiet) Printf(TEXTCOLOR_YELLOW "\n%s: '%s' is encrypted. Encryption is not supported.\n", FileName.GetChars(), name.GetChars());
 			skipped++;
@@ -318,24 +350,23 @@ bool FZipFile::Open(bool quiet, LumpFilterInfo* filter)
 		name.ToLower();
 
 		lump_p->LumpNameSetup(name);
-		lump_p->LumpSize = LittleLong(zip_fh->UncompressedSize);
+		lump_p->LumpSize = entry.UncompressedSize;
 		lump_p->Owner = this;
 		// The start of the Reader will be determined the first time it is accessed.
 		lump_p->Flags = LUMPF_FULLPATH;
 		lump_p->NeedFileStart = true;
-		lump_p->Method = uint8_t(zip_fh->Method);
+		lump_p->Method = uint8_t(entry.Method);
 		if (lump_p->Method != METHOD_STORED) lump_p->Flags |= LUMPF_COMPRESSED;
-		lump_p->GPFlags = zip_fh->Flags;
-		lump_p->CRC32 = zip_fh->CRC32;
-		lump_p->CompressedSize = LittleLong(zip_fh->CompressedSize);
-		lump_p->Position = LittleLong(zip_fh->LocalHeaderOffset);
+		lump_p->GPFlags = entry.Flags;
+		lump_p->CRC32 = entry.CRC32;
+		lump_p->CompressedSize = entry.CompressedSize;
+		lump_p->Position = entry.LocalHeaderOffset;
 		lump_p->CheckEmbedded();
 
 		lump_p++;
 	}
 	// Resize the lump record array to its actual size
 	NumLumps -= skipped;
-	free(directory);
 
 	GenerateHash();
 	PostProcessArchive(&Lumps[0], sizeof(FZipLump), filter);
@@ -419,7 +450,8 @@ int FZipLump::FillCache()
 	if (NeedFileStart) SetLumpAddress();
 	const char *buffer;
 
-	if (Method == METHOD_STORED && (buffer = Owner->Reader.GetBuffer()) != NULL)
+	// Mapped files are read-only, and callers may write to the locked data.
+	if (Method == METHOD_STORED && (buffer = Owner->Reader.GetBuffer()) != NULL && !Owner->Reader.IsMapped())
 	{
 		// This is an in-memory file so the cache can point directly to the file's data.
 		Cache = const_cast<char*>(buffer) + Position;
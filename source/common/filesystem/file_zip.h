@@ -34,10 +34,14 @@ private:
 //
 //==========================================================================
 
+struct FZipDirectory;
+
 class FZipFile : public FResourceFile
 {
 	FZipLump *Lumps;
 
+	bool ReadDirectory(bool quiet, FZipDirectory &dir);
+
 public:
 	FZipFile(const char * filename, FileReader &file);
 	virtual ~FZipFile();
@@ -46,6 +46,9 @@
 #include "m_crc32.h"
 #include "printf.h"
 #include "md5.h"
+#include "stats.h"
+#include "version.h"
+#include "lumpdircache.h"
 
 extern	FILE* hashfile;
 
@@ -145,6 +148,10 @@ static void PrintLastError ();
 
 FileSystem fileSystem;
 
+// PRIVATE DATA DEFINITIONS ------------------------------------------------
+
+static cycle_t InitFilesTime, InitHashTime;
+
 // CODE --------------------------------------------------------------------
 
 FileSystem::FileSystem()
@@ -201,6 +208,11 @@ void FileSystem::InitMultipleFiles (TArray<FString> &filenames, bool quiet, Lump
 	DeleteAll();
 	numfiles = 0;
 
+	InitFilesTime.Reset();
+	InitHashTime.Reset();
+	InitFilesTime.Clock();
+	lumpDirCache.Open();
+
 	for(unsigned i=0;i<filenames.Size(); i++)
 	{
 		int baselump = NumEntries;
@@ -214,13 +226,82 @@ void FileSystem::InitMultipleFiles (TArray<FString> &filenames, bool quiet, Lump
 	NumEntries = FileInfo.Size();
 	if (NumEntries == 0)
 	{
+		InitFilesTime.Unclock();
+		lumpDirCache.Close();
 		if (!quiet) I_FatalError("W_InitMultipleFiles: no files found");
 		else return;
 	}
 	if (filter && filter->postprocessFunc) filter->postprocessFunc();
+	InitFilesTime.Unclock();
 
 	// [RH] Set up hash table
-	InitHashChains ();
+	InitHashTime.Clock();
+	uint8_t key[16];
+	bool cacheable = GetHashChainsKey(filter, key);
+	if (cacheable && lumpDirCache.FindHashChains(key, Hashes) && Hashes.Size() == 8 * NumEntries)
+	{
+		SetHashPointers();
+		FileInfo.ShrinkToFit();
+		Files.ShrinkToFit();
+	}
+	else
+	{
+		InitHashChains ();
+		if (cacheable) lumpDirCache.StoreHashChains(key, Hashes);
+	}
+	InitHashTime.Unclock();
+	lumpDirCache.Close();
+}
+
+//==========================================================================
+//
+// GetHashChainsKey
+//
+// The hash chains only depend on the final lump directory, so they can
+// be reused as long as nothing that goes into building it has changed.
+// Directories are never cached because their contents can change
+// without anything this can check.
+//
+//==========================================================================
+
+bool FileSystem::GetHashChainsKey(LumpFilterInfo *filter, uint8_t *key)
+{
+	if (filter && filter->postprocessFunc && filter->postprocessKey.IsEmpty()) return false;
+
+	MD5Context md5;
+	auto addString = [&](const FString &str)
+	{
+		md5.Update((const uint8_t *)str.GetChars(), (unsigned)str.Len() + 1);
+	};
+	auto addInt = [&](int64_t v)
+	{
+		md5.Update((const uint8_t *)&v, sizeof(v));
+	};
+
+	addString(GetGitHash());
+	for (auto file : Files)
+	{
+		if (file->GetReader() == nullptr) return false;
+		addString(file->FileName);
+
+		// Embedded files have no file info of their own but are covered by their container.
+		size_t size = 0;
+		time_t time = 0;
+		GetFileInfo(file->FileName, &size, &time);
+		addInt(size);
+		addInt(time);
+	}
+	addInt(NumEntries);
+	addInt(IwadIndex);
+	addInt(MaxIwadIndex);
+	if (filter)
+	{
+		addString(filter->dotFilter);
+		for (auto &str : filter->gameTypeFilter) addString(str);
+		addString(filter->postprocessKey);
+	}
+	md5.Final(key);
+	return true;
 }
 
 //==========================================================================
@@ -301,7 +382,8 @@ void FileSystem::AddFile (const char *filename, FileReader *filer, bool quiet, L
 
 		if (!isdir)
 		{
-			if (!filereader.OpenFile(filename))
+			// Archives get mapped into memory if possible so that stored lumps can be accessed in place.
+			if (!filereader.OpenMappedFile(filename) && !filereader.OpenFile(filename))
 			{ // Didn't find file
 				if (!quiet)
 				{
@@ -840,15 +922,7 @@ void FileSystem::InitHashChains (void)
 	Hashes.Resize(8 * NumEntries);
 	// Mark all buckets as empty
 	memset(Hashes.Data(), -1, Hashes.Size() * sizeof(Hashes[0]));
-	FirstLumpIndex = &Hashes[0];
-	NextLumpIndex = &Hashes[NumEntries];
-	FirstLumpIndex_FullName = &Hashes[NumEntries * 2];
-	NextLumpIndex_FullName = &Hashes[NumEntries * 3];
-	FirstLumpIndex_NoExt = &Hashes[NumEntries * 4];
-	NextLumpIndex_NoExt = &Hashes[NumEntries * 5];
-	FirstLumpIndex_ResId = &Hashes[NumEntries * 6];
-	NextLumpIndex_ResId = &Hashes[NumEntries * 7];
-
+	SetHashPointers();
 
 	// Now set up the chains
 	for (i = 0; i < (unsigned)NumEntries; i++)
@@ -864,12 +938,13 @@ void FileSystem::InitHashChains (void)
 			NextLumpIndex_FullName[i] = FirstLumpIndex_FullName[j];
 			FirstLumpIndex_FullName[j] = i;
 
-			FString nameNoExt = FileInfo[i].longName;
-			auto dot = nameNoExt.LastIndexOf('.');
-			auto slash = nameNoExt.LastIndexOf('/');
-			if (dot > slash) nameNoExt.Truncate(dot);
+			// Hash the name without extension in place instead of making a truncated copy for every lump.
+			auto &longName = FileInfo[i].longName;
+			auto dot = longName.LastIndexOf('.');
+			auto slash = longName.LastIndexOf('/');
+			size_t noExtLen = dot > slash ? dot : longName.Len();
 
-			j = MakeKey(nameNoExt) % NumEntries;
+			j = MakeKey(longName.GetChars(), noExtLen) % NumEntries;
 			NextLumpIndex_NoExt[i] = FirstLumpIndex_NoExt[j];
 			FirstLumpIndex_NoExt[j] = i;
 
@@ -883,6 +958,24 @@ void FileSystem::InitHashChains (void)
 	Files.ShrinkToFit();
 }
 
+//==========================================================================
+//
+// SetHashPointers
+//
+//==========================================================================
+
+void FileSystem::SetHashPointers()
+{
+	FirstLumpIndex = &Hashes[0];
+	NextLumpIndex = &Hashes[NumEntries];
+	FirstLumpIndex_FullName = &Hashes[NumEntries * 2];
+	NextLumpIndex_FullName = &Hashes[NumEntries * 3];
+	FirstLumpIndex_NoExt = &Hashes[NumEntries * 4];
+	NextLumpIndex_NoExt = &Hashes[NumEntries * 5];
+	FirstLumpIndex_ResId = &Hashes[NumEntries * 6];
+	NextLumpIndex_ResId = &Hashes[NumEntries * 7];
+}
+
 //==========================================================================
 //
 // should only be called before the hash chains are set up.
@@ -928,7 +1021,7 @@ void FileSystem::MoveLumpsInFolder(const char *path)
 	{
 		auto& li = FileInfo[i];
 		if (li.rfnum >= GetIwadNum()) break;
-		if (li.longName.Left(len).CompareNoCase(path) == 0)
+		if (strnicmp(li.longName.GetChars(), path, len) == 0)
 		{
 			FileInfo.Push(li);
 			li.lump = &placeholderLump;			// Make the old entry point to something empty. We cannot delete the lump record here because it'd require adjustment of all indices in the list.
@@ -1364,6 +1457,14 @@ FileReader FileSystem::OpenFileReader(int lump)
 	auto rl = FileInfo[lump].lump;
 	auto rd = rl->GetReader();
 
+	// A locked lump may have been patched, so only unlocked ones are read from the container.
+	auto view = rl->RefCount == 0 ? GetFileView(lump) : nullptr;
+	if (view != nullptr)
+	{
+		FileReader rdr;
+		rdr.OpenMemory(view, rl->LumpSize);
+		return rdr;
+	}
 	if (rl->RefCount == 0 && rd != nullptr && !rd->GetBuffer() && !(rl->Flags & LUMPF_COMPRESSED))
 	{
 		FileReader rdr;
@@ -1383,7 +1484,7 @@ FileReader FileSystem::ReopenFileReader(int lump, bool alwayscache)
 	auto rl = FileInfo[lump].lump;
 	auto rd = rl->GetReader();
 
-	if (rl->RefCount == 0 && rd != nullptr && !rd->GetBuffer() && !alwayscache && !(rl->Flags & LUMPF_COMPRESSED))
+	if (rl->RefCount == 0 && rd != nullptr && (!rd->GetBuffer() || rd->IsMapped()) && !alwayscache && !(rl->Flags & LUMPF_COMPRESSED))
 	{
 		int fileno = fileSystem.GetFileContainer(lump);
 		const char *filename = fileSystem.GetResourceFileName(fileno);
@@ -1396,6 +1497,33 @@ FileReader FileSystem::ReopenFileReader(int lump, bool alwayscache)
 	return rl->NewReader();	// This always gets a reader to the cache
 }
 
+//==========================================================================
+//
+// GetFileView
+//
+// Returns a read-only pointer to a lump's data inside its container if the
+// container is held in memory (e.g. a mapped archive) and the lump is stored
+// without compression. No copy is made and nothing needs to be unlocked.
+// The pointer stays valid as long as the container remains open.
+//
+//==========================================================================
+
+const void *FileSystem::GetFileView(int lump)
+{
+	if ((size_t)lump >= FileInfo.Size()) return nullptr;
+
+	auto rl = FileInfo[lump].lump;
+	if (rl->LumpSize <= 0 || (rl->Flags & LUMPF_COMPRESSED)) return nullptr;
+
+	auto rd = rl->GetReader();
+	if (rd == nullptr) return nullptr;
+
+	auto buffer = rd->GetBuffer();
+	auto offset = rl->GetFileOffset();
+	if (buffer == nullptr || offset < 0) return nullptr;
+	return buffer + offset;
+}
+
 FileReader FileSystem::OpenFileReader(const char* name)
 {
 	auto lump = CheckNumForFullName(name);
@@ -1673,7 +1801,7 @@ const void *FileSystem::Get(int lump)
 	if ((size_t)lump >= FileInfo.Size()) return nullptr;
 	auto lumpp = FileInfo[lump].lump;
 	auto p = lumpp->Lock();
-	lumpp->RefCount = INT_MAX/2; // lock forever.
+	if (lumpp->RefCount >= 0) lumpp->RefCount = INT_MAX/2; // lock forever. Negative counts mean the cache is not owned by the lump.
 	return p;
 }
 
@@ -1699,9 +1827,25 @@ const void *FileSystem::Load(FResourceLump *lump)
 	if (lump)
 	{
 		auto p = lump->Lock();
-		lump->RefCount = INT_MAX/2; // lock forever.
+		if (lump->RefCount >= 0) lump->RefCount = INT_MAX/2; // lock forever.
 		return p;
 	}
 	else return nullptr;
 }
 
+
+//==========================================================================
+//
+// STAT filesystem
+//
+// Time spent opening the resource files and setting up the lump directory
+// during the last initialization.
+//
+//==========================================================================
+
+ADD_STAT(filesystem)
+{
+	FString out;
+	out.Format("files=%d  lumps=%d  open=%04.2f ms  hash=%04.2f ms  %s", fileSystem.GetNumWads(), fileSystem.GetNumEntries(), InitFilesTime.TimeMS(), InitHashTime.TimeMS(), lumpDirCache.GetStats().GetChars());
+	return out;
+}
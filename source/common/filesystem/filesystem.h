@@ -187,6 +187,8 @@ public:
 	int AddFromBuffer(const char* name, const char* type, char* data, int size, int id, int flags);
 	FileReader* GetFileReader(int wadnum);	// Gets a FileReader object to the entire WAD
 	void InitHashChains();
+	void SetHashPointers();
+	bool GetHashChainsKey(LumpFilterInfo *filter, uint8_t *key);
 
 	// Blood stuff
 	FResourceLump* Lookup(const char* name, const char* type);
@@ -194,6 +196,7 @@ public:
 
 	FResourceLump* GetFileAt(int no);
 
+	const void* GetFileView(int lump);	// points directly into the container's memory, or nullptr if the lump has to be read or decompressed.
 	const void* Lock(int lump);
 	void Unlock(int lump);
 	const void* Get(int lump);
@@ -0,0 +1,355 @@
+/*
+** lumpdircache.cpp
+**
+** Keeps the central directories of the loaded Zip files and the resulting
+** hash chains in the cache directory so that the next start with the same
+** files can skip parsing them.
+**
+** An archive's entry is valid as long as the file's path, size and
+** modification time stay the same. The hash chains are keyed on all
+** loaded files and everything else that affects the final directory.
+** Only the archives used in recent sessions are kept, up to MaxArchives.
+**
+** All data is stored in native byte order in 4 byte aligned blocks so that
+** it can be copied straight out of the mapped file. Anything that does not
+** check out throws away the entire cache.
+**
+*/
+
+#include <stdio.h>
+#include <algorithm>
+#include "lumpdircache.h"
+#include "cmdlib.h"
+#include "files.h"
+#include "m_argv.h"
+#include "i_specialpaths.h"
+
+FLumpDirCache lumpDirCache;
+
+static const char LumpDirCacheMagic[4] = { 'Z', 'L', 'D', 'C' };
+static const uint32_t LumpDirCacheVersion = 1;
+static const unsigned MaxArchives = 256;
+
+struct LumpDirCacheHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t numArchives;
+	uint32_t hashOffset;	// 0 if there are no hash chains
+};
+
+struct LumpDirCacheArchive
+{
+	int64_t size;
+	int64_t time;
+	uint32_t pathLength;
+	uint32_t numEntries;
+	uint32_t namesLength;
+	uint32_t padding;
+};
+
+struct LumpDirCacheHashes
+{
+	uint8_t key[16];
+	uint32_t count;
+	uint32_t padding;
+};
+
+static size_t Align4(size_t v)
+{
+	return (v + 3) & ~(size_t)3;
+}
+
+static FString LumpDirCacheName(bool create)
+{
+	FString path = M_GetCachePath(create);
+	if (create) CreatePath(path);
+	path << "/lumpdir.cache";
+	return path;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void FLumpDirCache::Open()
+{
+	if (IsOpen) return;
+
+	Archives.Clear();
+	Hashes.Clear();
+	Changed = false;
+	HashHit = false;
+	NumLookups = NumHits = 0;
+
+	if (Args->CheckParm("-nolumpcache")) return;
+
+	IsOpen = true;
+	Read();
+}
+
+//==========================================================================
+//
+// Writes the cache if anything was added and releases the memory.
+//
+//==========================================================================
+
+void FLumpDirCache::Close()
+{
+	if (!IsOpen) return;
+	IsOpen = false;
+
+	if (Changed) Write();
+	Archives.Reset();
+	Hashes.Reset();
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void FLumpDirCache::Read()
+{
+	FileReader fr;
+	FString name = LumpDirCacheName(false);
+	if (!fr.OpenMappedFile(name) && !fr.OpenFile(name)) return;
+
+	size_t length = fr.GetLength();
+	auto data = (const uint8_t *)fr.GetBuffer();
+	TArray<uint8_t> buffer;
+	if (data == nullptr)
+	{
+		buffer.Resize((unsigned)length);
+		if ((size_t)fr.Read(buffer.Data(), (long)length) != length) return;
+		data = buffer.Data();
+	}
+
+	size_t pos = 0;
+	auto get = [&](size_t len) -> const uint8_t *
+	{
+		if (len > length - pos) return nullptr;
+		auto p = data + pos;
+		pos = std::min(length, pos + Align4(len));
+		return p;
+	};
+
+	auto header = (const LumpDirCacheHeader *)get(sizeof(LumpDirCacheHeader));
+	if (header == nullptr || memcmp(header->magic, LumpDirCacheMagic, 4) || header->version != LumpDirCacheVersion) return;
+
+	for (uint32_t i = 0; i < header->numArchives; i++)
+	{
+		auto arc = (const LumpDirCacheArchive *)get(sizeof(LumpDirCacheArchive));
+		if (arc == nullptr) break;
+
+		auto path = (const char *)get(arc->pathLength);
+		auto entries = (const FZipDirEntry *)get((size_t)arc->numEntries * sizeof(FZipDirEntry));
+		auto names = (const char *)get(arc->namesLength);
+		if (path == nullptr || entries == nullptr || names == nullptr) break;
+
+		bool valid = true;
+		for (uint32_t j = 0; j < arc->numEntries && valid; j++)
+		{
+			valid = (uint64_t)entries[j].NameOffset + entries[j].NameLength <= arc->namesLength;
+		}
+		if (!valid) break;
+
+		auto &a = Archives[Archives.Reserve(1)];
+		a.Path = FString(path, arc->pathLength);
+		a.Size = arc->size;
+		a.Time = arc->time;
+		a.Dir.Entries.Resize(arc->numEntries);
+		memcpy(a.Dir.Entries.Data(), entries, (size_t)arc->numEntries * sizeof(FZipDirEntry));
+		a.Dir.Names.Resize(arc->namesLength);
+		memcpy(a.Dir.Names.Data(), names, arc->namesLength);
+		a.Used = false;
+	}
+
+	if (Archives.Size() != header->numArchives)
+	{
+		Archives.Clear();
+		return;
+	}
+
+	if (header->hashOffset != 0 && header->hashOffset < length)
+	{
+		pos = header->hashOffset;
+		auto hashes = (const LumpDirCacheHashes *)get(sizeof(LumpDirCacheHashes));
+		auto values = hashes ? (const uint32_t *)get((size_t)hashes->count * sizeof(uint32_t)) : nullptr;
+		if (values != nullptr)
+		{
+			memcpy(HashKey, hashes->key, sizeof(HashKey));
+			Hashes.Resize(hashes->count);
+			memcpy(Hashes.Data(), values, (size_t)hashes->count * sizeof(uint32_t));
+		}
+	}
+}
+
+//==========================================================================
+//
+// Writes to a temporary file first so that an interrupted write
+// never leaves a broken cache behind.
+//
+//==========================================================================
+
+void FLumpDirCache::Write()
+{
+	// Archives from this session come first, older ones are kept while their files are unchanged.
+	TArray<Archive *> keep;
+	for (auto &a : Archives) if (a.Used) keep.Push(&a);
+	for (auto &a : Archives)
+	{
+		if (a.Used || keep.Size() >= MaxArchives) continue;
+
+		size_t size;
+		time_t time;
+		if (GetFileInfo(a.Path, &size, &time) && (int64_t)size == a.Size && (int64_t)time == a.Time) keep.Push(&a);
+	}
+	if (keep.Size() > MaxArchives) keep.Resize(MaxArchives);
+
+	TArray<uint8_t> out;
+	auto put = [&](const void *data, size_t len)
+	{
+		if (len == 0) return;
+		auto start = out.Reserve((unsigned)Align4(len));
+		memcpy(out.Data() + start, data, len);
+		memset(out.Data() + start + len, 0, Align4(len) - len);
+	};
+
+	LumpDirCacheHeader header = {};
+	memcpy(header.magic, LumpDirCacheMagic, 4);
+	header.version = LumpDirCacheVersion;
+	header.numArchives = keep.Size();
+	put(&header, sizeof(header));
+
+	for (auto a : keep)
+	{
+		LumpDirCacheArchive arc = {};
+		arc.size = a->Size;
+		arc.time = a->Time;
+		arc.pathLength = (uint32_t)a->Path.Len();
+		arc.numEntries = a->Dir.Entries.Size();
+		arc.namesLength = a->Dir.Names.Size();
+		put(&arc, sizeof(arc));
+		put(a->Path.GetChars(), a->Path.Len());
+		put(a->Dir.Entries.Data(), a->Dir.Entries.Size() * sizeof(FZipDirEntry));
+		put(a->Dir.Names.Data(), a->Dir.Names.Size());
+	}
+
+	if (Hashes.Size() > 0)
+	{
+		((LumpDirCacheHeader *)out.Data())->hashOffset = out.Size();
+
+		LumpDirCacheHashes hashes = {};
+		memcpy(hashes.key, HashKey, sizeof(HashKey));
+		hashes.count = Hashes.Size();
+		put(&hashes, sizeof(hashes));
+		put(Hashes.Data(), Hashes.Size() * sizeof(uint32_t));
+	}
+
+	FString name = LumpDirCacheName(true);
+	FString tempname = name + ".tmp";
+
+	auto fw = FileWriter::Open(tempname);
+	if (fw == nullptr) return;
+	bool ok = fw->Write(out.Data(), out.Size()) == out.Size();
+	delete fw;
+
+	// rename does not replace existing files on Windows.
+	if (ok && rename(tempname, name) != 0)
+	{
+		remove(name);
+		ok = rename(tempname, name) == 0;
+	}
+	if (!ok) remove(tempname);
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+bool FLumpDirCache::FindZipDirectory(const char *filename, int64_t size, FZipDirectory &dir)
+{
+	if (!IsOpen) return false;
+	NumLookups++;
+
+	size_t filesize;
+	time_t time;
+	if (!GetFileInfo(filename, &filesize, &time)) return false;
+
+	for (auto &a : Archives)
+	{
+		if (a.Size == size && a.Size == (int64_t)filesize && a.Time == (int64_t)time && !a.Path.Compare(filename))
+		{
+			a.Used = true;
+			dir = a.Dir;
+			NumHits++;
+			return true;
+		}
+	}
+	return false;
+}
+
+void FLumpDirCache::StoreZipDirectory(const char *filename, int64_t size, const FZipDirectory &dir)
+{
+	size_t filesize;
+	time_t time;
+	if (!IsOpen || !GetFileInfo(filename, &filesize, &time) || (int64_t)filesize != size) return;
+
+	for (unsigned i = 0; i < Archives.Size(); i++)
+	{
+		if (!Archives[i].Path.Compare(filename))
+		{
+			Archives.Delete(i);
+			break;
+		}
+	}
+
+	auto &a = Archives[Archives.Reserve(1)];
+	a.Path = filename;
+	a.Size = size;
+	a.Time = time;
+	a.Dir = dir;
+	a.Used = true;
+	Changed = true;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+bool FLumpDirCache::FindHashChains(const uint8_t *key, TArray<uint32_t> &hashes)
+{
+	if (!IsOpen || Hashes.Size() == 0 || memcmp(key, HashKey, sizeof(HashKey))) return false;
+	hashes = Hashes;
+	HashHit = true;
+	return true;
+}
+
+void FLumpDirCache::StoreHashChains(const uint8_t *key, const TArray<uint32_t> &hashes)
+{
+	if (!IsOpen) return;
+	memcpy(HashKey, key, sizeof(HashKey));
+	Hashes = hashes;
+	Changed = true;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+FString FLumpDirCache::GetStats() const
+{
+	FString out;
+	out.Format("cached dirs=%u/%u  cached hash=%s", NumHits, NumLookups, HashHit ? "yes" : "no");
+	return out;
+}
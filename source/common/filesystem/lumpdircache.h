@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stdint.h>
+#include "tarray.h"
+#include "zstring.h"
+
+// One entry of a Zip file's central directory, with everything FZipFile needs from it.
+// This is also the record stored in the cache file, so changing it requires a new cache version.
+struct FZipDirEntry
+{
+	uint32_t UncompressedSize;
+	uint32_t CompressedSize;
+	uint32_t CRC32;
+	uint32_t LocalHeaderOffset;
+	uint32_t NameOffset;	// into FZipDirectory::Names
+	uint16_t NameLength;
+	uint16_t Method;
+	uint16_t Flags;
+	uint16_t Padding;
+};
+
+struct FZipDirectory
+{
+	TArray<FZipDirEntry> Entries;
+	TArray<char> Names;
+};
+
+// Persistent cache for the parsed directories of Zip files and for the file system's hash chains,
+// keyed on the files' path, size and modification time, so that a warm start neither has to
+// read and parse the central directories nor rebuild the hash chains.
+// It is only open while FileSystem::InitMultipleFiles runs. '-nolumpcache' disables it.
+class FLumpDirCache
+{
+	struct Archive
+	{
+		FString Path;
+		int64_t Size;
+		int64_t Time;
+		FZipDirectory Dir;
+		bool Used;
+	};
+
+	TArray<Archive> Archives;
+	uint8_t HashKey[16];
+	TArray<uint32_t> Hashes;
+	bool IsOpen = false;
+	bool Changed = false;
+	unsigned NumLookups = 0;
+	unsigned NumHits = 0;
+	bool HashHit = false;
+
+	void Read();
+	void Write();
+
+public:
+	void Open();
+	void Close();
+
+	bool FindZipDirectory(const char *filename, int64_t size, FZipDirectory &dir);
+	void StoreZipDirectory(const char *filename, int64_t size, const FZipDirectory &dir);
+	bool FindHashChains(const uint8_t *key, TArray<uint32_t> &hashes);
+	void StoreHashChains(const uint8_t *key, const TArray<uint32_t> &hashes);
+
+	FString GetStats() const;
+};
+
+extern FLumpDirCache lumpDirCache;
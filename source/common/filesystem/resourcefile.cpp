@@ -601,7 +601,8 @@ int FUncompressedLump::FillCache()
 {
 	const char * buffer = Owner->Reader.GetBuffer();
 
-	if (buffer != NULL)
+	// Mapped files are read-only, and callers may write to the locked data.
+	if (buffer != NULL && !Owner->Reader.IsMapped())
 	{
 		// This is an in-memory file so the cache can point directly to the file's data.
 		Cache = const_cast<char*>(buffer) + Position;
@@ -16,6 +16,7 @@ struct LumpFilterInfo
 	TArray<FString> reservedFolders;
 	TArray<FString> requiredPrefixes;
 	std::function<void()> postprocessFunc;
+	FString postprocessKey;	// describes what postprocessFunc does. Without it the lump directory will not be cached.
 };
 
 class FResourceFile;
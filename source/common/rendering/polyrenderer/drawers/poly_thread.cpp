@@ -45,15 +45,12 @@ void PolyTriangleThreadData::ClearDepth(float value)
 	int height = depthstencil->Height();
 	float *data = depthstencil->DepthValues();
 
-	int skip = skipped_by_thread(0);
-	int count = count_for_thread(0, height);
-
-	data += skip * width;
-	for (int i = 0; i < count; i++)
+	int end = MIN(height, numa_end_y);
+	for (int y = skipped_by_thread(0); y < end; y = next_line_for_thread(y))
 	{
+		float *line = data + y * width;
 		for (int x = 0; x < width; x++)
-			data[x] = value;
-		data += num_cores * width;
+			line[x] = value;
 	}
 }
 
@@ -63,14 +60,10 @@ void PolyTriangleThreadData::ClearStencil(uint8_t value)
 	int height = depthstencil->Height();
 	uint8_t *data = depthstencil->StencilValues();
 
-	int skip = skipped_by_thread(0);
-	int count = count_for_thread(0, height);
-
-	data += skip * width;
-	for (int i = 0; i < count; i++)
+	int end = MIN(height, numa_end_y);
+	for (int y = skipped_by_thread(0); y < end; y = next_line_for_thread(y))
 	{
-		memset(data, value, width);
-		data += num_cores * width;
+		memset(data + y * width, value, width);
 	}
 }
 
@@ -620,6 +613,22 @@ void PolyTriangleThreadData::DrawShadedTriangle(const ShadedTriVertex *const* ve
 	}
 #endif
 
+	if (numclipvert < 3)
+		return;
+
+	// Skip the triangle setup if none of the covered lines belong to this thread
+	float miny = clippedvert[0].y;
+	float maxy = clippedvert[0].y;
+	for (int i = 1; i < numclipvert; i++)
+	{
+		miny = MIN(miny, clippedvert[i].y);
+		maxy = MAX(maxy, clippedvert[i].y);
+	}
+	int topY = MAX((int)(miny + 0.5f), clip.top);
+	int bottomY = MIN((int)(maxy + 0.5f), clip.bottom);
+	if (count_for_thread(topY, bottomY - topY) == 0)
+		return;
+
 	if (!topdown) ccw = !ccw;
 
 	TriDrawTriangleArgs args;
@@ -78,23 +78,48 @@ public:
 	int numa_start_y;
 	int numa_end_y;
 
+	// Line ownership must match DrawerThread, as the MemcpyCommand of the same frame may run while
+	// other threads are still drawing.
+	enum { band_shift = DrawerThread::band_shift };
+
 	bool line_skipped_by_thread(int line)
 	{
-		return line < numa_start_y || line >= numa_end_y || line % num_cores != core;
+		return line < numa_start_y || line >= numa_end_y || (line >> band_shift) % num_cores != core;
 	}
 
 	int skipped_by_thread(int first_line)
 	{
 		int clip_first_line = MAX(first_line, numa_start_y);
-		int core_skip = (num_cores - (clip_first_line - core) % num_cores) % num_cores;
-		return clip_first_line + core_skip - first_line;
+		int band = clip_first_line >> band_shift;
+		int band_skip = (num_cores - (band - core) % num_cores) % num_cores;
+		if (band_skip == 0)
+			return clip_first_line - first_line;
+		return ((band + band_skip) << band_shift) - first_line;
+	}
+
+	int next_line_for_thread(int line)
+	{
+		line++;
+		if ((line & ((1 << band_shift) - 1)) == 0)
+			line += (num_cores - 1) << band_shift;
+		return line;
 	}
 
 	int count_for_thread(int first_line, int count)
 	{
-		count = MIN(count, numa_end_y - first_line);
-		int c = (count - skipped_by_thread(first_line) + num_cores - 1) / num_cores;
-		return MAX(c, 0);
+		int start = MAX(first_line, numa_start_y);
+		int end = MIN(first_line + count, numa_end_y);
+		if (start >= end)
+			return 0;
+		return lines_before_for_thread(end) - lines_before_for_thread(start);
+	}
+
+	int lines_before_for_thread(int line)
+	{
+		int cycle = num_cores << band_shift;
+		int cycles = line / cycle;
+		int rest = line - cycles * cycle - (core << band_shift);
+		return (cycles << band_shift) + clamp(rest, 0, 1 << band_shift);
 	}
 
 	struct Scanline
@@ -26,6 +26,15 @@
 #include <immintrin.h>
 #endif
 
+#ifdef _DEBUG
+#include <memory>
+#include "c_dispatch.h"
+#include "printf.h"
+#include "v_text.h"
+#include "stats.h"
+#include "m_random.h"
+#endif
+
 static const int shiftTable[] = {
 	0, 0, 0, 0, // STYLEALPHA_Zero
 	0, 0, 0, 0, // STYLEALPHA_One
@@ -220,19 +229,25 @@ void BlendColorAdd_Src_InvSrc(int y, int x0, int x1, PolyTriangleThreadData* thr
 	int sseend = x0;
 
 #ifndef NO_SSE
-	int ssecount = ((x1 - x0) & ~1);
-	sseend = x0 + ssecount;
-	for (int x = x0; x < sseend; x += 2)
+	auto blend = [](__m128i src, __m128i dst)
 	{
-		__m128i dst = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)&line[x]), _mm_setzero_si128());
-		__m128i src = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)&fragcolor[x]), _mm_setzero_si128());
-
 		__m128i srcscale = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
 		srcscale = _mm_add_epi16(srcscale, _mm_srli_epi16(srcscale, 7));
 		__m128i dstscale = _mm_sub_epi16(_mm_set1_epi16(256), srcscale);
 
 		__m128i out = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(src, srcscale), _mm_mullo_epi16(dst, dstscale)), _mm_set1_epi16(127)), 8);
-		_mm_storel_epi64((__m128i*)&line[x], _mm_packus_epi16(out, out));
+		return out;
+	};
+
+	int ssecount = ((x1 - x0) & ~3);
+	sseend = x0 + ssecount;
+	for (int x = x0; x < sseend; x += 4)
+	{
+		__m128i dst = _mm_loadu_si128((__m128i*)&line[x]);
+		__m128i src = _mm_loadu_si128((__m128i*)&fragcolor[x]);
+		__m128i lo = blend(_mm_unpacklo_epi8(src, _mm_setzero_si128()), _mm_unpacklo_epi8(dst, _mm_setzero_si128()));
+		__m128i hi = blend(_mm_unpackhi_epi8(src, _mm_setzero_si128()), _mm_unpackhi_epi8(dst, _mm_setzero_si128()));
+		_mm_storeu_si128((__m128i*)&line[x], _mm_packus_epi16(lo, hi));
 	}
 #endif
 
@@ -262,19 +277,25 @@ void BlendColorAdd_SrcCol_InvSrcCol(int y, int x0, int x1, PolyTriangleThreadDat
 	int sseend = x0;
 
 #ifndef NO_SSE
-	int ssecount = ((x1 - x0) & ~1);
-	sseend = x0 + ssecount;
-	for (int x = x0; x < sseend; x += 2)
+	auto blend = [](__m128i src, __m128i dst)
 	{
-		__m128i dst = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*) & line[x]), _mm_setzero_si128());
-		__m128i src = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*) & fragcolor[x]), _mm_setzero_si128());
-
 		__m128i srcscale = src;
 		srcscale = _mm_add_epi16(srcscale, _mm_srli_epi16(srcscale, 7));
 		__m128i dstscale = _mm_sub_epi16(_mm_set1_epi16(256), srcscale);
 
 		__m128i out = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(src, srcscale), _mm_mullo_epi16(dst, dstscale)), _mm_set1_epi16(127)), 8);
-		_mm_storel_epi64((__m128i*) & line[x], _mm_packus_epi16(out, out));
+		return out;
+	};
+
+	int ssecount = ((x1 - x0) & ~3);
+	sseend = x0 + ssecount;
+	for (int x = x0; x < sseend; x += 4)
+	{
+		__m128i dst = _mm_loadu_si128((__m128i*)&line[x]);
+		__m128i src = _mm_loadu_si128((__m128i*)&fragcolor[x]);
+		__m128i lo = blend(_mm_unpacklo_epi8(src, _mm_setzero_si128()), _mm_unpacklo_epi8(dst, _mm_setzero_si128()));
+		__m128i hi = blend(_mm_unpackhi_epi8(src, _mm_setzero_si128()), _mm_unpackhi_epi8(dst, _mm_setzero_si128()));
+		_mm_storeu_si128((__m128i*)&line[x], _mm_packus_epi16(lo, hi));
 	}
 #endif
 
@@ -313,18 +334,24 @@ void BlendColorAdd_Src_One(int y, int x0, int x1, PolyTriangleThreadData* thread
 	int sseend = x0;
 
 #ifndef NO_SSE
-	int ssecount = ((x1 - x0) & ~1);
-	sseend = x0 + ssecount;
-	for (int x = x0; x < sseend; x += 2)
+	auto blend = [](__m128i src, __m128i dst)
 	{
-		__m128i dst = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*) & line[x]), _mm_setzero_si128());
-		__m128i src = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*) & fragcolor[x]), _mm_setzero_si128());
-
 		__m128i srcscale = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
 		srcscale = _mm_add_epi16(srcscale, _mm_srli_epi16(srcscale, 7));
 
 		__m128i out = _mm_add_epi16(_mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(src, srcscale), _mm_set1_epi16(127)), 8), dst);
-		_mm_storel_epi64((__m128i*) & line[x], _mm_packus_epi16(out, out));
+		return out;
+	};
+
+	int ssecount = ((x1 - x0) & ~3);
+	sseend = x0 + ssecount;
+	for (int x = x0; x < sseend; x += 4)
+	{
+		__m128i dst = _mm_loadu_si128((__m128i*)&line[x]);
+		__m128i src = _mm_loadu_si128((__m128i*)&fragcolor[x]);
+		__m128i lo = blend(_mm_unpacklo_epi8(src, _mm_setzero_si128()), _mm_unpacklo_epi8(dst, _mm_setzero_si128()));
+		__m128i hi = blend(_mm_unpackhi_epi8(src, _mm_setzero_si128()), _mm_unpackhi_epi8(dst, _mm_setzero_si128()));
+		_mm_storeu_si128((__m128i*)&line[x], _mm_packus_epi16(lo, hi));
 	}
 #endif
 
@@ -353,18 +380,24 @@ void BlendColorAdd_SrcCol_One(int y, int x0, int x1, PolyTriangleThreadData* thr
 	int sseend = x0;
 
 #ifndef NO_SSE
-	int ssecount = ((x1 - x0) & ~1);
-	sseend = x0 + ssecount;
-	for (int x = x0; x < sseend; x += 2)
+	auto blend = [](__m128i src, __m128i dst)
 	{
-		__m128i dst = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*) & line[x]), _mm_setzero_si128());
-		__m128i src = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*) & fragcolor[x]), _mm_setzero_si128());
-
 		__m128i srcscale = src;
 		srcscale = _mm_add_epi16(srcscale, _mm_srli_epi16(srcscale, 7));
 
 		__m128i out = _mm_add_epi16(_mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(src, srcscale), _mm_set1_epi16(127)), 8), dst);
-		_mm_storel_epi64((__m128i*) & line[x], _mm_packus_epi16(out, out));
+		return out;
+	};
+
+	int ssecount = ((x1 - x0) & ~3);
+	sseend = x0 + ssecount;
+	for (int x = x0; x < sseend; x += 4)
+	{
+		__m128i dst = _mm_loadu_si128((__m128i*)&line[x]);
+		__m128i src = _mm_loadu_si128((__m128i*)&fragcolor[x]);
+		__m128i lo = blend(_mm_unpacklo_epi8(src, _mm_setzero_si128()), _mm_unpacklo_epi8(dst, _mm_setzero_si128()));
+		__m128i hi = blend(_mm_unpackhi_epi8(src, _mm_setzero_si128()), _mm_unpackhi_epi8(dst, _mm_setzero_si128()));
+		_mm_storeu_si128((__m128i*)&line[x], _mm_packus_epi16(lo, hi));
 	}
 #endif
 
@@ -399,18 +432,24 @@ void BlendColorAdd_DstCol_Zero(int y, int x0, int x1, PolyTriangleThreadData* th
 	int sseend = x0;
 
 #ifndef NO_SSE
-	int ssecount = ((x1 - x0) & ~1);
-	sseend = x0 + ssecount;
-	for (int x = x0; x < sseend; x += 2)
+	auto blend = [](__m128i src, __m128i dst)
 	{
-		__m128i dst = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*) & line[x]), _mm_setzero_si128());
-		__m128i src = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*) & fragcolor[x]), _mm_setzero_si128());
-
 		__m128i srcscale = dst;
 		srcscale = _mm_add_epi16(srcscale, _mm_srli_epi16(srcscale, 7));
 
 		__m128i out = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(src, srcscale), _mm_set1_epi16(127)), 8);
-		_mm_storel_epi64((__m128i*) & line[x], _mm_packus_epi16(out, out));
+		return out;
+	};
+
+	int ssecount = ((x1 - x0) & ~3);
+	sseend = x0 + ssecount;
+	for (int x = x0; x < sseend; x += 4)
+	{
+		__m128i dst = _mm_loadu_si128((__m128i*)&line[x]);
+		__m128i src = _mm_loadu_si128((__m128i*)&fragcolor[x]);
+		__m128i lo = blend(_mm_unpacklo_epi8(src, _mm_setzero_si128()), _mm_unpacklo_epi8(dst, _mm_setzero_si128()));
+		__m128i hi = blend(_mm_unpackhi_epi8(src, _mm_setzero_si128()), _mm_unpackhi_epi8(dst, _mm_setzero_si128()));
+		_mm_storeu_si128((__m128i*)&line[x], _mm_packus_epi16(lo, hi));
 	}
 #endif
 
@@ -445,18 +484,24 @@ void BlendColorAdd_InvDstCol_Zero(int y, int x0, int x1, PolyTriangleThreadData*
 	int sseend = x0;
 
 #ifndef NO_SSE
-	int ssecount = ((x1 - x0) & ~1);
-	sseend = x0 + ssecount;
-	for (int x = x0; x < sseend; x += 2)
+	auto blend = [](__m128i src, __m128i dst)
 	{
-		__m128i dst = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*) & line[x]), _mm_setzero_si128());
-		__m128i src = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*) & fragcolor[x]), _mm_setzero_si128());
-
 		__m128i srcscale = _mm_sub_epi16(_mm_set1_epi16(255), dst);
 		srcscale = _mm_add_epi16(srcscale, _mm_srli_epi16(srcscale, 7));
 
 		__m128i out = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(src, srcscale), _mm_set1_epi16(127)), 8);
-		_mm_storel_epi64((__m128i*) & line[x], _mm_packus_epi16(out, out));
+		return out;
+	};
+
+	int ssecount = ((x1 - x0) & ~3);
+	sseend = x0 + ssecount;
+	for (int x = x0; x < sseend; x += 4)
+	{
+		__m128i dst = _mm_loadu_si128((__m128i*)&line[x]);
+		__m128i src = _mm_loadu_si128((__m128i*)&fragcolor[x]);
+		__m128i lo = blend(_mm_unpacklo_epi8(src, _mm_setzero_si128()), _mm_unpacklo_epi8(dst, _mm_setzero_si128()));
+		__m128i hi = blend(_mm_unpackhi_epi8(src, _mm_setzero_si128()), _mm_unpackhi_epi8(dst, _mm_setzero_si128()));
+		_mm_storeu_si128((__m128i*)&line[x], _mm_packus_epi16(lo, hi));
 	}
 #endif
 
@@ -491,18 +536,24 @@ void BlendColorRevSub_Src_One(int y, int x0, int x1, PolyTriangleThreadData* thr
 	int sseend = x0;
 
 #ifndef NO_SSE
-	int ssecount = ((x1 - x0) & ~1);
-	sseend = x0 + ssecount;
-	for (int x = x0; x < sseend; x += 2)
+	auto blend = [](__m128i src, __m128i dst)
 	{
-		__m128i dst = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*) & line[x]), _mm_setzero_si128());
-		__m128i src = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*) & fragcolor[x]), _mm_setzero_si128());
-
 		__m128i srcscale = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
 		srcscale = _mm_add_epi16(srcscale, _mm_srli_epi16(srcscale, 7));
 
 		__m128i out = _mm_sub_epi16(dst, _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(src, srcscale), _mm_set1_epi16(127)), 8));
-		_mm_storel_epi64((__m128i*) & line[x], _mm_packus_epi16(out, out));
+		return out;
+	};
+
+	int ssecount = ((x1 - x0) & ~3);
+	sseend = x0 + ssecount;
+	for (int x = x0; x < sseend; x += 4)
+	{
+		__m128i dst = _mm_loadu_si128((__m128i*)&line[x]);
+		__m128i src = _mm_loadu_si128((__m128i*)&fragcolor[x]);
+		__m128i lo = blend(_mm_unpacklo_epi8(src, _mm_setzero_si128()), _mm_unpacklo_epi8(dst, _mm_setzero_si128()));
+		__m128i hi = blend(_mm_unpackhi_epi8(src, _mm_setzero_si128()), _mm_unpackhi_epi8(dst, _mm_setzero_si128()));
+		_mm_storeu_si128((__m128i*)&line[x], _mm_packus_epi16(lo, hi));
 	}
 #endif
 
@@ -617,3 +668,88 @@ void SelectWriteColorFunc(PolyTriangleThreadData* thread)
 		}
 	}
 }
+
+#ifdef _DEBUG
+//==========================================================================
+//
+// bench_polyblend [repeats]
+//
+// Runs each blend span with an SSE2 loop on random colors, once over the
+// whole span and once pixel by pixel. Single pixels never reach the SSE2
+// loops, so this checks them against the scalar code.
+//
+//==========================================================================
+
+CCMD(bench_polyblend)
+{
+	int const repeats = argv.argc() > 1 ? MAX(1, (int)strtol(argv[1], nullptr, 10)) : 1000;
+
+	static const struct
+	{
+		const char* name;
+		void (*func)(int y, int x0, int x1, PolyTriangleThreadData* thread);
+	} spans[] =
+	{
+		{ "Opaque", BlendColorOpaque },
+		{ "Add_Src_InvSrc", BlendColorAdd_Src_InvSrc },
+		{ "Add_SrcCol_InvSrcCol", BlendColorAdd_SrcCol_InvSrcCol },
+		{ "Add_Src_One", BlendColorAdd_Src_One },
+		{ "Add_SrcCol_One", BlendColorAdd_SrcCol_One },
+		{ "Add_DstCol_Zero", BlendColorAdd_DstCol_Zero },
+		{ "Add_InvDstCol_Zero", BlendColorAdd_InvDstCol_Zero },
+		{ "RevSub_Src_One", BlendColorRevSub_Src_One },
+	};
+
+	auto thread = std::make_unique<PolyTriangleThreadData>(0, 1, 0, 1, 0, 1);
+	TArray<uint32_t> dest(MAXWIDTH, true), original(MAXWIDTH, true), expected(MAXWIDTH, true);
+	thread->dest = (uint8_t*)dest.Data();
+	thread->dest_pitch = MAXWIDTH;
+	thread->dest_width = MAXWIDTH;
+	thread->dest_height = 1;
+	thread->dest_bgra = true;
+
+	FRandom rng;
+	uint32_t* fragcolor = thread->scanline.FragColor;
+	Printf("bench_polyblend: %d spans\n", repeats);
+
+	for (auto& span : spans)
+	{
+		int mismatches = 0;
+		cycle_t scalartime, ssetime;
+		scalartime.Reset();
+		ssetime.Reset();
+
+		for (int r = 0; r < repeats; r++)
+		{
+			int x0 = rng(MAXWIDTH / 2);
+			int x1 = x0 + 1 + rng(MAXWIDTH / 2);
+			for (int x = x0; x < x1; x++)
+			{
+				fragcolor[x] = rng.GenRand32();
+				original[x] = rng.GenRand32();
+			}
+			size_t bytes = (x1 - x0) * sizeof(uint32_t);
+
+			memcpy(&dest[x0], &original[x0], bytes);
+			scalartime.Clock();
+			for (int x = x0; x < x1; x++)
+				span.func(0, x, x + 1, thread.get());
+			scalartime.Unclock();
+			memcpy(&expected[x0], &dest[x0], bytes);
+
+			memcpy(&dest[x0], &original[x0], bytes);
+			ssetime.Clock();
+			span.func(0, x0, x1, thread.get());
+			ssetime.Unclock();
+
+			for (int x = x0; x < x1; x++)
+				if (dest[x] != expected[x])
+					mismatches++;
+		}
+
+		Printf("  %s: per pixel %.3f ms, whole span %.3f ms\n", span.name, scalartime.TimeMS(), ssetime.TimeMS());
+		if (mismatches)
+			Printf(TEXTCOLOR_RED "  %s: %d mismatches!\n", span.name, mismatches);
+	}
+}
+#endif
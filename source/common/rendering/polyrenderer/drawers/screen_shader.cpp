@@ -27,6 +27,41 @@
 #include "x86.h"
 #include <cmath>
 
+#ifdef _DEBUG
+#include <memory>
+#include "c_dispatch.h"
+#include "printf.h"
+#include "v_text.h"
+#include "stats.h"
+#include "m_random.h"
+#endif
+
+#ifndef NO_SSE
+#include <immintrin.h>
+
+// Multiplies the channels of four ARGB colors by 0-255 factors, rescaled to 0-256, and rounds the result
+static __m128i MultiplyColors(__m128i color, __m128i factor)
+{
+	__m128i colorlo = _mm_unpacklo_epi8(color, _mm_setzero_si128());
+	__m128i colorhi = _mm_unpackhi_epi8(color, _mm_setzero_si128());
+	__m128i factorlo = _mm_unpacklo_epi8(factor, _mm_setzero_si128());
+	__m128i factorhi = _mm_unpackhi_epi8(factor, _mm_setzero_si128());
+	factorlo = _mm_add_epi16(factorlo, _mm_srli_epi16(factorlo, 7));
+	factorhi = _mm_add_epi16(factorhi, _mm_srli_epi16(factorhi, 7));
+	__m128i lo = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(colorlo, factorlo), _mm_set1_epi16(127)), 8);
+	__m128i hi = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(colorhi, factorhi), _mm_set1_epi16(127)), 8);
+	return _mm_packus_epi16(lo, hi);
+}
+
+// Loads four consecutive 8 bit values into the low lane, without the aliasing and alignment problems of an int cast.
+static __m128i LoadBytes4(const uint8_t* ptr)
+{
+	int value;
+	memcpy(&value, ptr, sizeof(value));
+	return _mm_cvtsi32_si128(value);
+}
+#endif
+
 static uint32_t SampleTexture(uint32_t u, uint32_t v, const void* texPixels, int texWidth, int texHeight, bool texBgra)
 {
 	int texelX = (u * texWidth) >> 16;
@@ -287,7 +322,24 @@ static void FuncNormal_AddColor(int x0, int x1, PolyTriangleThreadData* thread)
 	uint32_t g = (int)(streamdata.uAddColor.g * 255.0f);
 	uint32_t b = (int)(streamdata.uAddColor.b * 255.0f);
 	uint32_t* fragcolor = thread->scanline.FragColor;
-	for (int x = x0; x < x1; x++)
+
+	int sseend = x0;
+
+#ifndef NO_SSE
+	if (r <= 255 && g <= 255 && b <= 255)
+	{
+		__m128i addcolor = _mm_set1_epi32(MAKEARGB(0, r, g, b));
+		int ssecount = ((x1 - x0) & ~3);
+		sseend = x0 + ssecount;
+		for (int x = x0; x < sseend; x += 4)
+		{
+			__m128i texel = _mm_loadu_si128((__m128i*)&fragcolor[x]);
+			_mm_storeu_si128((__m128i*)&fragcolor[x], _mm_adds_epu8(texel, addcolor));
+		}
+	}
+#endif
+
+	for (int x = sseend; x < x1; x++)
 	{
 		uint32_t texel = fragcolor[x];
 		fragcolor[x] = MAKEARGB(
@@ -305,7 +357,27 @@ static void FuncNormal_AddObjectColor(int x0, int x1, PolyTriangleThreadData* th
 	uint32_t g = (int)(streamdata.uObjectColor.g * 256.0f);
 	uint32_t b = (int)(streamdata.uObjectColor.b * 256.0f);
 	uint32_t* fragcolor = thread->scanline.FragColor;
-	for (int x = x0; x < x1; x++)
+
+	int sseend = x0;
+
+#ifndef NO_SSE
+	if (r <= 256 && g <= 256 && b <= 256)
+	{
+		// Alpha is multiplied by 256 to keep it unchanged
+		__m128i objectcolor = _mm_set_epi16(256, r, g, b, 256, r, g, b);
+		int ssecount = ((x1 - x0) & ~3);
+		sseend = x0 + ssecount;
+		for (int x = x0; x < sseend; x += 4)
+		{
+			__m128i texel = _mm_loadu_si128((__m128i*)&fragcolor[x]);
+			__m128i lo = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(texel, _mm_setzero_si128()), objectcolor), 8);
+			__m128i hi = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(texel, _mm_setzero_si128()), objectcolor), 8);
+			_mm_storeu_si128((__m128i*)&fragcolor[x], _mm_packus_epi16(lo, hi));
+		}
+	}
+#endif
+
+	for (int x = sseend; x < x1; x++)
 	{
 		uint32_t texel = fragcolor[x];
 		fragcolor[x] = MAKEARGB(
@@ -430,7 +502,20 @@ static void GetLightColor(int x0, int x1, PolyTriangleThreadData* thread)
 
 	if (thread->PushConstants->uFogEnabled >= 0)
 	{
-		for (int x = x0; x < x1; x++)
+		int sseend = x0;
+
+#ifndef NO_SSE
+		int ssecount = ((x1 - x0) & ~3);
+		sseend = x0 + ssecount;
+		for (int x = x0; x < sseend; x += 4)
+		{
+			__m128i fg = _mm_loadu_si128((__m128i*)&fragcolor[x]);
+			__m128i lightshade = _mm_loadu_si128((__m128i*)&lightarray[x]);
+			_mm_storeu_si128((__m128i*)&fragcolor[x], MultiplyColors(fg, lightshade));
+		}
+#endif
+
+		for (int x = sseend; x < x1; x++)
 		{
 			uint32_t fg = fragcolor[x];
 			uint32_t lightshade = lightarray[x];
@@ -569,7 +654,28 @@ static void MainFP(int x0, int x1, PolyTriangleThreadData* thread)
 		}
 		else
 		{
-			for (int x = x0; x < x1; x++)
+			int sseend = x0;
+
+#ifndef NO_SSE
+			if (fogR <= 255 && fogG <= 255 && fogB <= 255)
+			{
+				__m128i fogcolor = _mm_set1_epi32(MAKEARGB(0, fogR, fogG, fogB));
+				int ssecount = ((x1 - x0) & ~3);
+				sseend = x0 + ssecount;
+				for (int x = x0; x < sseend; x += 4)
+				{
+					// Interleave the vColor channels to ARGB
+					__m128i bg = _mm_unpacklo_epi8(LoadBytes4(&vColorB[x]), LoadBytes4(&vColorG[x]));
+					__m128i ra = _mm_unpacklo_epi8(LoadBytes4(&vColorR[x]), LoadBytes4(&vColorA[x]));
+					__m128i vcolor = _mm_unpacklo_epi16(bg, ra);
+
+					__m128i frag = MultiplyColors(_mm_loadu_si128((__m128i*)&fragcolor[x]), vcolor);
+					_mm_storeu_si128((__m128i*)&fragcolor[x], _mm_adds_epu8(frag, fogcolor));
+				}
+			}
+#endif
+
+			for (int x = sseend; x < x1; x++)
 			{
 				uint32_t a = vColorA[x];
 				uint32_t r = vColorR[x];
@@ -629,3 +735,90 @@ void SelectFragmentShader(PolyTriangleThreadData* thread)
 
 	thread->FragmentShader = fragshader;
 }
+
+#ifdef _DEBUG
+//==========================================================================
+//
+// bench_polyshader [repeats]
+//
+// Runs the main fragment shader on random spans, textures and uniforms,
+// once over the whole span and once pixel by pixel. Single pixels never
+// reach the SSE2 loops, so this checks them against the scalar code.
+// Even repeats go through the 3D lighting path, odd ones through the 2D
+// color overlay.
+//
+//==========================================================================
+
+CCMD(bench_polyshader)
+{
+	int const repeats = argv.argc() > 1 ? MAX(1, (int)strtol(argv[1], nullptr, 10)) : 1000;
+	enum { texsize = 64 };
+
+	auto thread = std::make_unique<PolyTriangleThreadData>(0, 1, 0, 1, 0, 1);
+	PolyPushConstants constants = {};
+	constants.uTextureMode = TM_NORMAL;
+	thread->PushConstants = &constants;
+	thread->EffectState = SHADER_Default;
+
+	FRandom rng;
+	TArray<uint32_t> texture(texsize * texsize, true);
+	for (auto& texel : texture)
+		texel = rng.GenRand32();
+	thread->textures[0].pixels = texture.Data();
+	thread->textures[0].width = texsize;
+	thread->textures[0].height = texsize;
+	thread->textures[0].bgra = true;
+
+	auto& scanline = thread->scanline;
+	auto& streamdata = thread->mainVertexShader.Data;
+	TArray<uint32_t> expected(MAXWIDTH, true);
+	int mismatches = 0;
+
+	cycle_t scalartime, ssetime;
+	scalartime.Reset();
+	ssetime.Reset();
+
+	for (int r = 0; r < repeats; r++)
+	{
+		constants.uFogEnabled = (r & 1) ? -3 : 0;
+		streamdata.uAddColor = PalEntry(rng.GenRand32());
+		streamdata.uObjectColor = PalEntry(rng.GenRand32());
+		streamdata.uObjectColor2.a = 0.0f;
+		streamdata.uFogColor = PalEntry(rng.GenRand32());
+		streamdata.uDesaturationFactor = 0.0f;
+
+		int x0 = rng(MAXWIDTH / 2);
+		int x1 = x0 + 1 + rng(MAXWIDTH / 2);
+		for (int x = x0; x < x1; x++)
+		{
+			scanline.U[x] = rng.GenRand32();
+			scanline.V[x] = rng.GenRand32();
+			scanline.lightarray[x] = rng.GenRand32();
+			scanline.vColorA[x] = rng();
+			scanline.vColorR[x] = rng();
+			scanline.vColorG[x] = rng();
+			scanline.vColorB[x] = rng();
+		}
+
+		// The shader starts by sampling the texture, so both runs get the same input.
+		scalartime.Clock();
+		for (int x = x0; x < x1; x++)
+			MainFP(x, x + 1, thread.get());
+		scalartime.Unclock();
+		memcpy(&expected[x0], &scanline.FragColor[x0], (x1 - x0) * sizeof(uint32_t));
+
+		ssetime.Clock();
+		MainFP(x0, x1, thread.get());
+		ssetime.Unclock();
+
+		for (int x = x0; x < x1; x++)
+			if (scanline.FragColor[x] != expected[x])
+				mismatches++;
+	}
+
+	Printf("bench_polyshader: %d spans\n", repeats);
+	Printf("  per pixel: %.3f ms, whole span: %.3f ms\n", scalartime.TimeMS(), ssetime.TimeMS());
+	if (mismatches)
+		Printf(TEXTCOLOR_RED "  %d mismatches!\n", mismatches);
+}
+#endif
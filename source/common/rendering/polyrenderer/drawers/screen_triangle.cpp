@@ -211,6 +211,11 @@ void ScreenTriangle::Draw(const TriDrawTriangleArgs* args, PolyTriangleThreadDat
 	midY = MIN(midY, clipbottom);
 	bottomY = MIN(bottomY, clipbottom);
 
+	if (topY >= bottomY)
+		return;
+
+	// Skip the setup if none of the lines belong to this thread
+	topY += thread->skipped_by_thread(topY);
 	if (topY >= bottomY)
 		return;
 
@@ -224,9 +229,6 @@ void ScreenTriangle::Draw(const TriDrawTriangleArgs* args, PolyTriangleThreadDat
 	if (thread->StencilTest) opt |= SWTRI_StencilTest;
 	testfunc = ScreenTriangle::TestSpanOpts[opt];
 
-	topY += thread->skipped_by_thread(topY);
-	int num_cores = thread->num_cores;
-
 	// Find start/end X positions for each line covered by the triangle:
 
 	int y = topY;
@@ -235,7 +237,6 @@ void ScreenTriangle::Draw(const TriDrawTriangleArgs* args, PolyTriangleThreadDat
 	float longDY = sortedVertices[2]->y - sortedVertices[0]->y;
 	float longStep = longDX / longDY;
 	float longPos = sortedVertices[0]->x + longStep * (y + 0.5f - sortedVertices[0]->y) + 0.5f;
-	longStep *= num_cores;
 
 	if (y < midY)
 	{
@@ -243,7 +244,6 @@ void ScreenTriangle::Draw(const TriDrawTriangleArgs* args, PolyTriangleThreadDat
 		float shortDY = sortedVertices[1]->y - sortedVertices[0]->y;
 		float shortStep = shortDX / shortDY;
 		float shortPos = sortedVertices[0]->x + shortStep * (y + 0.5f - sortedVertices[0]->y) + 0.5f;
-		shortStep *= num_cores;
 
 		while (y < midY)
 		{
@@ -255,9 +255,10 @@ void ScreenTriangle::Draw(const TriDrawTriangleArgs* args, PolyTriangleThreadDat
 
 			testfunc(y, x0, x1, args, thread);
 
-			shortPos += shortStep;
-			longPos += longStep;
-			y += num_cores;
+			int next = thread->next_line_for_thread(y);
+			shortPos += shortStep * (next - y);
+			longPos += longStep * (next - y);
+			y = next;
 		}
 	}
 
@@ -267,7 +268,6 @@ void ScreenTriangle::Draw(const TriDrawTriangleArgs* args, PolyTriangleThreadDat
 		float shortDY = sortedVertices[2]->y - sortedVertices[1]->y;
 		float shortStep = shortDX / shortDY;
 		float shortPos = sortedVertices[1]->x + shortStep * (y + 0.5f - sortedVertices[1]->y) + 0.5f;
-		shortStep *= num_cores;
 
 		while (y < bottomY)
 		{
@@ -279,9 +279,10 @@ void ScreenTriangle::Draw(const TriDrawTriangleArgs* args, PolyTriangleThreadDat
 
 			testfunc(y, x0, x1, args, thread);
 
-			shortPos += shortStep;
-			longPos += longStep;
-			y += num_cores;
+			int next = thread->next_line_for_thread(y);
+			shortPos += shortStep * (next - y);
+			longPos += longStep * (next - y);
+			y = next;
 		}
 	}
 }
@@ -285,17 +285,12 @@ MemcpyCommand::MemcpyCommand(void *dest, int destpitch, const void *src, int wid
 
 void MemcpyCommand::Execute(DrawerThread *thread)
 {
-	int start = thread->skipped_by_thread(0);
-	int count = thread->count_for_thread(0, height);
-	int sstep = thread->num_cores * srcpitch * pixelsize;
-	int dstep = thread->num_cores * destpitch * pixelsize;
+	int end = MIN(height, thread->numa_end_y);
 	int size = width * pixelsize;
-	uint8_t *d = (uint8_t*)dest + start * destpitch * pixelsize;
-	const uint8_t *s = (const uint8_t*)src + start * srcpitch * pixelsize;
-	for (int i = 0; i < count; i++)
+	for (int y = thread->skipped_by_thread(0); y < end; y = thread->next_line_for_thread(y))
 	{
+		uint8_t *d = (uint8_t*)dest + y * destpitch * pixelsize;
+		const uint8_t *s = (const uint8_t*)src + y * srcpitch * pixelsize;
 		memcpy(d, s, size);
-		d += dstep;
-		s += sstep;
 	}
 }
@@ -69,26 +69,54 @@ public:
 
 	size_t debug_draw_pos = 0;
 
+	// The screen is split into bands of (1 << band_shift) lines, handed out to the threads in turn.
+	// This keeps each thread on consecutive rows of the destination and depth/stencil buffers and
+	// lets small primitives be skipped entirely by the threads that don't own any of their lines.
+	enum { band_shift = 3 };
+
 	// Checks if a line is rendered by this thread
 	bool line_skipped_by_thread(int line)
 	{
-		return line < numa_start_y || line >= numa_end_y || line % num_cores != core;
+		return line < numa_start_y || line >= numa_end_y || (line >> band_shift) % num_cores != core;
 	}
 
 	// The number of lines to skip to reach the first line to be rendered by this thread
 	int skipped_by_thread(int first_line)
 	{
 		int clip_first_line = MAX(first_line, numa_start_y);
-		int core_skip = (num_cores - (clip_first_line - core) % num_cores) % num_cores;
-		return clip_first_line + core_skip - first_line;
+		int band = clip_first_line >> band_shift;
+		int band_skip = (num_cores - (band - core) % num_cores) % num_cores;
+		if (band_skip == 0)
+			return clip_first_line - first_line;
+		return ((band + band_skip) << band_shift) - first_line;
+	}
+
+	// The next line rendered by this thread after a line rendered by this thread
+	int next_line_for_thread(int line)
+	{
+		line++;
+		if ((line & ((1 << band_shift) - 1)) == 0)
+			line += (num_cores - 1) << band_shift;
+		return line;
 	}
 
 	// The number of lines to be rendered by this thread
 	int count_for_thread(int first_line, int count)
 	{
-		count = MIN(count, numa_end_y - first_line);
-		int c = (count - skipped_by_thread(first_line) + num_cores - 1) / num_cores;
-		return MAX(c, 0);
+		int start = MAX(first_line, numa_start_y);
+		int end = MIN(first_line + count, numa_end_y);
+		if (start >= end)
+			return 0;
+		return lines_before_for_thread(end) - lines_before_for_thread(start);
+	}
+
+	// The number of lines before 'line' that belong to this thread, ignoring the NUMA block
+	int lines_before_for_thread(int line)
+	{
+		int cycle = num_cores << band_shift;
+		int cycles = line / cycle;
+		int rest = line - cycles * cycle - (core << band_shift);
+		return (cycles << band_shift) + clamp(rest, 0, 1 << band_shift);
 	}
 
 	// Calculate the dest address for the first line to be rendered by this thread
@@ -101,7 +129,7 @@ public:
 	// The first line in the dc_temp buffer used this thread
 	int temp_line_for_thread(int first_line)
 	{
-		return (first_line + skipped_by_thread(first_line)) / num_cores;
+		return lines_before_for_thread(first_line + skipped_by_thread(first_line));
 	}
 };
 
@@ -48,11 +48,22 @@ void AnimTexture::SetFrameSize(int width, int height)
 
 void AnimTexture::SetFrame(const uint8_t* palette, const void* data_)
 {
+    Bgra = false;
+    Image.Resize(Width * Height);
     memcpy(Palette, palette, 768);
     memcpy(Image.Data(), data_, Width * Height);
     CleanHardwareTextures();
 }
 
+// for frames that already were converted elsewhere, e.g. on a movie player's decoding thread.
+void AnimTexture::SetFrameBgra(const uint8_t* data_)
+{
+    Bgra = true;
+    Image.Resize(Width * Height * 4);
+    memcpy(Image.Data(), data_, Width * Height * 4);
+    CleanHardwareTextures();
+}
+
 //===========================================================================
 //
 // FPNGTexture::CopyPixels
@@ -65,6 +76,12 @@ FBitmap AnimTexture::GetBgraBitmap(const PalEntry* remap, int* trans)
 
     bmp.Create(Width, Height);
 
+    if (Bgra)
+    {
+        memcpy(bmp.GetPixels(), Image.Data(), Width * Height * 4);
+        return bmp;
+    }
+
     auto spix = Image.Data();
     auto dpix = bmp.GetPixels();
     for (int i = 0; i < Width * Height; i++)
@@ -112,6 +129,12 @@ void AnimTextures::SetFrame(const uint8_t* palette, const void* data)
     static_cast<AnimTexture*>(tex[active]->GetTexture())->SetFrame(palette, data);
 }
 
+void AnimTextures::SetFrameBgra(const uint8_t* data)
+{
+    active ^= 1;
+    static_cast<AnimTexture*>(tex[active]->GetTexture())->SetFrameBgra(data);
+}
+
 FGameTexture* AnimTextures::GetFrame()
 {
     return tex[active];
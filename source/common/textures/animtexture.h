@@ -7,10 +7,12 @@ class AnimTexture : public FTexture
 {
 	uint8_t Palette[768];
 	TArray<uint8_t> Image;
+	bool Bgra = false;
 public:
 	AnimTexture() = default;
 	void SetFrameSize(int width, int height);
 	void SetFrame(const uint8_t* palette, const void* data);
+	void SetFrameBgra(const uint8_t* data);
 	virtual FBitmap GetBgraBitmap(const PalEntry* remap, int* trans) override;
 };
 
@@ -24,5 +26,6 @@ public:
 	~AnimTextures();
 	void SetSize(int width, int height);
 	void SetFrame(const uint8_t* palette, const void* data);
+	void SetFrameBgra(const uint8_t* data);
 	FGameTexture* GetFrame();
 };
@@ -371,6 +371,7 @@ enum EUpscaleFlags
 
 extern int upscalemask;
 void UpdateUpscaleMask();
+void TrimUpscaleCache();
 
 int calcShouldUpscale(FGameTexture* tex);
 inline int shouldUpscale(FGameTexture* tex, EUpscaleFlags UseType)
@@ -45,6 +45,15 @@
 #include "textures.h"
 #include "texturemanager.h"
 #include "printf.h"
+#include "md5.h"
+#include "files.h"
+#include "cmdlib.h"
+#include "i_specialpaths.h"
+#include "findfile.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 int upscalemask;
 
@@ -100,6 +109,11 @@ CUSTOM_CVAR(Int, gl_texture_hqresize_mt_height, 4, CVAR_ARCHIVE | CVAR_GLOBALCON
 }
 
 CVAR(Int, xbrz_colorformat, 0, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+CVAR(Bool, gl_texture_hqresize_cache, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+CUSTOM_CVAR(Int, gl_texture_hqresize_cachesize, 1024, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)	// in MB
+{
+	if (self < 16) self = 16;
+}
 
 void UpdateUpscaleMask()
 {
@@ -295,13 +309,9 @@ static unsigned char *hqNxAsmHelper( void (*hqNxFunction) ( int*, unsigned char*
 	outWidth = N * inWidth;
 	outHeight = N *inHeight;
 
-	static int initdone = false;
-
-	if (!initdone)
-	{
-		HQnX_asm::InitLUTs();
-		initdone = true;
-	}
+	// This may get called from the texture preparation threads.
+	static std::once_flag initdone;
+	std::call_once(initdone, HQnX_asm::InitLUTs);
 
 	HQnX_asm::CImage cImageIn;
 	cImageIn.SetImage(inputBuffer, inWidth, inHeight, 32);
@@ -322,13 +332,9 @@ static unsigned char *hqNxHelper( void (HQX_CALLCONV *hqNxFunction) ( unsigned*,
 							  int &outWidth,
 							  int &outHeight )
 {
-	static int initdone = false;
+	static std::once_flag initdone;
+	std::call_once(initdone, hqxInit);
 
-	if (!initdone)
-	{
-		hqxInit();
-		initdone = true;
-	}
 	outWidth = N * inWidth;
 	outHeight = N *inHeight;
 
@@ -339,26 +345,50 @@ static unsigned char *hqNxHelper( void (HQX_CALLCONV *hqNxFunction) ( unsigned*,
 }
 
 
+//===========================================================================
+// 
+// Copies the CVARs the upscaler needs. This must be called on the game thread.
+//
+//===========================================================================
+
+FUpscaleSettings FUpscaleSettings::Current()
+{
+	FUpscaleSettings settings;
+	settings.type = gl_texture_hqresizemode;
+	settings.mult = gl_texture_hqresizemult;
+	settings.useCache = gl_texture_hqresize_cache;
+	settings.multithread = gl_texture_hqresize_multithread;
+	settings.mtWidth = gl_texture_hqresize_mt_width;
+	settings.mtHeight = gl_texture_hqresize_mt_height;
+	settings.xbrzColorFormat = xbrz_colorformat;
+	settings.xbrz[0] = xbrz_luminanceweight;
+	settings.xbrz[1] = xbrz_equalcolortolerance;
+	settings.xbrz[2] = xbrz_centerdirectionbias;
+	settings.xbrz[3] = xbrz_dominantdirectionthreshold;
+	settings.xbrz[4] = xbrz_steepdirectionthreshold;
+	return settings;
+}
+
 template <typename ConfigType>
-void xbrzSetupConfig(ConfigType& cfg);
+void xbrzSetupConfig(ConfigType& cfg, const FUpscaleSettings &settings);
 
 template <>
-void xbrzSetupConfig(xbrz::ScalerCfg& cfg)
+void xbrzSetupConfig(xbrz::ScalerCfg& cfg, const FUpscaleSettings &settings)
 {
-	cfg.luminanceWeight = xbrz_luminanceweight;
-	cfg.equalColorTolerance = xbrz_equalcolortolerance;
-	cfg.centerDirectionBias = xbrz_centerdirectionbias;
-	cfg.dominantDirectionThreshold = xbrz_dominantdirectionthreshold;
-	cfg.steepDirectionThreshold = xbrz_steepdirectionthreshold;
+	cfg.luminanceWeight = settings.xbrz[0];
+	cfg.equalColorTolerance = settings.xbrz[1];
+	cfg.centerDirectionBias = settings.xbrz[2];
+	cfg.dominantDirectionThreshold = settings.xbrz[3];
+	cfg.steepDirectionThreshold = settings.xbrz[4];
 }
 
 template <>
-void xbrzSetupConfig(xbrz_old::ScalerCfg& cfg)
+void xbrzSetupConfig(xbrz_old::ScalerCfg& cfg, const FUpscaleSettings &settings)
 {
-	cfg.luminanceWeight_ = xbrz_luminanceweight;
-	cfg.equalColorTolerance_ = xbrz_equalcolortolerance;
-	cfg.dominantDirectionThreshold = xbrz_dominantdirectionthreshold;
-	cfg.steepDirectionThreshold = xbrz_steepdirectionthreshold;
+	cfg.luminanceWeight_ = settings.xbrz[0];
+	cfg.equalColorTolerance_ = settings.xbrz[1];
+	cfg.dominantDirectionThreshold = settings.xbrz[3];
+	cfg.steepDirectionThreshold = settings.xbrz[4];
 }
 
 template <typename ConfigType>
@@ -368,24 +398,25 @@ static unsigned char *xbrzHelper( void (*xbrzFunction) ( size_t, const uint32_t*
 							  const int inWidth,
 							  const int inHeight,
 							  int &outWidth,
-							  int &outHeight )
+							  int &outHeight,
+							  const FUpscaleSettings &settings )
 {
 	outWidth = N * inWidth;
 	outHeight = N *inHeight;
 
 	unsigned char * newBuffer = new unsigned char[outWidth*outHeight*4];
 	
-	const int thresholdWidth  = gl_texture_hqresize_mt_width;
-	const int thresholdHeight = gl_texture_hqresize_mt_height;
+	const int thresholdWidth  = settings.mtWidth;
+	const int thresholdHeight = settings.mtHeight;
 
 	ConfigType cfg;
-	xbrzSetupConfig(cfg);
+	xbrzSetupConfig(cfg, settings);
 
-	const xbrz::ColorFormat colorFormat = xbrz_colorformat == 0
+	const xbrz::ColorFormat colorFormat = settings.xbrzColorFormat == 0
 		? xbrz::ColorFormat::ARGB
 		: xbrz::ColorFormat::ARGB_UNBUFFERED;
 
-	if (gl_texture_hqresize_multithread
+	if (settings.multithread
 		&& inWidth  > thresholdWidth
 		&& inHeight > thresholdHeight)
 	{
@@ -411,6 +442,231 @@ static void xbrzOldScale(size_t factor, const uint32_t* src, uint32_t* trg, int
 }
 
 
+//===========================================================================
+// 
+// Runs the selected scaler on texbuffer.mBuffer.
+// Returns false if the combination of type and factor is not supported.
+//
+//===========================================================================
+
+static bool UpscaleBuffer(FTextureBuffer &texbuffer, int type, int mult, const FUpscaleSettings &settings)
+{
+	int inWidth = texbuffer.mWidth;
+	int inHeight = texbuffer.mHeight;
+
+	if (type == 1)
+	{
+		if (mult == 2)
+			texbuffer.mBuffer = scaleNxHelper(&scale2x, 2, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
+		else if (mult == 3)
+			texbuffer.mBuffer = scaleNxHelper(&scale3x, 3, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
+		else if (mult == 4)
+			texbuffer.mBuffer = scaleNxHelper(&scale4x, 4, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
+		else return false;
+	}
+	else if (type == 2)
+	{
+		if (mult == 2)
+			texbuffer.mBuffer = hqNxHelper(&hq2x_32, 2, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
+		else if (mult == 3)
+			texbuffer.mBuffer = hqNxHelper(&hq3x_32, 3, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
+		else if (mult == 4)
+			texbuffer.mBuffer = hqNxHelper(&hq4x_32, 4, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
+		else return false;
+	}
+#ifdef HAVE_MMX
+	else if (type == 3)
+	{
+		if (mult == 2)
+			texbuffer.mBuffer = hqNxAsmHelper(&HQnX_asm::hq2x_32, 2, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
+		else if (mult == 3)
+			texbuffer.mBuffer = hqNxAsmHelper(&HQnX_asm::hq3x_32, 3, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
+		else if (mult == 4)
+			texbuffer.mBuffer = hqNxAsmHelper(&HQnX_asm::hq4x_32, 4, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
+		else return false;
+	}
+#endif
+	else if (type == 4)
+		texbuffer.mBuffer = xbrzHelper(xbrz::scale, mult, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight, settings);
+	else if (type == 5)
+		texbuffer.mBuffer = xbrzHelper(xbrzOldScale, mult, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight, settings);
+	else if (type == 6)
+		texbuffer.mBuffer = normalNx(mult, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
+	else
+		return false;
+	return true;
+}
+
+//===========================================================================
+// 
+// Disk cache for upscaled images
+//
+// The key is a hash of the source pixels and everything that affects the
+// scaler's output, so that it stays valid across sessions and does not
+// depend on the texture's content ID, which is assigned at run time.
+// This may be called from the texture preparation threads, so nothing in
+// here may print or go through the game's file system.
+//
+//===========================================================================
+
+static const char UpscaleCacheMagic[4] = { 'Z', 'U', 'P', 'C' };
+static const uint32_t UpscaleCacheVersion = 1;
+
+struct UpscaleCacheHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t width, height;
+};
+
+static const FString &UpscaleCachePath()
+{
+	static const FString path = []()
+	{
+		FString p = M_GetCachePath(true);
+		p << "/hqresize/";
+		CreatePath(p);
+		return p;
+	}();
+	return path;
+}
+
+static FString UpscaleCacheName(const FTextureBuffer &texbuffer, int type, int mult, const FUpscaleSettings &settings)
+{
+	int32_t params[5] = { texbuffer.mWidth, texbuffer.mHeight, type, mult, UpscaleCacheVersion };
+
+	MD5Context md5;
+	md5.Update((const uint8_t *)params, sizeof(params));
+	if (type == 4 || type == 5)
+	{
+		md5.Update((const uint8_t *)settings.xbrz, sizeof(settings.xbrz));
+	}
+	md5.Update(texbuffer.mBuffer, texbuffer.mWidth * texbuffer.mHeight * 4);
+
+	uint8_t digest[16];
+	md5.Final(digest);
+
+	FString name = UpscaleCachePath();
+	for (int i = 0; i < 16; i++)
+	{
+		name.AppendFormat("%02x", digest[i]);
+	}
+	return name;
+}
+
+static bool ReadUpscaleCache(const FString &name, FTextureBuffer &texbuffer, int mult)
+{
+	FileReader fr;
+	if (!fr.OpenFile(name)) return false;
+
+	UpscaleCacheHeader header;
+	uint32_t width = texbuffer.mWidth * mult, height = texbuffer.mHeight * mult;
+	long size = width * height * 4;
+
+	if (fr.GetLength() != (long)sizeof(header) + size) return false;
+	if (fr.Read(&header, sizeof(header)) != sizeof(header)) return false;
+	if (memcmp(header.magic, UpscaleCacheMagic, 4) || header.version != UpscaleCacheVersion || header.width != width || header.height != height) return false;
+
+	auto buffer = new unsigned char[size];
+	if (fr.Read(buffer, size) != size)
+	{
+		delete[] buffer;
+		return false;
+	}
+	delete[] texbuffer.mBuffer;
+	texbuffer.mBuffer = buffer;
+	texbuffer.mWidth = width;
+	texbuffer.mHeight = height;
+	return true;
+}
+
+static std::atomic<size_t> UpscaleCacheWritten;	// bytes written since the last trim
+static bool UpscaleCacheTrimmed;
+
+//===========================================================================
+// 
+// Deletes the oldest entries until the cache fits into
+// gl_texture_hqresize_cachesize. This runs once per session, and again
+// whenever a quarter of that size has been written since. It is only
+// called from the game thread, while the workers may still be writing.
+//
+//===========================================================================
+
+void TrimUpscaleCache()
+{
+	size_t limit = (size_t)gl_texture_hqresize_cachesize << 20;
+	if (UpscaleCacheTrimmed && UpscaleCacheWritten < limit / 4) return;
+	UpscaleCacheTrimmed = true;
+	UpscaleCacheWritten = 0;
+
+	struct CacheEntry
+	{
+		FString name;
+		size_t size;
+		time_t time;
+	};
+	TArray<CacheEntry> entries;
+	size_t total = 0;
+
+	const FString &path = UpscaleCachePath();
+	findstate_t c_file;
+	void *file;
+	if ((file = I_FindFirst(path + "*", &c_file)) != ((void *)(-1)))
+	{
+		do
+		{
+			if (!(I_FindAttr(&c_file) & FA_DIREC))
+			{
+				CacheEntry entry;
+				entry.name = path + I_FindName(&c_file);
+				if (GetFileInfo(entry.name, &entry.size, &entry.time))
+				{
+					total += entry.size;
+					entries.Push(entry);
+				}
+			}
+		} while (I_FindNext(file, &c_file) == 0);
+		I_FindClose(file);
+	}
+	if (total <= limit) return;
+
+	std::sort(entries.begin(), entries.end(), [](const CacheEntry &a, const CacheEntry &b) { return a.time < b.time; });
+	for (auto &entry : entries)
+	{
+		if (total <= limit) break;
+		if (remove(entry.name) == 0) total -= entry.size;
+	}
+}
+
+static void WriteUpscaleCache(const FString &name, const FTextureBuffer &texbuffer)
+{
+	// Write to a per-thread temporary first so that an interrupted or concurrent write never leaves a broken entry.
+	FString tempname;
+	tempname.Format("%s.%zx.tmp", name.GetChars(), std::hash<std::thread::id>()(std::this_thread::get_id()));
+
+	std::unique_ptr<FileWriter> fw(FileWriter::Open(tempname));
+	if (!fw) return;
+
+	UpscaleCacheHeader header;
+	memcpy(header.magic, UpscaleCacheMagic, 4);
+	header.version = UpscaleCacheVersion;
+	header.width = texbuffer.mWidth;
+	header.height = texbuffer.mHeight;
+
+	size_t size = texbuffer.mWidth * texbuffer.mHeight * 4;
+	bool ok = fw->Write(&header, sizeof(header)) == sizeof(header) && fw->Write(texbuffer.mBuffer, size) == size;
+	fw.reset();
+
+	if (!ok || rename(tempname, name) != 0)
+	{
+		remove(tempname);
+	}
+	else
+	{
+		UpscaleCacheWritten += sizeof(header) + size;
+	}
+}
+
 //===========================================================================
 // 
 // [BB] Upsamples the texture in texbuffer.mBuffer, frees texbuffer.mBuffer and returns
@@ -420,20 +676,23 @@ static void xbrzOldScale(size_t factor, const uint32_t* src, uint32_t* trg, int
 
 void FTexture::CreateUpsampledTextureBuffer(FTextureBuffer &texbuffer, bool hasAlpha, bool checkonly)
 {
-	// [BB] Make sure that inWidth and inHeight denote the size of
-	// the returned buffer even if we don't upsample the input buffer.
+	if (gl_texture_hqresize_cache && !checkonly) TrimUpscaleCache();
+	CreateUpsampledTextureBuffer(texbuffer, hasAlpha, checkonly, FUpscaleSettings::Current());
+}
 
-	int inWidth = texbuffer.mWidth;
-	int inHeight = texbuffer.mHeight;
+void FTexture::CreateUpsampledTextureBuffer(FTextureBuffer &texbuffer, bool hasAlpha, bool checkonly, const FUpscaleSettings &settings)
+{
+	int type = settings.type;
+	int mult = settings.mult;
 
-	int type = gl_texture_hqresizemode;
-	int mult = gl_texture_hqresizemult;
 #ifdef HAVE_MMX
 	// hqNx MMX does not preserve the alpha channel so fall back to C-version for such textures
 	if (hasAlpha && type == 3)
 	{
 		type = 2;
 	}
+#else
+	if (type == 3) return;
 #endif
 	// These checks are to ensure consistency of the content ID.
 	if (mult < 2 || mult > 6 || type < 1 || type > 6) return;
@@ -441,46 +700,16 @@ void FTexture::CreateUpsampledTextureBuffer(FTextureBuffer &texbuffer, bool hasA
 
 	if (!checkonly)
 	{
-		if (type == 1)
-		{
-			if (mult == 2)
-				texbuffer.mBuffer = scaleNxHelper(&scale2x, 2, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
-			else if (mult == 3)
-				texbuffer.mBuffer = scaleNxHelper(&scale3x, 3, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
-			else if (mult == 4)
-				texbuffer.mBuffer = scaleNxHelper(&scale4x, 4, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
-			else return;
-		}
-		else if (type == 2)
+		if (settings.useCache)
 		{
-			if (mult == 2)
-				texbuffer.mBuffer = hqNxHelper(&hq2x_32, 2, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
-			else if (mult == 3)
-				texbuffer.mBuffer = hqNxHelper(&hq3x_32, 3, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
-			else if (mult == 4)
-				texbuffer.mBuffer = hqNxHelper(&hq4x_32, 4, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
-			else return;
-		}
-#ifdef HAVE_MMX
-		else if (type == 3)
-		{
-			if (mult == 2)
-				texbuffer.mBuffer = hqNxAsmHelper(&HQnX_asm::hq2x_32, 2, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
-			else if (mult == 3)
-				texbuffer.mBuffer = hqNxAsmHelper(&HQnX_asm::hq3x_32, 3, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
-			else if (mult == 4)
-				texbuffer.mBuffer = hqNxAsmHelper(&HQnX_asm::hq4x_32, 4, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
-			else return;
+			FString name = UpscaleCacheName(texbuffer, type, mult, settings);
+			if (!ReadUpscaleCache(name, texbuffer, mult))
+			{
+				if (!UpscaleBuffer(texbuffer, type, mult, settings)) return;
+				WriteUpscaleCache(name, texbuffer);
+			}
 		}
-#endif
-		else if (type == 4)
-			texbuffer.mBuffer = xbrzHelper(xbrz::scale, mult, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
-		else if (type == 5)
-			texbuffer.mBuffer = xbrzHelper(xbrzOldScale, mult, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
-		else if (type == 6)
-			texbuffer.mBuffer = normalNx(mult, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
-		else
-			return;
+		else if (!UpscaleBuffer(texbuffer, type, mult, settings)) return;
 	}
 	else
 	{
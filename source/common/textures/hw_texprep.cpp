@@ -0,0 +1,284 @@
+/*
+** hw_texprep.cpp
+**
+** Upscales texture buffers on worker threads ahead of their first use.
+**
+** The queue is keyed by texture, translation and buffer flags. Its jobs
+** only own the buffer and never touch the texture itself, so textures
+** just have to be forgotten before they get deleted.
+**
+** Precaching can queue far more than ever gets drawn, so the finished
+** buffers nobody has taken yet are capped. Past that the oldest ones are
+** dropped and those textures get upscaled when they are bound, as they
+** would without the queue.
+**
+*/
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "hw_texprep.h"
+#include "textures.h"
+#include "c_cvars.h"
+#include "templates.h"
+
+EXTERN_CVAR(Int, gl_texture_hqresizemode)
+EXTERN_CVAR(Int, gl_texture_hqresizemult)
+
+static const size_t MaxFinishedBytes = 256 << 20;
+
+struct FTexturePrepJob
+{
+	enum
+	{
+		Waiting,
+		Running,
+		Done
+	};
+
+	FTexture* tex;
+	int translation;
+	int flags;
+	FUpscaleSettings settings;	// taken when this was queued, the workers must not read the CVARs
+	bool hasAlpha;
+	bool claimed = false;	// someone is waiting in Remove for this, so it may not be evicted
+	int state = Waiting;
+	size_t bytes = 0;	// size of the finished buffer
+	FTextureBuffer buffer;
+};
+
+struct FTexturePrepQueue
+{
+	std::mutex lock;
+	std::condition_variable workAvailable;
+	std::condition_variable jobDone;
+	TArray<FTexturePrepJob*> jobs;		// in queue order
+	TArray<std::thread> workers;
+	std::atomic<int> numJobs = { 0 };
+	size_t finishedBytes = 0;
+	bool stop = false;
+
+	void WorkerMain()
+	{
+		std::unique_lock<std::mutex> guard(lock);
+		while (!stop)
+		{
+			unsigned index = jobs.FindEx([](FTexturePrepJob* job) { return job->state == FTexturePrepJob::Waiting; });
+			if (index == jobs.Size())
+			{
+				workAvailable.wait(guard);
+				continue;
+			}
+			auto job = jobs[index];
+			job->state = FTexturePrepJob::Running;
+			guard.unlock();
+
+			FTexture::CreateUpsampledTextureBuffer(job->buffer, job->hasAlpha, false, job->settings);
+
+			guard.lock();
+			job->state = FTexturePrepJob::Done;
+			job->bytes = (size_t)job->buffer.mWidth * job->buffer.mHeight * 4;
+			finishedBytes += job->bytes;
+			jobDone.notify_all();
+			Evict(guard);
+		}
+	}
+
+	// Must be called with the lock held. Drops the oldest finished buffers until they fit again.
+	void Evict(std::unique_lock<std::mutex>& guard)
+	{
+		for (unsigned i = 0; i < jobs.Size() && finishedBytes > MaxFinishedBytes; )
+		{
+			auto job = jobs[i];
+			if (job->state != FTexturePrepJob::Done || job->claimed)
+			{
+				i++;
+				continue;
+			}
+			Remove(guard, job);
+			delete job;
+		}
+	}
+
+	unsigned Find(FTexture* tex, int translation, int flags)
+	{
+		return jobs.FindEx([=](FTexturePrepJob* job) { return job->tex == tex && job->translation == translation && job->flags == flags; });
+	}
+
+	// Must be called with the lock held. Waits for the job if a worker is busy with it.
+	// The lock is released while waiting, so the job is claimed first to keep Evict from deleting it in the meantime.
+	void Remove(std::unique_lock<std::mutex>& guard, FTexturePrepJob* job)
+	{
+		job->claimed = true;
+		while (job->state == FTexturePrepJob::Running)
+		{
+			jobDone.wait(guard);
+		}
+		jobs.Delete(jobs.Find(job));
+		numJobs--;
+		finishedBytes -= job->bytes;
+	}
+};
+
+// This is never deleted, so that textures destroyed during static destruction can still call ForgetTextureBuffers.
+static FTexturePrepQueue* queue;
+
+//==========================================================================
+//
+// QueueTextureBuffer
+//
+//==========================================================================
+
+void QueueTextureBuffer(FTexture* tex, int translation, int flags, FTextureBuffer&& buffer, bool hasAlpha)
+{
+	if (queue == nullptr)
+	{
+		queue = new FTexturePrepQueue;
+	}
+	if (queue->workers.Size() == 0)
+	{
+		unsigned numthreads = clamp<unsigned>(std::thread::hardware_concurrency() / 2, 1, 4);
+		for (unsigned i = 0; i < numthreads; i++)
+		{
+			queue->workers.Push(std::thread([]() { queue->WorkerMain(); }));
+		}
+	}
+
+	auto job = new FTexturePrepJob;
+	job->tex = tex;
+	job->translation = translation;
+	job->flags = flags;
+	job->settings = FUpscaleSettings::Current();
+	job->hasAlpha = hasAlpha;
+	job->buffer = std::move(buffer);
+
+	// The workers write to the disk cache, but trimming it reads the CVARs so it is done here.
+	if (job->settings.useCache) TrimUpscaleCache();
+
+	std::lock_guard<std::mutex> guard(queue->lock);
+	queue->jobs.Push(job);
+	queue->numJobs++;
+	queue->workAvailable.notify_one();
+}
+
+//==========================================================================
+//
+// IsTextureBufferQueued
+//
+//==========================================================================
+
+bool IsTextureBufferQueued(FTexture* tex, int translation, int flags)
+{
+	if (queue == nullptr || queue->numJobs == 0) return false;
+
+	std::lock_guard<std::mutex> guard(queue->lock);
+	return queue->Find(tex, translation, flags) < queue->jobs.Size();
+}
+
+//==========================================================================
+//
+// TakeTextureBuffer
+//
+// Returns the upscaled buffer if this one has been queued. If no worker
+// got to it yet, the upscaling is done right here, which still saves
+// creating the buffer again.
+//
+//==========================================================================
+
+bool TakeTextureBuffer(FTexture* tex, int translation, int flags, FTextureBuffer& result)
+{
+	if (queue == nullptr || queue->numJobs == 0) return false;
+
+	std::unique_lock<std::mutex> guard(queue->lock);
+	unsigned index = queue->Find(tex, translation, flags);
+	if (index == queue->jobs.Size()) return false;
+
+	auto job = queue->jobs[index];
+	queue->Remove(guard, job);
+	guard.unlock();
+
+	bool ok = job->settings.type == gl_texture_hqresizemode && job->settings.mult == gl_texture_hqresizemult;
+	if (ok)
+	{
+		if (job->state == FTexturePrepJob::Waiting)
+		{
+			FTexture::CreateUpsampledTextureBuffer(job->buffer, job->hasAlpha, false, job->settings);
+		}
+		result = std::move(job->buffer);
+	}
+	delete job;
+	return ok;
+}
+
+//==========================================================================
+//
+// ForgetTextureBuffers
+//
+// Must be called before a texture gets deleted, so that a new texture
+// at the same address does not inherit its buffers.
+//
+//==========================================================================
+
+void ForgetTextureBuffers(FTexture* tex)
+{
+	if (queue == nullptr || queue->numJobs == 0) return;
+
+	std::unique_lock<std::mutex> guard(queue->lock);
+	for (int i = queue->jobs.Size() - 1; i >= 0; i--)
+	{
+		if (i < (int)queue->jobs.Size() && queue->jobs[i]->tex == tex)
+		{
+			auto job = queue->jobs[i];
+			queue->Remove(guard, job);
+			delete job;
+		}
+	}
+}
+
+//==========================================================================
+//
+// ClearTextureBuffers
+//
+//==========================================================================
+
+void ClearTextureBuffers()
+{
+	if (queue == nullptr || queue->numJobs == 0) return;
+
+	std::unique_lock<std::mutex> guard(queue->lock);
+	while (queue->jobs.Size() > 0)
+	{
+		auto job = queue->jobs.Last();
+		queue->Remove(guard, job);
+		delete job;
+	}
+}
+
+//==========================================================================
+//
+// ShutdownTextureBuffers
+//
+// Drops everything that is still queued and stops the worker threads.
+// The queue itself stays around for textures that get deleted later,
+// and the workers get started again if something is queued after this.
+//
+//==========================================================================
+
+void ShutdownTextureBuffers()
+{
+	if (queue == nullptr) return;
+
+	ClearTextureBuffers();
+	{
+		std::lock_guard<std::mutex> guard(queue->lock);
+		queue->stop = true;
+		queue->workAvailable.notify_all();
+	}
+	for (auto& worker : queue->workers)
+	{
+		worker.join();
+	}
+	queue->workers.Clear();
+	queue->stop = false;
+}
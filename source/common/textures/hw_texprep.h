@@ -0,0 +1,18 @@
+#pragma once
+
+// Background preparation of texture buffers for the hardware renderers.
+//
+// FTexture::PrepareTexBuffer creates the unscaled buffer right away and
+// queues it here. The worker threads run the upscaler on it, and the
+// next CreateTexBuffer call with the same translation and flags picks up
+// the result instead of doing all the work when the texture gets bound.
+
+class FTexture;
+struct FTextureBuffer;
+
+void QueueTextureBuffer(FTexture* tex, int translation, int flags, FTextureBuffer&& buffer, bool hasAlpha);
+bool IsTextureBufferQueued(FTexture* tex, int translation, int flags);
+bool TakeTextureBuffer(FTexture* tex, int translation, int flags, FTextureBuffer& result);
+void ForgetTextureBuffers(FTexture* tex);
+void ClearTextureBuffers();
+void ShutdownTextureBuffers();
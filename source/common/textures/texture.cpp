@@ -50,6 +50,7 @@
 #include "c_cvars.h"
 #include "imagehelpers.h"
 #include "v_video.h"
+#include "hw_texprep.h"
 
 // Wrappers to keep the definitions of these classes out of here.
 IHardwareTexture* CreateHardwareTexture(int numchannels);
@@ -69,6 +70,11 @@ FTexture::FTexture (int lumpnum)
 	bTranslucent = -1;
 }
 
+FTexture::~FTexture()
+{
+	ForgetTextureBuffers(this);
+}
+
 //===========================================================================
 //
 // FTexture::GetBgraBitmap
@@ -339,6 +345,11 @@ FTextureBuffer FTexture::CreateTexBuffer(int translation, int flags)
 		result.mContentId = 0;
 		ImageHelpers::FlipNonSquareBlock(result.mBuffer, p, h, w, h);
 	}
+	else if (!(flags & CTF_CheckOnly) && TakeTextureBuffer(this, translation, flags, result))
+	{
+		// This was prepared in the background and only needs the final processing.
+		ProcessData(result.mBuffer, result.mWidth, result.mHeight, false);
+	}
 	else
 	{
 		unsigned char* buffer = nullptr;
@@ -403,6 +414,29 @@ FTextureBuffer FTexture::CreateTexBuffer(int translation, int flags)
 
 }
 
+//===========================================================================
+// 
+// Creates the buffer for an upscaled hardware texture now and lets the
+// texture preparation queue upscale it in the background. flags must be
+// the same that will be passed to CreateTexBuffer later.
+//
+//===========================================================================
+
+void FTexture::PrepareTexBuffer(int translation, int flags)
+{
+	// Without upscaling there's nothing that could be done in the background.
+	if ((flags & (CTF_Indexed | CTF_CheckOnly)) || !(flags & CTF_Upscale) || !(flags & CTF_ProcessData) || !GetImage())
+		return;
+
+	if (IsTextureBufferQueued(this, translation, flags))
+		return;
+
+	auto buffer = CreateTexBuffer(translation, flags & ~(CTF_Upscale | CTF_ProcessData));
+	// Same rule as in CreateTexBuffer: translated images are treated as opaque.
+	bool hasAlpha = translation <= 0 && bTranslucent;
+	QueueTextureBuffer(this, translation, flags, std::move(buffer), hasAlpha);
+}
+
 //===========================================================================
 // 
 // Dummy texture for the 0-entry.
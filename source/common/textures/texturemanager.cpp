@@ -41,6 +41,7 @@
 #include "gstrings.h"
 #include "textures.h"
 #include "texturemanager.h"
+#include "hw_texprep.h"
 #include "c_dispatch.h"
 #include "sc_man.h"
 #include "image.h"
@@ -85,6 +86,7 @@ FTextureManager::~FTextureManager ()
 
 void FTextureManager::DeleteAll()
 {
+	ClearTextureBuffers();
 	FImageSource::ClearImages();
 	for (unsigned int i = 0; i < Textures.Size(); ++i)
 	{
@@ -114,6 +116,7 @@ void FTextureManager::DeleteAll()
 
 void FTextureManager::FlushAll()
 {
+	ClearTextureBuffers();
 	for (int i = TexMan.NumTextures() - 1; i >= 0; i--)
 	{
 		for (int j = 0; j < 2; j++)
@@ -202,6 +202,20 @@ struct FTextureBuffer
 
 };
 
+// The upscaler's CVARs, read on the game thread so that the upscaling itself can run on any thread.
+struct FUpscaleSettings
+{
+	int type;
+	int mult;
+	bool useCache;
+	bool multithread;
+	int mtWidth, mtHeight;
+	int xbrzColorFormat;
+	float xbrz[5];	// luminanceweight, equalcolortolerance, centerdirectionbias, dominantdirectionthreshold, steepdirectionthreshold
+
+	static FUpscaleSettings Current();
+};
+
 // Base texture class
 class FTexture : public RefCountedBase
 {
@@ -224,7 +238,9 @@ public:
 
 	IHardwareTexture* GetHardwareTexture(int translation, int scaleflags);
 	virtual FImageSource *GetImage() const { return nullptr; }
-	void CreateUpsampledTextureBuffer(FTextureBuffer &texbuffer, bool hasAlpha, bool checkonly);
+	static void CreateUpsampledTextureBuffer(FTextureBuffer &texbuffer, bool hasAlpha, bool checkonly);
+	// With the upscaler settings passed in, for threads that may not read the CVARs.
+	static void CreateUpsampledTextureBuffer(FTextureBuffer &texbuffer, bool hasAlpha, bool checkonly, const FUpscaleSettings &settings);
 
 	void CleanHardwareTextures()
 	{
@@ -282,9 +298,11 @@ public:
 
 
 	FTexture (int lumpnum = -1);
+	~FTexture();
 
 public:
 	FTextureBuffer CreateTexBuffer(int translation, int flags = 0);
+	void PrepareTexBuffer(int translation, int flags);
 	virtual bool DetermineTranslucency();
 	bool GetTranslucency()
 	{
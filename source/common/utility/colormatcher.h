@@ -35,12 +35,20 @@
 ** revisiting the problem. I never did, so now it's relegated to the mists
 ** of SVN history, and this is just a thin wrapper around BestColor().
 **
+** To speed up the lookups without changing their results, the color cube
+** is split into cells, and each cell remembers the palette entries that
+** can possibly be closest to a color inside it. Only those are checked.
+** The cells are filled in on first use without any locking, so Pick must
+** only be called from the main thread. (The texture upscaling workers
+** only ever see true color data and never need it.)
+**
 */
 
 #ifndef __COLORMATCHER_H__
 #define __COLORMATCHER_H__
 
 #include "palutil.h"
+#include "tarray.h"
 
 int BestColor (const uint32_t *pal_in, int r, int g, int b, int first, int num);
 
@@ -48,17 +56,42 @@ class FColorMatcher
 {
 public:
 	FColorMatcher () = default;
-	FColorMatcher (const uint32_t *palette) { Pal = reinterpret_cast<const PalEntry*>(palette); }
+	FColorMatcher (const uint32_t *palette) { SetPalette(palette); }
 	FColorMatcher (const FColorMatcher &other) = default;
 
-	void SetPalette(PalEntry* palette) { Pal = palette; }
-	void SetPalette (const uint32_t *palette) { Pal = reinterpret_cast<const PalEntry*>(palette); }
+	// This must also be called again after the palette's contents have changed.
+	void SetPalette(PalEntry* palette) { Pal = palette; Cells.Clear(); CellColors.Clear(); }
+	void SetPalette (const uint32_t *palette) { SetPalette((PalEntry*)palette); }
 	uint8_t Pick (int r, int g, int b)
 	{
 		if (Pal == nullptr)
 			return 1;
 
-		return (uint8_t)BestColor ((uint32_t *)Pal, r, g, b, 1, 255);
+		if ((unsigned)(r | g | b) > 255)
+			return (uint8_t)BestColor ((uint32_t *)Pal, r, g, b, 1, 255);
+
+		const Cell &cell = GetCell(((r >> CELL_SHIFT) * CELL_DIM + (g >> CELL_SHIFT)) * CELL_DIM + (b >> CELL_SHIFT));
+		const uint8_t *colors = &CellColors[cell.Start];
+		int bestcolor = 1;
+		int bestdist = 257 * 257 + 257 * 257 + 257 * 257;
+
+		for (int i = 0; i < cell.Count; i++)
+		{
+			int color = colors[i];
+			int x = r - Pal[color].r;
+			int y = g - Pal[color].g;
+			int z = b - Pal[color].b;
+			int dist = x*x + y*y + z*z;
+			if (dist < bestdist)
+			{
+				if (dist == 0)
+					return color;
+
+				bestdist = dist;
+				bestcolor = color;
+			}
+		}
+		return bestcolor;
 	}
 	
 	uint8_t Pick (PalEntry pe)
@@ -69,7 +102,29 @@ public:
 	FColorMatcher &operator= (const FColorMatcher &other) = default;
 
 private:
-	const PalEntry *Pal;
+	enum
+	{
+		CELL_SHIFT = 4,
+		CELL_DIM = 256 >> CELL_SHIFT,
+	};
+
+	struct Cell
+	{
+		int Start = 0;
+		int Count = -1;		// -1 until the cell is needed for the first time.
+	};
+
+	const Cell &GetCell(int index)
+	{
+		if (Cells.Size() == 0) Cells.Resize(CELL_DIM * CELL_DIM * CELL_DIM);
+		if (Cells[index].Count < 0) BuildCell(index);
+		return Cells[index];
+	}
+	void BuildCell(int index);
+
+	const PalEntry *Pal = nullptr;
+	TArray<Cell> Cells;
+	TArray<uint8_t> CellColors;
 };
 
 extern FColorMatcher ColorMatcher;
@@ -33,6 +33,18 @@
 **
 */
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#include <climits>
+
 #include "files.h"
 #include "templates.h"	// just for 'clamp'
 #include "zstring.h"
@@ -349,6 +361,93 @@ public:
 
 
 
+//==========================================================================
+//
+// MappedFileReader
+//
+// reads data from a read-only memory mapping of an entire file.
+// Since the whole file is addressable, lumps stored without compression
+// can be read in place. Locking a lump still copies it because some
+// callers patch locked lump data.
+//
+//==========================================================================
+
+class MappedFileReader : public MemoryReader
+{
+#ifdef _WIN32
+	HANDLE hMapping = nullptr;
+#endif
+
+public:
+	MappedFileReader()
+	{}
+
+	bool IsMapped() const override
+	{
+		return true;
+	}
+
+	~MappedFileReader()
+	{
+		if (bufptr == nullptr) return;
+#ifdef _WIN32
+		UnmapViewOfFile(bufptr);
+		CloseHandle(hMapping);
+#else
+		munmap((void*)bufptr, Length);
+#endif
+	}
+
+	bool Open(const char *filename)
+	{
+#ifdef _WIN32
+		auto widename = WideString(filename);
+		HANDLE hFile = CreateFileW(widename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (hFile == INVALID_HANDLE_VALUE) return false;
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(hFile, &size) || size.QuadPart <= 0 || size.QuadPart > LONG_MAX)
+		{
+			CloseHandle(hFile);
+			return false;
+		}
+		// The mapping keeps its own reference to the file.
+		hMapping = CreateFileMappingW(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		CloseHandle(hFile);
+		if (hMapping == nullptr) return false;
+
+		bufptr = (const char*)MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+		if (bufptr == nullptr)
+		{
+			CloseHandle(hMapping);
+			hMapping = nullptr;
+			return false;
+		}
+		Length = (long)size.QuadPart;
+#else
+		int fd = open(filename, O_RDONLY);
+		if (fd < 0) return false;
+
+		struct stat info;
+		if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size <= 0 || info.st_size > LONG_MAX)
+		{
+			close(fd);
+			return false;
+		}
+		// The mapping stays valid after the descriptor is closed.
+		void *mem = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if (mem == MAP_FAILED) return false;
+
+		bufptr = (const char*)mem;
+		Length = (long)info.st_size;
+#endif
+		FilePos = 0;
+		return true;
+	}
+};
+
+
 //==========================================================================
 //
 // FileReader
@@ -370,6 +469,22 @@ bool FileReader::OpenFile(const char *filename, FileReader::Size start, FileRead
 	return true;
 }
 
+bool FileReader::OpenMappedFile(const char *filename)
+{
+	// Mapping every archive would eat up the address space of 32 bit builds.
+	if (sizeof(void*) < 8) return false;
+
+	auto reader = new MappedFileReader;
+	if (!reader->Open(filename))
+	{
+		delete reader;
+		return false;
+	}
+	Close();
+	mReader = reader;
+	return true;
+}
+
 bool FileReader::OpenFilePart(FileReader &parent, FileReader::Size start, FileReader::Size length)
 {
 	auto reader = new FileReaderRedirect(parent, (long)start, (long)length);
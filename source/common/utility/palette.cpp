@@ -33,6 +33,7 @@
 */
 
 #include <algorithm>
+#include <climits>
 #include "palutil.h"
 #include "palentry.h"
 #include "sc_man.h"
@@ -41,6 +42,7 @@
 #include "printf.h"
 #include "templates.h"
 #include "m_png.h"
+#include "colormatcher.h"
 
 /****************************/
 /* Palette management stuff */
@@ -71,6 +73,59 @@ int BestColor (const uint32_t *pal_in, int r, int g, int b, int first, int num)
 }
 
 
+//==========================================================================
+//
+// FColorMatcher :: BuildCell
+//
+// Collects the palette entries that may be closest to any color in the
+// cell, in palette order. An entry can only be the closest if its minimum
+// distance to the cell is not larger than the smallest maximum distance
+// of any entry, so this finds the same color as BestColor, ties included.
+//
+//==========================================================================
+
+void FColorMatcher::BuildCell(int index)
+{
+	int lo[3], hi[3];
+	lo[0] = (index / (CELL_DIM * CELL_DIM)) << CELL_SHIFT;
+	lo[1] = ((index / CELL_DIM) % CELL_DIM) << CELL_SHIFT;
+	lo[2] = (index % CELL_DIM) << CELL_SHIFT;
+	for (int i = 0; i < 3; i++) hi[i] = lo[i] + (1 << CELL_SHIFT) - 1;
+
+	int mindist[256];
+	int limit = INT_MAX;
+
+	for (int color = 1; color < 255; color++)
+	{
+		const int c[3] = { Pal[color].r, Pal[color].g, Pal[color].b };
+		int dmin = 0, dmax = 0;
+
+		for (int i = 0; i < 3; i++)
+		{
+			int below = lo[i] - c[i], above = c[i] - hi[i];
+			int d = std::max(0, std::max(below, above));
+			int dfar = std::max(abs(lo[i] - c[i]), abs(hi[i] - c[i]));
+			dmin += d * d;
+			dmax += dfar * dfar;
+		}
+		mindist[color] = dmin;
+		limit = std::min(limit, dmax);
+	}
+
+	Cell &cell = Cells[index];
+	cell.Start = CellColors.Size();
+	cell.Count = 0;
+	for (int color = 1; color < 255; color++)
+	{
+		if (mindist[color] <= limit)
+		{
+			CellColors.Push(color);
+			cell.Count++;
+		}
+	}
+}
+
+
 // [SP] Re-implemented BestColor for more precision rather than speed. This function is only ever called once until the game palette is changed.
 
 int PTM_BestColor (const uint32_t *pal_in, int r, int g, int b, bool reverselookup, float powtable_val, int first, int num)
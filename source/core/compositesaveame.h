@@ -6,15 +6,20 @@
 #include "tarray.h"
 #include "resourcefile.h"
 
+struct FSavegameWriteJob;
+
 class CompositeSavegameWriter
 {
+	friend struct FSavegameWriteJob;
+
 	FString filename;
 	TDeletingArray<BufferWriter*> subfiles;
 	TArray<FCompressedBuffer> subbuffers;
 	TArray<FString> subfilenames;
 	TArray<bool> isCompressed;
 
-	FCompressedBuffer CompressElement(BufferWriter* element, bool compress);
+	static FCompressedBuffer CompressElement(BufferWriter* element, bool compress);
+	FSavegameWriteJob* DetachJob();
 public:
 	void Clear()
 	{
@@ -40,5 +45,10 @@ public:
 	FileWriter& NewElement(const char* filename, bool compress = true);
 	void AddCompressedElement(const char* filename, FCompressedBuffer& buffer);
 	bool WriteToFile();
+	bool WriteToFileInBackground();
 };
 
+// Waits until a savegame that is being written in the background has been completed.
+bool WaitForSavegameWrite();
+void CheckSavegameWrite();
+
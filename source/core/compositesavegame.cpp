@@ -34,11 +34,16 @@
 */
 
 #include <zlib.h>
+#include <thread>
+#include <atomic>
 #include "compositesaveame.h"
+#include "savegamehelp.h"
 #include "file_zip.h"
 #include "resourcefile.h"
 #include "m_png.h"
 #include "gamecontrol.h"
+#include "printf.h"
+#include "v_text.h"
 
 
 bool WriteZip(const char *filename, TArray<FString> &filenames, TArray<FCompressedBuffer> &content);
@@ -122,34 +127,143 @@ error:
 	
 }
 
-bool CompositeSavegameWriter::WriteToFile()
+//==========================================================================
+//
+// Everything needed to compress and write out a savegame, detached
+// from the writer so that this can run while the game continues.
+//
+//==========================================================================
+
+struct FSavegameWriteJob
 {
-	if (subfiles.Size() == 0) return false;
-	TArray<FCompressedBuffer> compressed(subfiles.Size(), 1);
-	for (unsigned i = 0; i < subfiles.Size(); i++)
+	FString filename;
+	TArray<BufferWriter*> subfiles;
+	TArray<FCompressedBuffer> subbuffers;
+	TArray<FString> subfilenames;
+	TArray<bool> isCompressed;
+	bool result = false;
+
+	bool Run()
 	{
-		if (subfiles[i])
-			compressed[i] = CompressElement(subfiles[i], isCompressed[i]);
-		else
+		TArray<FCompressedBuffer> compressed(subfiles.Size(), 1);
+		for (unsigned i = 0; i < subfiles.Size(); i++)
 		{
-			compressed[i] = subbuffers[i];
-			subbuffers[i] = {};
+			if (subfiles[i])
+				compressed[i] = CompositeSavegameWriter::CompressElement(subfiles[i], isCompressed[i]);
+			else
+			{
+				compressed[i] = subbuffers[i];
+				subbuffers[i] = {};
+			}
 		}
+
+		bool res = WriteZip(filename, subfilenames, compressed);
+		for (auto& b : compressed) b.Clean();
+		return res;
 	}
-	
-	if (WriteZip(filename, subfilenames, compressed))
+
+	~FSavegameWriteJob()
 	{
-		// Check whether the file is ok by trying to open it.
-		//FResourceFile *test = FResourceFile::OpenResourceFile(filename, true);
-		//if (test != nullptr)
-		{
-			Clear();
-			//delete test;
-			return true;
-		}
+		for (auto& b : subbuffers) b.Clean();
+		for (auto f : subfiles) delete f;
 	}
+};
 
+static std::thread backgroundWriter;
+static std::atomic<bool> backgroundDone;
+static FSavegameWriteJob* backgroundJob;
+static bool lastWriteResult = true;
+static TArray<std::function<void(bool)>> writeNotifications;
+
+FSavegameWriteJob* CompositeSavegameWriter::DetachJob()
+{
+	auto job = new FSavegameWriteJob;
+	job->filename = filename;
+	job->subfilenames = std::move(subfilenames);
+	job->subbuffers = std::move(subbuffers);
+	job->isCompressed = std::move(isCompressed);
+	for (auto f : subfiles) job->subfiles.Push(f);
+	subfiles.Clear();	// now owned by the job.
 	Clear();
-	return false;
+	return job;
+}
+
+bool CompositeSavegameWriter::WriteToFile()
+{
+	if (subfiles.Size() == 0) return false;
+	WaitForSavegameWrite();
+	auto job = DetachJob();
+	bool res = job->Run();
+	delete job;
+	lastWriteResult = res;
+	return res;
+}
+
+//==========================================================================
+//
+// Compression and file output are the expensive part of saving, and only
+// operate on the buffers that have already been filled, so they can run on
+// a separate thread. Only one savegame is written at a time.
+//
+// The return value only tells whether the write could be started. The
+// outcome is reported on the game thread once the write has finished,
+// through OnSavegameWritten.
+//
+//==========================================================================
+
+bool CompositeSavegameWriter::WriteToFileInBackground()
+{
+	if (subfiles.Size() == 0) return false;
+	WaitForSavegameWrite();
+	backgroundJob = DetachJob();
+	backgroundDone = false;
+	backgroundWriter = std::thread([job = backgroundJob]()
+	{
+		job->result = job->Run();
+		backgroundDone = true;
+	});
+	return true;
+}
+
+bool WaitForSavegameWrite()
+{
+	if (backgroundWriter.joinable())
+	{
+		backgroundWriter.join();
+
+		lastWriteResult = backgroundJob->result;
+		if (!lastWriteResult) Printf(TEXTCOLOR_RED "Unable to write savegame %s\n", backgroundJob->filename.GetChars());
+		delete backgroundJob;
+		backgroundJob = nullptr;
+	}
+
+	// The notifications may start a new save, so they must not be run from the list itself.
+	auto notifications = std::move(writeNotifications);
+	for (auto& done : notifications) done(lastWriteResult);
+	return lastWriteResult;
 }
 
+//==========================================================================
+//
+// Called once per frame: finishes a background write that has completed
+// so that its notifications do not have to wait for the next save or load.
+//
+//==========================================================================
+
+void CheckSavegameWrite()
+{
+	if (backgroundWriter.joinable() && backgroundDone) WaitForSavegameWrite();
+}
+
+//==========================================================================
+//
+// Runs 'done' with the result of the last savegame write as soon as it
+// has completed, or right away if no write is pending.
+//
+//==========================================================================
+
+void OnSavegameWritten(std::function<void(bool)> done)
+{
+	if (backgroundWriter.joinable()) writeNotifications.Push(std::move(done));
+	else done(lastWriteResult);
+}
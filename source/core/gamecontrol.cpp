@@ -61,9 +61,12 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "gamestate.h"
 #include "gstrings.h"
 #include "texturemanager.h"
+#include "hw_texprep.h"
 #include "i_interface.h"
 #include "x86.h"
 #include "startupinfo.h"
+#include "timedemo.h"
+#include "compositesaveame.h"
 
 CVAR(Bool, autoloadlights, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
 CVAR(Bool, autoloadbrightmaps, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
@@ -368,6 +371,7 @@ void UserConfig::ProcessOptions()
 	AddArt.reset(Args->GatherFiles("-art"));
 
 	nologo = Args->CheckParm("-nologo") || Args->CheckParm("-quick");
+	TIMEDEMO_Init();
 	nosound = Args->CheckParm("-nosfx") || Args->CheckParm("-nosound");
 	if (Args->CheckParm("-setup")) queryiwad = 1;
 	else if (Args->CheckParm("-nosetup")) queryiwad = 0;
@@ -519,6 +523,8 @@ int GameMain()
 		I_ShowFatalError(err.what());
 		r = -1;
 	}
+	TIMEDEMO_Finish();
+	WaitForSavegameWrite();
 	M_ClearMenus(true);
 	if (gi)
 	{
@@ -533,6 +539,7 @@ int GameMain()
 	C_DeinitConsole();
 	V_ClearFonts();
 	vox_deinit();
+	ShutdownTextureBuffers();
 	TexMan.DeleteAll();
 	TileFiles.CloseAll();	// delete the texture data before shutting down graphics.
 	GLInterface.Deinit();
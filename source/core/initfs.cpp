@@ -379,6 +379,8 @@ void InitFileSystem(TArray<GrpEntry>& groups)
 	{
 		DeleteStuff(fileSystem, todelete, groups.Size());
 	};
+	lfi.postprocessKey.Format("delete %u:", groups.Size());
+	for (auto& str : todelete) lfi.postprocessKey << str << ';';
 	fileSystem.InitMultipleFiles(Files, false, &lfi);
 	if (Args->CheckParm("-dumpfs"))
 	{
@@ -0,0 +1,193 @@
+//-------------------------------------------------------------------------
+/*
+Copyright (C) 2020 Raze contributors
+
+This is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+//-------------------------------------------------------------------------
+
+#include "interpolation.h"
+
+#ifdef _DEBUG
+#include "c_dispatch.h"
+#include "printf.h"
+#include "v_text.h"
+#include "stats.h"
+#include "templates.h"
+#endif
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__i386__) || defined(__amd64__)
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#include <emmintrin.h>
+#define INTERPOLATE_SSE2
+#endif
+
+//==========================================================================
+//
+// The interpolated value is old + mulscale16(current - old, smoothratio),
+// computed exactly like the original per-pointer loops, including the
+// wraparound of the 32 bit arithmetic.
+//
+//==========================================================================
+
+static inline int32_t InterpolateValue(int32_t oldval, int32_t curval, int smoothratio)
+{
+	int32_t const delta = (int32_t)((uint32_t)curval - (uint32_t)oldval);
+	return (int32_t)((uint32_t)oldval + (uint32_t)(int32_t)(((int64_t)delta * smoothratio) >> 16));
+}
+
+void InterpolateValues(const int32_t* oldvals, const int32_t* curvals, int32_t* out, unsigned count, int smoothratio)
+{
+	unsigned i = 0;
+
+#ifdef INTERPOLATE_SSE2
+	// SSE2 has no signed 32x32->64 multiply, so this takes the unsigned products of the
+	// even and odd lanes and corrects the result for negative factors. Only bits 16-47 of
+	// each product are needed, which makes the correction a subtraction of
+	// ((delta < 0 ? ratio : 0) + (ratio < 0 ? delta : 0)) << 16.
+	__m128i const ratio = _mm_set1_epi32(smoothratio);
+	__m128i const rationeg = _mm_srai_epi32(ratio, 31);
+	__m128i const lowmask = _mm_set_epi32(0, -1, 0, -1);
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i const oldv = _mm_loadu_si128((const __m128i*)(oldvals + i));
+		__m128i const delta = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(curvals + i)), oldv);
+
+		__m128i const even = _mm_srli_epi64(_mm_mul_epu32(delta, ratio), 16);
+		__m128i const odd = _mm_srli_epi64(_mm_mul_epu32(_mm_srli_epi64(delta, 32), ratio), 16);
+		__m128i result = _mm_or_si128(_mm_and_si128(even, lowmask), _mm_slli_epi64(odd, 32));
+
+		__m128i const fixup = _mm_add_epi32(_mm_and_si128(_mm_srai_epi32(delta, 31), ratio), _mm_and_si128(rationeg, delta));
+		result = _mm_sub_epi32(result, _mm_slli_epi32(fixup, 16));
+
+		_mm_storeu_si128((__m128i*)(out + i), _mm_add_epi32(oldv, result));
+	}
+#endif
+
+	for (; i < count; i++)
+		out[i] = InterpolateValue(oldvals[i], curvals[i], smoothratio);
+}
+
+void InterpolateValues(const int16_t* oldvals, const int16_t* curvals, int16_t* out, unsigned count, int smoothratio)
+{
+	for (unsigned i = 0; i < count; i++)
+		out[i] = (int16_t)InterpolateValue(oldvals[i], curvals[i], smoothratio);
+}
+
+#ifdef _DEBUG
+//==========================================================================
+//
+// bench_interpolation [count] [repeats]
+//
+// Registers values laid out like sector heights with the old flat array
+// code and with TInterpolator and checks that both render the same.
+//
+//==========================================================================
+
+CCMD(bench_interpolation)
+{
+	unsigned const count = argv.argc() > 1 ? MAX(1, (int)strtol(argv[1], nullptr, 10)) : 4096;
+	int const repeats = argv.argc() > 2 ? MAX(1, (int)strtol(argv[2], nullptr, 10)) : 100;
+	enum { stride = 10 };	// sizeof(sectortype) / sizeof(int32_t)
+
+	TArray<int32_t> data(count * stride, true);
+	for (unsigned i = 0; i < data.Size(); i++)
+		data[i] = i * 1024;
+
+	TArray<int32_t*> curipos(count, true);
+	TArray<int32_t> oldipos(count, true), bakipos(count, true);
+	unsigned numinterpolations = 0;
+	TInterpolator<int32_t> interpolator;
+
+	cycle_t oldset, newset, olddo, newdo;
+	oldset.Reset();
+	newset.Reset();
+	olddo.Reset();
+	newdo.Reset();
+
+	oldset.Clock();
+	for (unsigned i = 0; i < count; i++)
+	{
+		int32_t* const posptr = &data[i * stride];
+		unsigned j;
+		for (j = 0; j < numinterpolations; j++)
+			if (curipos[j] == posptr)
+				break;
+		if (j == numinterpolations)
+		{
+			curipos[numinterpolations] = posptr;
+			oldipos[numinterpolations++] = *posptr;
+		}
+	}
+	oldset.Unclock();
+
+	newset.Clock();
+	for (unsigned i = 0; i < count; i++)
+		interpolator.Set(&data[i * stride]);
+	newset.Unclock();
+
+	// Move everything so that there is something to interpolate.
+	for (unsigned i = 0; i < data.Size(); i++)
+		data[i] += (i & 1) ? -(int32_t)i : (int32_t)i * 3;
+
+	int mismatches = 0;
+	TArray<int32_t> rendered(count, true);
+
+	for (int r = 0; r < repeats; r++)
+	{
+		int const smoothratio = (r * 65536) / repeats;
+
+		olddo.Clock();
+		int32_t ndelta = 0, j = 0;
+		for (unsigned i = 0; i < numinterpolations; i++)
+		{
+			int32_t const odelta = ndelta;
+			bakipos[i] = *curipos[i];
+			ndelta = *curipos[i] - oldipos[i];
+			if (odelta != ndelta)
+				j = (int32_t)(((int64_t)ndelta * smoothratio) >> 16);
+			*curipos[i] = oldipos[i] + j;
+		}
+		olddo.Unclock();
+
+		for (unsigned i = 0; i < numinterpolations; i++)
+		{
+			rendered[i] = *curipos[i];
+			*curipos[i] = bakipos[i];
+		}
+
+		newdo.Clock();
+		interpolator.Do(smoothratio);
+		newdo.Unclock();
+
+		for (unsigned i = 0; i < numinterpolations; i++)
+			if (*curipos[i] != rendered[i])
+				mismatches++;
+
+		interpolator.Restore();
+	}
+
+	Printf("bench_interpolation: %u values, %d frames\n", count, repeats);
+	Printf("  register: flat %.3f ms, hashed %.3f ms\n", oldset.TimeMS(), newset.TimeMS());
+	Printf("  interpolate: flat %.3f ms, gathered %.3f ms\n", olddo.TimeMS(), newdo.TimeMS());
+	if (mismatches)
+		Printf(TEXTCOLOR_RED "  %d mismatches!\n", mismatches);
+}
+#endif
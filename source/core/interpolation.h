@@ -0,0 +1,152 @@
+//-------------------------------------------------------------------------
+/*
+Copyright (C) 2020 Raze contributors
+
+This is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+//-------------------------------------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include "tarray.h"
+
+//==========================================================================
+//
+// Render interpolation of map and actor values, shared by the frontends
+//
+// Every registered value keeps its position from the previous game tic.
+// Do() moves it to old + mulscale16(current - old, smoothratio) for
+// rendering and Restore() puts the real value back afterwards.
+//
+// Registration is looked up by a pointer hash, and the values are kept
+// in separate arrays so that the interpolation itself runs over
+// contiguous memory. Only the loads and stores through the pointers
+// remain scattered.
+//
+//==========================================================================
+
+void InterpolateValues(const int32_t* oldvals, const int32_t* curvals, int32_t* out, unsigned count, int smoothratio);
+void InterpolateValues(const int16_t* oldvals, const int16_t* curvals, int16_t* out, unsigned count, int smoothratio);
+
+template<class T> struct TInterpolationHashTraits
+{
+	hash_t Hash(const T* key) { return (hash_t)(((uint64_t)(uintptr_t)key * 0x9E3779B97F4A7C15ull) >> 32); }
+	int Compare(const T* left, const T* right) { return left != right; }
+};
+
+template<class T> class TInterpolator
+{
+	TArray<T*> Pointers;
+	TArray<T> OldValues;
+	TArray<T> BackupValues;
+	TArray<T> Interpolated;
+	TMap<T*, unsigned, TInterpolationHashTraits<T>> Slots;
+
+public:
+	unsigned Size() const { return Pointers.Size(); }
+	T* GetPointer(unsigned i) const { return Pointers[i]; }
+	T GetOldValue(unsigned i) const { return OldValues[i]; }
+	T GetBackupValue(unsigned i) const { return BackupValues[i]; }
+
+	bool IsSet(T* posptr) const
+	{
+		return Slots.CheckKey(posptr) != nullptr;
+	}
+
+	// Returns false if the value was already registered.
+	bool Set(T* posptr)
+	{
+		return Add(posptr, *posptr, 0);
+	}
+
+	// Used by savegame code, which restores the previous value along with the pointer.
+	bool Add(T* posptr, T oldvalue, T backupvalue)
+	{
+		if (Slots.CheckKey(posptr))
+			return false;
+
+		Slots.Insert(posptr, Pointers.Push(posptr));
+		OldValues.Push(oldvalue);
+		BackupValues.Push(backupvalue);
+		return true;
+	}
+
+	void Stop(const T* posptr)
+	{
+		T* const key = const_cast<T*>(posptr);
+		auto slot = Slots.CheckKey(key);
+		if (!slot)
+			return;
+
+		unsigned const i = *slot;
+		unsigned const last = Pointers.Size() - 1;
+		Slots.Remove(key);
+
+		if (i != last)
+		{
+			Pointers[i] = Pointers[last];
+			OldValues[i] = OldValues[last];
+			BackupValues[i] = BackupValues[last];
+			Slots[Pointers[i]] = i;
+		}
+		Pointers.Pop();
+		OldValues.Pop();
+		BackupValues.Pop();
+	}
+
+	void Clear()
+	{
+		Pointers.Clear();
+		OldValues.Clear();
+		BackupValues.Clear();
+		Slots.Clear();
+	}
+
+	// Start of a game tic: the current values become the ones to interpolate from.
+	void Update()
+	{
+		unsigned const count = Pointers.Size();
+		for (unsigned i = 0; i < count; i++)
+			OldValues[i] = *Pointers[i];
+	}
+
+	void Backup()
+	{
+		unsigned const count = Pointers.Size();
+		for (unsigned i = 0; i < count; i++)
+			BackupValues[i] = *Pointers[i];
+	}
+
+	// Must be followed by Restore() before the game state is touched again.
+	void Do(int smoothratio)
+	{
+		unsigned const count = Pointers.Size();
+		Backup();
+		Interpolated.Resize(count);
+		InterpolateValues(OldValues.Data(), BackupValues.Data(), Interpolated.Data(), count, smoothratio);
+		for (unsigned i = 0; i < count; i++)
+			*Pointers[i] = Interpolated[i];
+	}
+
+	void Restore()
+	{
+		unsigned const count = Pointers.Size();
+		for (unsigned i = 0; i < count; i++)
+			*Pointers[i] = BackupValues[i];
+	}
+};
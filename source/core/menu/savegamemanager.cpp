@@ -52,6 +52,7 @@
 #include "build.h"
 #include "serializer.h"
 #include "findfile.h"
+#include "compositesaveame.h"
 
 
 FSavegameManager savegameManager;
@@ -78,7 +79,10 @@ void FSavegameManager::SaveGame(FSaveGameNode* node, bool ok4q, bool forceq)
 		{
 			FString fn = node->Filename;
 			FString desc = node->SaveTitle;
-			NotifyNewSave(fn, desc, ok4q, forceq);
+			OnSavegameWritten([=](bool ok)
+			{
+				if (ok) NotifyNewSave(fn, desc, ok4q, forceq);
+			});
 		}
 	}
 }
@@ -115,6 +119,7 @@ int FSavegameManager::RemoveSaveSlot(int index)
 	int listindex = SaveGames[0]->bNoDelete ? index - 1 : index;
 	if (listindex < 0) return index;
 
+	WaitForSavegameWrite();
 	remove(SaveGames[index]->Filename.GetChars());
 	UnloadSaveData();
 
@@ -182,6 +187,7 @@ void FSavegameManager::ReadSaveStrings()
 {
 	if (SaveGames.Size() == 0)
 	{
+		WaitForSavegameWrite();
 		void *filefirst;
 		findstate_t c_file;
 		FString filter;
@@ -365,6 +371,7 @@ unsigned FSavegameManager::ExtractSaveData(int index)
 	}
 
 	UnloadSaveData();
+	WaitForSavegameWrite();
 
 	if ((unsigned)index < SaveGames.Size() &&
 		(node = SaveGames[index]) &&
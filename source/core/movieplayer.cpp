@@ -0,0 +1,584 @@
+/*
+**
+** movieplayer.cpp
+** Threaded cutscene playback for ANM, SMK and IVF movies
+**
+**---------------------------------------------------------------------------
+** Copyright 2020 Raze contributors
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+*/
+
+#include "compat.h"
+#include "movieplayer.h"
+#include "animlib.h"
+#include "SmackerDecoder.h"
+#include "filesystem.h"
+#include "printf.h"
+#include "v_text.h"
+#ifdef _DEBUG
+#include "c_dispatch.h"
+#include "stats.h"
+#endif
+#ifdef USE_LIBVPX
+#include "animvpx.h"
+#endif
+
+//==========================================================================
+//
+// 8 bit frames are converted with a BGRA lookup table built from the palette.
+//
+//==========================================================================
+
+static void ConvertIndexedFrame(MovieFrame& frame, const uint8_t* pixels, const uint8_t* palette, int size)
+{
+	uint32_t colors[256];
+
+	for (int i = 0; i < 256; i++)
+	{
+		const uint8_t bgra[4] = { palette[i * 3 + 2], palette[i * 3 + 1], palette[i * 3], 255 };
+		memcpy(&colors[i], bgra, 4);
+	}
+
+	frame.Pixels.Resize(size * 4);
+	auto dest = (uint32_t*)frame.Pixels.Data();
+
+	for (int i = 0; i < size; i++)
+	{
+		dest[i] = colors[pixels[i]];
+	}
+}
+
+//==========================================================================
+//
+// ANM
+//
+// This goes through animlib's global state, so there can only be one of these at a time.
+//
+//==========================================================================
+
+class AnmMovieDecoder : public MovieDecoder
+{
+	TArray<uint8_t> Buffer;
+	int NumFrames = 0;
+	int FrameIndex = 1;
+	int FrameTime;
+	bool Loaded = false;
+
+public:
+	AnmMovieDecoder(TArray<uint8_t>& buffer, int frametime)
+	{
+		Buffer = std::move(buffer);
+		// same as Duke's default frame delay of 10 tics.
+		FrameTime = frametime > 0 ? frametime : 10 * 1000 / 120;
+	}
+
+	~AnmMovieDecoder()
+	{
+		if (Loaded) ANIM_FreeAnim();
+	}
+
+	bool Init()
+	{
+		Loaded = true;
+		if (ANIM_LoadAnim(Buffer.Data(), Buffer.Size() - 1) < 0 || (NumFrames = ANIM_NumFrames()) <= 0)
+		{
+			return false;
+		}
+		Width = 320;
+		Height = 200;
+		// frames are numbered from 1
+		FrameCount = NumFrames - 1;
+		return true;
+	}
+
+	const char* Format() const override
+	{
+		return "ANM";
+	}
+
+	// animlib keeps its decoder state in globals that the game thread also uses.
+	bool CanRunOnWorker() const override
+	{
+		return false;
+	}
+
+	bool NextFrame(MovieFrame& frame) override
+	{
+		if (FrameIndex >= NumFrames)
+			return false;
+
+		uint8_t* pixels = ANIM_DrawFrame(FrameIndex);
+		ConvertIndexedFrame(frame, pixels, ANIM_GetPalette(), Width * Height);
+		frame.Time = uint64_t(FrameIndex - 1) * FrameTime;
+		frame.Duration = FrameTime;
+		frame.Number = FrameIndex++;
+		return true;
+	}
+};
+
+//==========================================================================
+//
+// SMK
+//
+//==========================================================================
+
+class SmkMovieDecoder : public MovieDecoder
+{
+	SmackerHandle Handle;
+	TArray<uint8_t> Picture;
+	uint8_t Palette[768];
+	uint32_t NumFrames = 0;
+	uint32_t FrameIndex = 0;
+	float FrameRate = 0;
+
+public:
+	SmkMovieDecoder()
+	{
+		Handle.isValid = false;
+	}
+
+	~SmkMovieDecoder()
+	{
+		if (Handle.isValid) Smacker_Close(Handle);
+	}
+
+	bool Init(const char* filename)
+	{
+		Handle = Smacker_Open(filename);
+		if (!Handle.isValid || !Smacker_LoadIntoMemory(Handle))
+			return false;
+
+		uint32_t width, height;
+		Smacker_GetFrameSize(Handle, width, height);
+		Width = width;
+		Height = height;
+		NumFrames = FrameCount = Smacker_GetNumFrames(Handle);
+		FrameRate = Smacker_GetFrameRate(Handle);
+		if (!(FrameRate > 0))
+			return false;	// broken header, frame times cannot be computed.
+		Picture.Resize(Width * Height);
+		return true;
+	}
+
+	const char* Format() const override
+	{
+		return "SMK";
+	}
+
+	bool NextFrame(MovieFrame& frame) override
+	{
+		if (FrameIndex >= NumFrames)
+			return false;
+
+		Smacker_GetNextFrame(Handle);
+		Smacker_GetPalette(Handle, Palette);
+		Smacker_GetFrame(Handle, Picture.Data());
+		ConvertIndexedFrame(frame, Picture.Data(), Palette, Width * Height);
+		frame.Time = uint64_t(FrameIndex * 1000. / FrameRate);
+		frame.Duration = uint64_t((FrameIndex + 1) * 1000. / FrameRate) - frame.Time;
+		frame.Number = FrameIndex++;
+		return true;
+	}
+};
+
+//==========================================================================
+//
+// VP8 in IVF
+//
+//==========================================================================
+
+#ifdef USE_LIBVPX
+class VpxMovieDecoder : public MovieDecoder
+{
+	FileReader Reader;
+	animvpx_ivf_header_t Info;
+	animvpx_codec_ctx Codec;
+	bool Inited = false;
+	int FrameIndex = 0;
+
+public:
+	~VpxMovieDecoder()
+	{
+		if (Inited) animvpx_uninit_codec(&Codec);
+	}
+
+	bool Init(FileReader& fr)
+	{
+		// The decoder reads the file while playing, so it gets a copy in memory.
+		Reader.OpenMemoryArray([&](TArray<uint8_t>& buffer)
+		{
+			buffer = fr.Read();
+			return true;
+		});
+
+		int error = animvpx_read_ivf_header(Reader, &Info);
+		if (error)
+		{
+			Printf("Failed reading IVF file: %s\n", animvpx_read_ivf_header_errmsg[error]);
+			return false;
+		}
+
+		if (animvpx_init_codec(&Info, Reader, &Codec))
+		{
+			Printf("Error initializing VPX codec.\n");
+			return false;
+		}
+
+		Inited = true;
+		Width = Info.width;
+		Height = Info.height;
+		FrameCount = Info.numframes;
+		return true;
+	}
+
+	const char* Format() const override
+	{
+		return "IVF";
+	}
+
+	bool NextFrame(MovieFrame& frame) override
+	{
+		uint8_t* pic;
+		int error = animvpx_nextpic(&Codec, &pic);
+
+		if (error)
+		{
+			Error.Format("Failed getting next pic: %s\n", animvpx_nextpic_errmsg[error]);
+			if (Codec.errmsg)
+			{
+				Error.AppendFormat("  %s\n", Codec.errmsg);
+				if (Codec.errmsg_detail)
+					Error.AppendFormat("  detail: %s\n", Codec.errmsg_detail);
+			}
+			return false;
+		}
+		if (!pic)
+			return false;
+
+		// [Y U V 0] to BGRA
+		frame.Pixels.Resize(Width * Height * 4);
+		auto dpix = frame.Pixels.Data();
+
+		for (int i = 0; i < Width * Height; i++)
+		{
+			int p = i * 4;
+			float y = pic[p] * (1 / 255.f);
+			float u = pic[p + 1] * (1 / 255.f) - 0.5f;
+			float v = pic[p + 2] * (1 / 255.f) - 0.5f;
+
+			y = 1.1643f * (y - 0.0625f);
+
+			float r = y + 1.5958f * v;
+			float g = y - 0.39173f * u - 0.81290f * v;
+			float b = y + 2.017f * u;
+
+			dpix[p + 0] = (uint8_t)(clamp(b, 0, 1.f) * 255);
+			dpix[p + 1] = (uint8_t)(clamp(g, 0, 1.f) * 255);
+			dpix[p + 2] = (uint8_t)(clamp(r, 0, 1.f) * 255);
+			dpix[p + 3] = 255;
+		}
+
+		frame.Time = uint64_t(FrameIndex) * 1000 * Info.fpsdenom / Info.fpsnumer;
+		frame.Duration = uint64_t(FrameIndex + 1) * 1000 * Info.fpsdenom / Info.fpsnumer - frame.Time;
+		frame.Number = FrameIndex++;
+		return true;
+	}
+};
+#endif
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+MovieDecoder* OpenMovieDecoder(const char* filename, int frametime)
+{
+	auto fr = fileSystem.OpenFileReader(filename);
+	if (!fr.isOpen())
+	{
+		Printf("%s: file not found\n", filename);
+		return nullptr;
+	}
+
+	char id[20] = {};
+	fr.Read(id, sizeof(id));
+	fr.Seek(0, FileReader::SeekSet);
+
+	if (!memcmp(id, "LPF ", 4))
+	{
+		auto buffer = fr.ReadPadded(1);
+		auto decoder = new AnmMovieDecoder(buffer, frametime);
+		if (decoder->Init()) return decoder;
+		Printf("Error: malformed ANM file \"%s\".\n", filename);
+		delete decoder;
+	}
+	else if (!memcmp(id, "SMK2", 4) || !memcmp(id, "SMK4", 4))
+	{
+		fr.Close();
+		auto decoder = new SmkMovieDecoder;
+		if (decoder->Init(filename)) return decoder;
+		Printf("Error: malformed SMK file \"%s\".\n", filename);
+		delete decoder;
+	}
+	else if (!memcmp(id, "DKIF", 4))
+	{
+#ifdef USE_LIBVPX
+		auto decoder = new VpxMovieDecoder;
+		if (decoder->Init(fr)) return decoder;
+		delete decoder;
+#else
+		Printf("%s: VP8 support not compiled in\n", filename);
+#endif
+	}
+	else if (!memcmp(id, "Interplay MVE File\x1A\0", 20))
+	{
+		Printf("%s: MVE movies are not supported\n", filename);
+	}
+	else
+	{
+		Printf("%s: unknown movie format\n", filename);
+	}
+	return nullptr;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+MoviePlayer::MoviePlayer(MovieDecoder* decoder, int queuesize)
+{
+	Decoder = decoder;
+	Textures.SetSize(decoder->GetWidth(), decoder->GetHeight());
+	Queue.Resize(max(queuesize, 1));
+	if (decoder->CanRunOnWorker())
+		Worker = std::thread([this]() { Produce(); });
+}
+
+MoviePlayer::~MoviePlayer()
+{
+	{
+		std::lock_guard<std::mutex> lock(Mutex);
+		Stop = true;
+	}
+	Cond.notify_all();
+	if (Worker.joinable()) Worker.join();
+	delete Decoder;
+}
+
+void MoviePlayer::Produce()
+{
+	std::unique_lock<std::mutex> lock(Mutex);
+
+	while (!Stop)
+	{
+		if (QueueCount == Queue.Size())
+		{
+			Cond.wait(lock);
+			continue;
+		}
+
+		// The game thread only ever touches the queued slots.
+		unsigned slot = (QueueHead + QueueCount) % Queue.Size();
+
+		lock.unlock();
+		bool ok = Decoder->NextFrame(Queue[slot]);
+		lock.lock();
+
+		if (!ok)
+		{
+			Done = true;
+			Cond.notify_all();
+			break;
+		}
+
+		QueueCount++;
+		Cond.notify_all();
+	}
+}
+
+// Without a worker the frames are decoded on the calling thread, one at a time as they are needed.
+void MoviePlayer::DecodeOnCaller()
+{
+	if (Worker.joinable() || Done || QueueCount) return;
+
+	if (Decoder->NextFrame(Queue[QueueHead])) QueueCount++;
+	else Done = true;
+}
+
+// must be called with the mutex locked.
+void MoviePlayer::Present()
+{
+	std::swap(Current, Queue[QueueHead]);
+	QueueHead = (QueueHead + 1) % Queue.Size();
+	QueueCount--;
+	Cond.notify_all();
+}
+
+FGameTexture* MoviePlayer::GetFrameAt(uint64_t time)
+{
+	bool newframe = false;
+	{
+		std::lock_guard<std::mutex> lock(Mutex);
+		DecodeOnCaller();
+		while (QueueCount && Queue[QueueHead].Time <= time)
+		{
+			Present();
+			newframe = true;
+			DecodeOnCaller();
+		}
+	}
+
+	if (newframe)
+	{
+		Textures.SetFrameBgra(Current.Pixels.Data());
+		HaveFrame = true;
+	}
+	return HaveFrame ? Textures.GetFrame() : nullptr;
+}
+
+FGameTexture* MoviePlayer::NextFrame()
+{
+	{
+		std::unique_lock<std::mutex> lock(Mutex);
+		DecodeOnCaller();
+		while (!QueueCount && !Done)
+			Cond.wait(lock);
+
+		if (!QueueCount)
+		{
+			lock.unlock();
+			ReportError();
+			return nullptr;
+		}
+
+		Present();
+	}
+
+	Textures.SetFrameBgra(Current.Pixels.Data());
+	HaveFrame = true;
+	return Textures.GetFrame();
+}
+
+void MoviePlayer::WaitForFrame(uint64_t time, unsigned maxwait)
+{
+	uint64_t due;
+	{
+		std::lock_guard<std::mutex> lock(Mutex);
+		DecodeOnCaller();
+		if (QueueCount) due = Queue[QueueHead].Time;
+		else if (Done) due = Current.Time + Current.Duration;
+		else due = time + 1;	// the decoder is behind, check back soon.
+	}
+	if (due > time)
+		std::this_thread::sleep_for(std::chrono::milliseconds(min<uint64_t>(due - time, maxwait)));
+}
+
+bool MoviePlayer::Finished(uint64_t time)
+{
+	return Finished() && time >= Current.Time + Current.Duration;
+}
+
+bool MoviePlayer::Finished()
+{
+	bool finished;
+	{
+		std::lock_guard<std::mutex> lock(Mutex);
+		DecodeOnCaller();
+		finished = Done && !QueueCount;
+	}
+	if (finished) ReportError();
+	return finished;
+}
+
+// The decoder cannot print anything itself because it may run on the worker thread.
+// Once the worker is done the decoder is no longer being touched and its error can be read here.
+void MoviePlayer::ReportError()
+{
+	if (ErrorReported) return;
+	ErrorReported = true;
+	if (Decoder->GetError().IsNotEmpty())
+		Printf(TEXTCOLOR_RED "%s", Decoder->GetError().GetChars());
+}
+
+#ifdef _DEBUG
+//==========================================================================
+//
+// bench_movie
+//
+// Decodes a movie as fast as possible, once directly and once through
+// the player as the game would see it.
+//
+//==========================================================================
+
+CCMD(bench_movie)
+{
+	if (argv.argc() < 2)
+	{
+		Printf("Usage: bench_movie <file> [queue size]\n");
+		return;
+	}
+
+	int queuesize = argv.argc() > 2 ? max(1, (int)strtol(argv[2], nullptr, 10)) : 8;
+	auto decoder = OpenMovieDecoder(argv[1]);
+	if (!decoder) return;
+
+	FString format = decoder->Format();
+	int width = decoder->GetWidth(), height = decoder->GetHeight();
+	MovieFrame frame;
+	int frames = 0, playerframes = 0;
+	cycle_t decodetime, playertime;
+
+	decodetime.Reset();
+	decodetime.Clock();
+	while (decoder->NextFrame(frame))
+		frames++;
+	decodetime.Unclock();
+	delete decoder;
+
+	decoder = OpenMovieDecoder(argv[1]);
+	if (!decoder) return;
+
+	playertime.Reset();
+	playertime.Clock();
+	{
+		MoviePlayer player(decoder, queuesize);
+		while (player.NextFrame())
+			playerframes++;
+	}
+	playertime.Unclock();
+
+	Printf("bench_movie: %s, %s, %dx%d, %d frames\n", argv[1], format.GetChars(), width, height, frames);
+	Printf("  decoder:          %.3f ms, %.1f fps\n", decodetime.TimeMS(), decodetime.TimeMS() > 0 ? frames * 1000. / decodetime.TimeMS() : 0.);
+	Printf("  player, %d ahead: %.3f ms, %.1f fps\n", queuesize, playertime.TimeMS(), playertime.TimeMS() > 0 ? playerframes * 1000. / playertime.TimeMS() : 0.);
+	if (playerframes != frames)
+		Printf(TEXTCOLOR_RED "  player returned %d frames!\n", playerframes);
+}
+#endif
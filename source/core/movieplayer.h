@@ -0,0 +1,103 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "files.h"
+#include "tarray.h"
+#include "zstring.h"
+#include "animtexture.h"
+
+//==========================================================================
+//
+// Common interface for the cutscene formats
+//
+// A decoder produces frames that are already converted to BGRA, each with
+// the time in ms at which it should be shown. MoviePlayer runs the decoder
+// on a worker thread that keeps a small queue of frames filled, so that
+// the game thread only has to pick up the next frame and draw it.
+// Decoders that cannot leave the game thread are run there on demand.
+//
+//==========================================================================
+
+struct MovieFrame
+{
+	TArray<uint8_t> Pixels;		// Width * Height BGRA pixels
+	uint64_t Time = 0;			// presentation time in ms after the start
+	uint64_t Duration = 0;		// how long it stays on screen, in ms
+	int Number = 0;
+};
+
+class MovieDecoder
+{
+protected:
+	int Width = 0, Height = 0;
+	int FrameCount = 0;
+	FString Error;		// set instead of printing, see NextFrame
+
+public:
+	virtual ~MovieDecoder() = default;
+	virtual const char* Format() const = 0;
+
+	// Decodes the next frame into frame.Pixels and sets its time and duration. Returns false after the last frame.
+	// This is normally called from the player's worker thread, so it may not touch the file system or any other game state
+	// unless CanRunOnWorker returns false.
+	// Errors must be stored in Error, the player prints them on the game thread.
+	virtual bool NextFrame(MovieFrame& frame) = 0;
+
+	// Decoders that share state with the game thread return false here and get called from the game thread instead.
+	virtual bool CanRunOnWorker() const { return true; }
+
+	int GetWidth() const { return Width; }
+	int GetHeight() const { return Height; }
+	int GetFrameCount() const { return FrameCount; }
+	const FString& GetError() const { return Error; }
+};
+
+// Picks the decoder by the file's signature. frametime is the ms per frame for ANM files, which have no reliable frame rate of their own.
+MovieDecoder* OpenMovieDecoder(const char* filename, int frametime = 0);
+
+class MoviePlayer
+{
+	MovieDecoder* Decoder;
+	AnimTextures Textures;
+	bool HaveFrame = false;
+
+	std::thread Worker;
+	std::mutex Mutex;
+	std::condition_variable Cond;
+	TArray<MovieFrame> Queue;
+	unsigned QueueHead = 0, QueueCount = 0;
+	bool Stop = false, Done = false;
+	bool ErrorReported = false;
+	MovieFrame Current;
+
+	void Produce();
+	void DecodeOnCaller();
+	void Present();
+	void ReportError();
+
+public:
+	MoviePlayer(MovieDecoder* decoder, int queuesize = 8);
+	~MoviePlayer();
+
+	int GetWidth() const { return Decoder->GetWidth(); }
+	int GetHeight() const { return Decoder->GetHeight(); }
+	int GetFrameCount() const { return Decoder->GetFrameCount(); }
+	int GetFrameNumber() const { return Current.Number; }
+
+	// For playback paced by the movie's own timestamps: returns the last frame due at 'time' ms, skipping any that are already late.
+	// Never waits for the decoder, and returns nullptr if no frame has been shown yet.
+	FGameTexture* GetFrameAt(uint64_t time);
+
+	// For playback paced by the game: waits for the next frame, nullptr after the last one.
+	FGameTexture* NextFrame();
+
+	// For playback paced by GetFrameAt: sleeps until the next frame is due, but never longer than maxwait ms so that input stays responsive.
+	void WaitForFrame(uint64_t time, unsigned maxwait = 10);
+
+	// True once the decoder is done and every frame has been shown. The time based variant also waits out the last frame's duration.
+	bool Finished();
+	bool Finished(uint64_t time);
+};
+
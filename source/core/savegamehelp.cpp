@@ -91,6 +91,7 @@ static void SerializeSession(FSerializer& arc)
 
 bool OpenSaveGameForRead(const char *name)
 {
+	WaitForSavegameWrite();
 	if (savereader) delete savereader;
 	savereader = FResourceFile::OpenResourceFile(name, true, true);
 
@@ -150,8 +151,11 @@ FileReader ReadSavegameChunk(const char *name)
 	return lump->NewReader();
 }
 
+CVAR(Bool, save_background, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)	// compress and write savegames on a separate thread
+
 bool FinishSavegameWrite()
 {
+	if (save_background) return savewriter.WriteToFileInBackground();
 	return savewriter.WriteToFile();
 }
 
@@ -527,6 +531,7 @@ void LoadEngineState()
 		fr.Read(&numwalls, sizeof(numwalls));
 		fr.Read(wall, sizeof(walltype) * numwalls);
 		CheckMagic(fr);
+		sectorGridInvalidate();
 		fr.Read(sprite, sizeof(spritetype) * MAXSPRITES);
 		CheckMagic(fr);
 		fr.Read(headspritesect, sizeof(headspritesect));
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include "resourcefile.h"
 
 bool OpenSaveGameForWrite(const char *fname, const char *name);
@@ -11,6 +12,9 @@ FileReader ReadSavegameChunk(const char *name);
 bool FinishSavegameWrite();
 void FinishSavegameRead();
 
+// Savegames may be written in the background, so anything that tells the user about a save must wait for the write to finish.
+void OnSavegameWritten(std::function<void(bool)> done);
+
 // Savegame utilities
 class FileReader;
 
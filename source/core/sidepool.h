@@ -0,0 +1,72 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+//==========================================================================
+//
+// Fixed capacity storage for side records that belong to a sprite or a
+// sector and are created and destroyed along with it.
+//
+// Slot n always belongs to owner n, so the records lie in owner order in
+// one block instead of being scattered over the heap, a record's address
+// never changes while it is in use, and allocating or freeing one only
+// clears a slot.
+//
+//==========================================================================
+
+template<class T, int Capacity> class TSidePool
+{
+	T Slots[Capacity];
+	bool Used[Capacity];
+	int NumUsed = 0;
+	int HighWater = 0;		// most slots in use at the same time
+	int HighestSlot = -1;	// highest slot index handed out
+	unsigned Allocations = 0;
+
+public:
+	// Returns a zeroed record for the given owner. If the owner already has
+	// one, that record is reset and handed out again.
+	T* Alloc(int index)
+	{
+		assert(index >= 0 && index < Capacity);
+		if (!Used[index])
+		{
+			Used[index] = true;
+			if (++NumUsed > HighWater) HighWater = NumUsed;
+			if (index > HighestSlot) HighestSlot = index;
+		}
+		Allocations++;
+		memset(&Slots[index], 0, sizeof(T));
+		return &Slots[index];
+	}
+
+	void Free(T* rec)
+	{
+		if (rec == nullptr)
+			return;
+
+		assert(Owns(rec));
+		int const index = int(rec - Slots);
+		if (Used[index])
+		{
+			Used[index] = false;
+			NumUsed--;
+		}
+	}
+
+	// For code that drops all owner pointers at once without freeing them one by one.
+	void Clear()
+	{
+		memset(Used, 0, sizeof(Used));
+		NumUsed = 0;
+	}
+
+	bool Owns(const T* rec) const { return rec >= Slots && rec < Slots + Capacity; }
+	int GetCapacity() const { return Capacity; }
+	int GetNumUsed() const { return NumUsed; }
+	int GetHighWater() const { return HighWater; }
+	int GetHighestSlot() const { return HighestSlot; }
+	unsigned GetAllocations() const { return Allocations; }
+};
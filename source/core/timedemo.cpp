@@ -0,0 +1,267 @@
+/*
+** timedemo.cpp
+**
+** Collects per-tic and per-frame times and writes percentiles to a file
+** so that performance can be compared between builds without a human
+** reading the console.
+**
+**   -timedemo <demo>          plays the demo, writes the report and quits.
+**   -timedemoreport <file>    where the report goes, timedemo.json by default.
+**                             .csv files get CSV, everything else JSON.
+**   -timedemotics <count>     stops after that many game tics instead of at the end of the demo.
+**
+** Starting and stopping playback is up to the game frontends: they look at
+** TIMEDEMO_GetDemo() and call TIMEDEMO_DemoEnded() when the demo runs out.
+** Duke's and RR's demo profiling also collects its times here.
+**
+** Sound and music are disabled while timing. -nosound puts the sound
+** system on its null backend, so no audio device is needed.
+**
+** There is no null video backend yet, so a timedemo still needs a window
+** and a working renderer. Until one exists, CI machines without a display
+** have to provide a virtual one. Adding that backend is a separate change:
+** it has to stub out the framebuffer and the hardware renderer interfaces
+** for all platforms, which has nothing to do with collecting the times.
+**
+*/
+
+#include <algorithm>
+#include "timedemo.h"
+#include "m_argv.h"
+#include "files.h"
+#include "printf.h"
+#include "stats.h"
+#include "tarray.h"
+#include "zstring.h"
+#include "engineerrors.h"
+#include "mapinfo.h"
+#include "gamecontrol.h"
+
+bool timedemoActive;
+
+static FString timedemoDemo;
+static FString timedemoFile;
+static int timedemoMaxTics;
+static cycle_t sectionTime[TDS_Count];
+static TArray<float> samples[TDS_Count];
+static bool frameHasScene;
+
+static const char* const sectionNames[TDS_Count] = { "game", "drawrooms", "drawmasks", "2d" };
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void TIMEDEMO_Init()
+{
+	const char* demo = Args->CheckValue("-timedemo");
+	if (demo == nullptr) return;
+
+	timedemoDemo = demo;
+	const char* report = Args->CheckValue("-timedemoreport");
+	timedemoFile = report ? report : "timedemo.json";
+
+	const char* tics = Args->CheckValue("-timedemotics");
+	if (tics) timedemoMaxTics = (int)strtol(tics, nullptr, 10);
+
+	// Audio output only adds noise to the measurements.
+	Args->AppendArg("-nosound");
+
+	TIMEDEMO_Start();
+}
+
+//==========================================================================
+//
+// The demo the frontend has to play, or null if there's no timedemo.
+//
+//==========================================================================
+
+const char* TIMEDEMO_GetDemo()
+{
+	return timedemoDemo.IsNotEmpty() ? timedemoDemo.GetChars() : nullptr;
+}
+
+//==========================================================================
+//
+// Throws away everything collected so far, e.g. the frames it took
+// to get the demo going.
+//
+//==========================================================================
+
+void TIMEDEMO_Start()
+{
+	for (auto& s : samples) s.Clear();
+	for (auto& t : sectionTime) t.Reset();
+	frameHasScene = false;
+	timedemoActive = true;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void TIMEDEMO_Begin(int section)
+{
+	if (!timedemoActive) return;
+	sectionTime[section].Clock();
+}
+
+void TIMEDEMO_End(int section)
+{
+	if (!timedemoActive) return;
+	sectionTime[section].Unclock();
+
+	if (section == TDS_Game)
+	{
+		// Game time is taken per tic, everything else per frame.
+		samples[TDS_Game].Push((float)sectionTime[TDS_Game].TimeMS());
+		sectionTime[TDS_Game].Reset();
+	}
+	else if (section != TDS_2D)
+	{
+		frameHasScene = true;
+	}
+}
+
+//==========================================================================
+//
+// Called once the frame has been presented.
+//
+//==========================================================================
+
+void TIMEDEMO_EndFrame()
+{
+	if (!timedemoActive) return;
+
+	// Frames without a 3D view are menus, loading screens and such and would only skew the results.
+	if (frameHasScene)
+	{
+		for (int i = TDS_DrawRooms; i < TDS_Count; i++)
+		{
+			samples[i].Push((float)sectionTime[i].TimeMS());
+		}
+	}
+	for (int i = TDS_DrawRooms; i < TDS_Count; i++) sectionTime[i].Reset();
+	frameHasScene = false;
+
+	if (timedemoMaxTics > 0 && (int)samples[TDS_Game].Size() >= timedemoMaxTics)
+	{
+		TIMEDEMO_DemoEnded();
+	}
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+struct TimeDemoStats
+{
+	unsigned count;
+	double mean, p50, p90, p95, p99, max;
+};
+
+static TimeDemoStats CalcStats(TArray<float>& values)
+{
+	TimeDemoStats st = {};
+	st.count = values.Size();
+	if (st.count == 0) return st;
+
+	std::sort(values.begin(), values.end());
+	double sum = 0;
+	for (auto v : values) sum += v;
+
+	auto percentile = [&](double p) { return (double)values[std::min<unsigned>(st.count - 1, unsigned(p * st.count))]; };
+	st.mean = sum / st.count;
+	st.p50 = percentile(0.5);
+	st.p90 = percentile(0.9);
+	st.p95 = percentile(0.95);
+	st.p99 = percentile(0.99);
+	st.max = values.Last();
+	return st;
+}
+
+// Game and map names come from the user, so they must be escaped for JSON.
+static FString JsonString(const char* str)
+{
+	FString result;
+	for (; *str; str++)
+	{
+		uint8_t c = (uint8_t)*str;
+		if (c == '"' || c == '\\') result.AppendFormat("\\%c", c);
+		else if (c < 0x20) result.AppendFormat("\\u%04x", c);
+		else result += (char)c;
+	}
+	return result;
+}
+
+void TIMEDEMO_Finish()
+{
+	if (!timedemoActive) return;
+	timedemoActive = false;
+
+	TimeDemoStats stats[TDS_Count];
+	for (int i = 0; i < TDS_Count; i++) stats[i] = CalcStats(samples[i]);
+
+	Printf("Timedemo: %u game tics, %u frames\n", stats[TDS_Game].count, stats[TDS_DrawRooms].count);
+	for (int i = 0; i < TDS_Count; i++)
+	{
+		auto& st = stats[i];
+		Printf("  %-10s mean %.3f ms, p50 %.3f ms, p99 %.3f ms, max %.3f ms\n", sectionNames[i], st.mean, st.p50, st.p99, st.max);
+	}
+
+	// Profiling started from the console only goes there.
+	if (timedemoFile.IsEmpty()) return;
+
+	auto fw = FileWriter::Open(timedemoFile);
+	if (fw == nullptr)
+	{
+		Printf("Unable to write timedemo results to %s\n", timedemoFile.GetChars());
+		return;
+	}
+
+	const char* map = currentLevel ? currentLevel->fileName.GetChars() : "";
+	bool csv = timedemoFile.Len() > 4 && !timedemoFile.Right(4).CompareNoCase(".csv");
+
+	if (csv)
+	{
+		fw->Printf("game,map,section,count,mean,p50,p90,p95,p99,max\n");
+		for (int i = 0; i < TDS_Count; i++)
+		{
+			auto& st = stats[i];
+			fw->Printf("%s,%s,%s,%u,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f\n", LumpFilter.GetChars(), map, sectionNames[i],
+				st.count, st.mean, st.p50, st.p90, st.p95, st.p99, st.max);
+		}
+	}
+	else
+	{
+		fw->Printf("{\n\t\"game\": \"%s\",\n\t\"map\": \"%s\",\n\t\"tics\": %u,\n\t\"frames\": %u,\n\t\"sections\": {\n",
+			JsonString(LumpFilter).GetChars(), JsonString(map).GetChars(), stats[TDS_Game].count, stats[TDS_DrawRooms].count);
+		for (int i = 0; i < TDS_Count; i++)
+		{
+			auto& st = stats[i];
+			fw->Printf("\t\t\"%s\": { \"count\": %u, \"mean\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f }%s\n",
+				sectionNames[i], st.count, st.mean, st.p50, st.p90, st.p95, st.p99, st.max, i < TDS_Count - 1 ? "," : "");
+		}
+		fw->Printf("\t}\n}\n");
+	}
+	delete fw;
+	Printf("Timedemo results written to %s\n", timedemoFile.GetChars());
+}
+
+//==========================================================================
+//
+// Called by the frontends when the demo given with -timedemo is over.
+//
+//==========================================================================
+
+void TIMEDEMO_DemoEnded()
+{
+	TIMEDEMO_Finish();
+	throw CExitEvent(0);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+// Frame time measurement for benchmarking. '-timedemo <demo>' plays the given demo with the game's
+// own demo playback and quits once it is over. The game frontends mark their game tics, the engine marks
+// scene and 2D drawing, and the collected times get written to the file given with '-timedemoreport'
+// (timedemo.json by default) as JSON, or as CSV if its extension is .csv.
+
+enum ETimeDemoSection
+{
+	TDS_Game,		// one game tic
+	TDS_DrawRooms,	// all renderDrawRooms calls of a frame
+	TDS_DrawMasks,	// all renderDrawMasks calls of a frame
+	TDS_2D,			// 2D overlays and presenting the frame
+
+	TDS_Count
+};
+
+extern bool timedemoActive;
+
+void TIMEDEMO_Init();
+const char* TIMEDEMO_GetDemo();
+void TIMEDEMO_Start();
+void TIMEDEMO_Begin(int section);
+void TIMEDEMO_End(int section);
+void TIMEDEMO_EndFrame();
+void TIMEDEMO_Finish();
+[[noreturn]] void TIMEDEMO_DemoEnded();
+
+// Times the enclosing scope.
+class FTimeDemoSection
+{
+	int section;
+
+public:
+	FTimeDemoSection(int sect)
+	{
+		section = timedemoActive ? sect : -1;
+		if (section >= 0) TIMEDEMO_Begin(section);
+	}
+	~FTimeDemoSection()
+	{
+		if (section >= 0) TIMEDEMO_End(section);
+	}
+};
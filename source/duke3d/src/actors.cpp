@@ -50,29 +50,16 @@ int32_t otherp;
 
 int G_SetInterpolation(int32_t *const posptr)
 {
-    if (g_interpolationCnt >= MAXINTERPOLATIONS)
+    if (g_interpolations.Size() >= MAXINTERPOLATIONS)
         return 1;
 
-    for (bssize_t i = 0; i < g_interpolationCnt; ++i)
-        if (curipos[i] == posptr)
-            return 0;
-
-    curipos[g_interpolationCnt] = posptr;
-    oldipos[g_interpolationCnt] = *posptr;
-    g_interpolationCnt++;
+    g_interpolations.Set(posptr);
     return 0;
 }
 
 void G_StopInterpolation(const int32_t * const posptr)
 {
-    for (bssize_t i = 0; i < g_interpolationCnt; ++i)
-        if (curipos[i] == posptr)
-        {
-            g_interpolationCnt--;
-            oldipos[i] = oldipos[g_interpolationCnt];
-            bakipos[i] = bakipos[g_interpolationCnt];
-            curipos[i] = curipos[g_interpolationCnt];
-        }
+    g_interpolations.Stop(posptr);
 }
 
 void G_DoInterpolations(int smoothRatio)
@@ -80,17 +67,7 @@ void G_DoInterpolations(int smoothRatio)
     if (g_interpolationLock++)
         return;
 
-    int32_t ndelta = 0;
-
-    for (bssize_t i = 0, j = 0; i < g_interpolationCnt; ++i)
-    {
-        int32_t const odelta = ndelta;
-        bakipos[i] = *curipos[i];
-        ndelta = (*curipos[i]) - oldipos[i];
-        if (odelta != ndelta)
-            j = mulscale16(ndelta, smoothRatio);
-        *curipos[i] = oldipos[i] + j;
-    }
+    g_interpolations.Do(smoothRatio);
 }
 
 void G_ClearCameraView(DukePlayer_t *ps)
@@ -905,6 +882,7 @@ void A_MoveSector(int spriteNum)
 
     int const endWall = sector[pSprite->sectnum].wallptr + sector[pSprite->sectnum].wallnum;
 
+    sectorGridBeginUpdate();
     for (bssize_t wallNum = sector[pSprite->sectnum].wallptr; wallNum < endWall; wallNum++)
     {
         vec2_t const origin = g_origins[originIdx];
@@ -914,6 +892,7 @@ void A_MoveSector(int spriteNum)
 
         originIdx++;
     }
+    sectorGridEndUpdate();
 }
 
 #if !defined LUNATIC
@@ -38,6 +38,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #ifdef USE_LIBVPX
 # include "animvpx.h"
+# include "movieplayer.h"
 #endif
 
 BEGIN_DUKE_NS
@@ -243,6 +244,7 @@ int32_t Anim_Play(const char *fn)
 
         dukeanim_t const* origanim = anim;
         FileReader handle;
+        FString vpxname = fn;
         if (!Bstrcmp(dot, ".ivf"))
         {
             handle = fileSystem.OpenFileReader(fn);
@@ -269,6 +271,7 @@ int32_t Anim_Play(const char *fn)
                 break;
 
             anim = Anim_Find(vpxfn);
+            vpxname = vpxfn;
         }
 
         animvpx_ivf_header_t info;
@@ -279,124 +282,93 @@ int32_t Anim_Play(const char *fn)
             Printf("Failed reading IVF file: %s\n", animvpx_read_ivf_header_errmsg[i]);
             return 0;
         }
+        handle.Close();
 
-        if (anim)
-            animvpx_setup_glstate(anim->frameflags);
-        else
-            animvpx_setup_glstate(origanim->frameflags);
+        // The frames are decoded and converted on the player's thread.
+        auto decoder = OpenMovieDecoder(vpxname);
+        if (!decoder)
+            return 0;
 
-        animvpx_codec_ctx codec;
+        MoviePlayer player(decoder);
 
-        if (animvpx_init_codec(&info, handle, &codec))
-        {
-            Printf("Error initializing VPX codec.\n");
-            animvpx_restore_glstate();
-            return 0;
-        }
+        dukeanim_t const* const playanim = anim ? anim : origanim;
+        double const aspect = (playanim->frameaspect1 == 0 || playanim->frameaspect2 == 0) ? 0 : playanim->frameaspect1 / playanim->frameaspect2;
 
+        animvpx_setup_glstate(playanim->frameflags);
 
         uint32_t const convnumer = 120 * info.fpsdenom;
         uint32_t const convdenom = info.fpsnumer * origanim->framedelay;
 
-        uint32_t const msecsperframe = scale(info.fpsdenom, 1000, info.fpsnumer);
-        uint32_t nextframetime = timerGetTicks();
-        uint8_t* pic;
-
-        //        Printf("msecs per frame: %d\n", msecsperframe);
+        uint32_t const starttime = timerGetTicks();
+        int shownframe = -1;
 
         do
         {
-            nextframetime += msecsperframe;
+            uint64_t const time = timerGetTicks() - starttime;
+            auto tex = player.GetFrameAt(time);
 
-            i = animvpx_nextpic(&codec, &pic);
-            if (i)
+            if (!tex || player.GetFrameNumber() == shownframe)
             {
-                Printf("Failed getting next pic: %s\n", animvpx_nextpic_errmsg[i]);
-                if (codec.errmsg)
-                {
-                    Printf("  %s\n", codec.errmsg);
-                    if (codec.errmsg_detail)
-                        Printf("  detail: %s\n", codec.errmsg_detail);
-                }
-                break;
+                player.WaitForFrame(time);
             }
+            else
+            {
+                shownframe = player.GetFrameNumber();
+                framenum = shownframe;
 
-            if (!pic)
-                break;  // no more pics!
-
-            VM_OnEventWithReturn(EVENT_PRECUTSCENE, g_player[screenpeek].ps->i, screenpeek, framenum);
+                VM_OnEventWithReturn(EVENT_PRECUTSCENE, g_player[screenpeek].ps->i, screenpeek, framenum);
 
-            twod->ClearScreen();
+                twod->ClearScreen();
 
-            ototalclock = totalclock + 1; // pause game like ANMs
+                ototalclock = totalclock + 1; // pause game like ANMs
 
-            if (anim)
-            {
-                if (anim->frameaspect1 == 0 || anim->frameaspect2 == 0)
-                    animvpx_render_frame(&codec, 0);
-                else
-                    animvpx_render_frame(&codec, anim->frameaspect1 / anim->frameaspect2);
-            }
-            else
-            {
-                if (origanim->frameaspect1 == 0 || origanim->frameaspect2 == 0)
-                    animvpx_render_frame(&codec, 0);
-                else
-                    animvpx_render_frame(&codec, origanim->frameaspect1 / origanim->frameaspect2);
-            }
+                animvpx_render_texture(tex, player.GetWidth(), player.GetHeight(), aspect);
 
-            VM_OnEventWithReturn(EVENT_CUTSCENE, g_player[screenpeek].ps->i, screenpeek, framenum);
+                VM_OnEventWithReturn(EVENT_CUTSCENE, g_player[screenpeek].ps->i, screenpeek, framenum);
 
-            // after rendering the frame but before displaying: maybe play sound...
-            framenum++;
-            if (anim)
-            {
-                while (soundidx < anim->Sounds.Size() && anim->Sounds[soundidx].frame <= framenum)
+                // after rendering the frame but before displaying: maybe play sound...
+                framenum++;
+                if (anim)
                 {
-                    int16_t sound = anim->Sounds[soundidx].sound;
-                    if (sound == -1)
-                        FX_StopAllSounds();
-                    else
-                        S_PlaySound(sound, CHAN_AUTO, CHANF_UI);
-
-                    soundidx++;
+                    while (soundidx < anim->Sounds.Size() && anim->Sounds[soundidx].frame <= framenum)
+                    {
+                        int16_t sound = anim->Sounds[soundidx].sound;
+                        if (sound == -1)
+                            FX_StopAllSounds();
+                        else
+                            S_PlaySound(sound, CHAN_AUTO, CHANF_UI);
+
+                        soundidx++;
+                    }
                 }
-            }
-            else
-            {
-                uint16_t convframenum = scale(framenum, convnumer, convdenom);
-                while (soundidx < origanim->Sounds.Size() && origanim->Sounds[soundidx].frame <= convframenum)
+                else
                 {
-                    int16_t sound = origanim->Sounds[soundidx].sound;
-                    if (sound == -1)
-                        FX_StopAllSounds();
-                    else
-                        S_PlaySound(sound, CHAN_AUTO, CHANF_UI);
-
-                    soundidx++;
+                    uint16_t convframenum = scale(framenum, convnumer, convdenom);
+                    while (soundidx < origanim->Sounds.Size() && origanim->Sounds[soundidx].frame <= convframenum)
+                    {
+                        int16_t sound = origanim->Sounds[soundidx].sound;
+                        if (sound == -1)
+                            FX_StopAllSounds();
+                        else
+                            S_PlaySound(sound, CHAN_AUTO, CHANF_UI);
+
+                        soundidx++;
+                    }
                 }
+
+                videoNextPage();
             }
 
-            videoNextPage();
+            gameHandleEvents();
 
-            do
+            if (VM_OnEventWithReturn(EVENT_SKIPCUTSCENE, g_player[screenpeek].ps->i, screenpeek, inputState.CheckAllInput()))
             {
-                gameHandleEvents();
-
-                if (VM_OnEventWithReturn(EVENT_SKIPCUTSCENE, g_player[screenpeek].ps->i, screenpeek, inputState.CheckAllInput()))
-                {
-                    running = 0;
-                    break;
-                }
-            } while (timerGetTicks() < nextframetime);
-        } while (running);
-#ifdef DEBUGGINGAIDS
-        animvpx_print_stats(&codec);
-#endif
+                running = 0;
+                break;
+            }
+        } while (!player.Finished(timerGetTicks() - starttime));
 
-        //
         animvpx_restore_glstate();
-        animvpx_uninit_codec(&codec);
 
         return !running;  // done with playing VP8!
     }
@@ -28,6 +28,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "baselayer.h"
 #include "cmdline.h"
 #include "m_argv.h"
+#include "timedemo.h"
 #include "printf.h"
 #include "c_dispatch.h"
 
@@ -40,35 +41,29 @@ static void G_AddDemo(const char* param)
 {
     Bstrncpy(tempbuf, param, sizeof(tempbuf));
     char * colon = (char *) Bstrchr(tempbuf, ':');
-    int32_t framespertic=-1, numrepeats=1;
+    int32_t framespertic=1;
 
     if (colon && colon != tempbuf)
     {
-        // -d<filename>:<num>[,<num>]
+        // -timedemo <filename>:<num>
         // profiling options
         *(colon++) = 0;
-        sscanf(colon, "%d,%d", &framespertic, &numrepeats);
+        sscanf(colon, "%d", &framespertic);
     }
 
     Demo_SetFirst(tempbuf);
 
-    if (framespertic < 0)
-    {
-        Printf("Play demo %s.\n", g_firstDemoFile);
-    }
-    else
-    {
-        framespertic = clamp(framespertic, 0, 8)+1;
-        // TODO: repeat count and gathering statistics.
-        Printf("Profile demo %s, %d frames/gametic, repeated 1x.\n", g_firstDemoFile,
-            framespertic-1);
-        Demo_PlayFirst(framespertic, 1);
-        g_noLogo = 1;
-    }
+    framespertic = clamp(framespertic, 0, 8)+1;
+    Printf("Profile demo %s, %d frames/gametic.\n", g_firstDemoFile,
+        framespertic-1);
+    Demo_PlayFirst(framespertic, 1);
+    g_noLogo = 1;
 }
 
 void G_CheckCommandLine()
 {
+	auto demo = TIMEDEMO_GetDemo();
+	if (demo) G_AddDemo(demo);
 	if (Args->CheckParm("-condebug") || Args->CheckParm("-z")) g_scriptDebug = 1;
 	if (Args->CheckParm("-altai"))
 	{
@@ -28,6 +28,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "menus.h"
 #include "savegame.h"
 #include "screens.h"
+#include "timedemo.h"
 #include "printf.h"
 #include "menu/menu.h"
 
@@ -201,10 +202,11 @@ error_wopen_demo:
 
 // demo_profile: < 0: prepare
 static int32_t g_demo_playFirstFlag, g_demo_profile, g_demo_stopProfile;
-static int32_t g_demo_exitAfter;
+static int32_t g_demo_exitAfter, g_demo_requested;
 void Demo_PlayFirst(int32_t prof, int32_t exitafter)
 {
     g_demo_playFirstFlag = 1;
+    g_demo_requested = 1;
     g_demo_exitAfter = exitafter;
     Bassert(prof >= 0);
     g_demo_profile = -prof;  // prepare
@@ -332,12 +334,7 @@ static int32_t Demo_ReadSync(int32_t errcode)
 }
 
 ////////// DEMO PROFILING (TIMEDEMO MODE) //////////
-static struct {
-    int32_t numtics, numframes;
-    double totalgamems;
-    double totalroomsdrawms, totalrestdrawms;
-    double starthiticks;
-} g_prof;
+// The times are collected by the core timedemo code, see timedemo.cpp.
 
 int32_t Demo_IsProfiling(void)
 {
@@ -349,19 +346,6 @@ static void Demo_StopProfiling(void)
     g_demo_stopProfile = 1;
 }
 
-static void Demo_GToc(double t)
-{
-    g_prof.numtics++;
-    g_prof.totalgamems += timerGetHiTicks()-t;
-}
-
-static void Demo_RToc(double t1, double t2)
-{
-    g_prof.numframes++;
-    g_prof.totalroomsdrawms += t2-t1;
-    g_prof.totalrestdrawms += timerGetHiTicks()-t2;
-}
-
 static void Demo_DisplayProfStatus(void)
 {
     char buf[64];
@@ -387,45 +371,15 @@ static void Demo_SetupProfile(void)
     g_demo_soundToggle = nosound;
 	nosound = true;  // restored by Demo_FinishProfile()
 
-    Bmemset(&g_prof, 0, sizeof(g_prof));
-
-    g_prof.starthiticks = timerGetHiTicks();
+    TIMEDEMO_Start();
 }
 
 static void Demo_FinishProfile(void)
 {
     if (Demo_IsProfiling())
     {
-        int32_t dn=g_whichDemo-1;
-        int32_t nt=g_prof.numtics, nf=g_prof.numframes;
-        double gms=g_prof.totalgamems;
-        double dms1=g_prof.totalroomsdrawms, dms2=g_prof.totalrestdrawms;
-
 		nosound = g_demo_soundToggle;
-
-        if (nt > 0)
-        {
-            Printf("== demo %d: %d gametics\n", dn, nt);
-            Printf("== demo %d game times: %.03f ms (%.03f us/gametic)\n",
-                       dn, gms, (gms*1000.0)/nt);
-        }
-
-        if (nf > 0)
-        {
-            Printf("== demo %d: %d frames (%d frames/gametic)\n", dn, nf, g_demo_profile-1);
-            Printf("== demo %d drawrooms times: %.03f s (%.03f ms/frame)\n",
-                       dn, dms1/1000.0, dms1/nf);
-            Printf("== demo %d drawrest times: %.03f s (%.03f ms/frame)\n",
-                       dn, dms2/1000.0, dms2/nf);
-        }
-
-        {
-            double totalprofms = gms+dms1+dms2;
-            double totalms = timerGetHiTicks()-g_prof.starthiticks;
-            if (totalprofms != 0)
-                Printf("== demo %d: non-profiled time overhead: %.02f %%\n",
-                           dn, 100.0*totalms/totalprofms - 100.0);
-        }
+        TIMEDEMO_Finish();
     }
 
     g_demo_profile = 0;
@@ -454,7 +408,7 @@ RECHECK:
     if (g_demo_playFirstFlag)
         g_demo_playFirstFlag = 0;
     else if (g_demo_exitAfter)
-        G_GameExit(" ");
+        TIMEDEMO_DemoEnded();
 
 #if KRANDDEBUG
     if (foundemo)
@@ -471,7 +425,15 @@ RECHECK:
 #ifdef PLAYDEMOLOOP	// Todo: Make a CVar.
 	if (!g_netServer && ud.multimode < 2)
 		foundemo = G_OpenDemoRead(g_whichDemo);
+#else
+	// Without the attract loop only demos requested with Demo_PlayFirst get played.
+	if (g_demo_requested && !g_netServer && ud.multimode < 2)
+		foundemo = G_OpenDemoRead(g_whichDemo);
 #endif
+	g_demo_requested = 0;
+
+	if (foundemo == 0 && g_demo_exitAfter)
+		I_FatalError("Unable to play demo %s", g_firstDemoFile);
 
     if (foundemo == 0)
     {
@@ -690,9 +652,7 @@ nextdemo_nomenu:
 
                 if (Demo_IsProfiling())
                 {
-                    double t = timerGetHiTicks();
                     G_DoMoveThings();
-                    Demo_GToc(t);
                 }
                 else if (!g_demo_paused)
                 {
@@ -762,8 +722,6 @@ nextdemo_nomenu:
 
                     for (i=0; i<num; i++)
                     {
-                        double t1 = timerGetHiTicks(), t2;
-
                         //                    Printf("t=%d, o=%d, t-o = %d\n", totalclock,
                         //                               ototalclock, totalclock-ototalclock);
 
@@ -774,12 +732,10 @@ nextdemo_nomenu:
                         totalclock = ototalclock + (j>>16);
 
                         G_DrawRooms(screenpeek, j);
-
-                        t2 = timerGetHiTicks();
-
                         G_DisplayRest(j);
 
-                        Demo_RToc(t1, t2);
+                        // Each of these frames counts, the one showing the status below does not.
+                        TIMEDEMO_EndFrame();
                     }
 
                     totalclock = ototalclock+4;
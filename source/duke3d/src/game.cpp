@@ -42,6 +42,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "cmdline.h"
 #include "palette.h"
 #include "gamecvars.h"
+#include "timedemo.h"
 #include "gameconfigfile.h"
 #include "printf.h"
 #include "m_argv.h"
@@ -6016,6 +6017,7 @@ MAIN_LOOP_RESTART:
 
 int G_DoMoveThings(void)
 {
+    FTimeDemoSection timedemo(TDS_Game);
     ud.camerasprite = -1;
     lockclock += TICSPERFRAME;
 
@@ -6167,6 +6169,12 @@ int G_DoMoveThings(void)
             {
                 Net_StoreClientState();
             }
+#ifdef _DEBUG
+            else
+            {
+                Net_BenchmarkMapUpdate();
+            }
+#endif
         }
     }
 
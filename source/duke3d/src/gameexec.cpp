@@ -1339,8 +1339,15 @@ static void ResizeArray(int const arrayNum, int const newSize)
 }
 
 #if !defined LUNATIC
-#if defined __GNUC__ || defined __clang__
-// # define CON_USE_COMPUTED_GOTO does not work anymore with some of the changes.
+// Threaded dispatch: every instruction jumps straight to the handler of the next one
+// through a label table, instead of going back through the loop condition and the switch.
+// dispatch() performs the same depth and VM_RETURN/VM_KILL/VM_NOEXECUTE checks as the
+// loop condition below, so both variants are meant to execute scripts identically.
+// This was switched off because it did not work anymore with some of the changes, and the
+// full games have not been played through with it since, so it stays opt-in: build with
+// CON_ENABLE_COMPUTED_GOTO to use it.
+#if (defined __GNUC__ || defined __clang__) && defined CON_ENABLE_COMPUTED_GOTO
+# define CON_USE_COMPUTED_GOTO
 #endif
 
 #ifdef CON_USE_COMPUTED_GOTO
@@ -1349,7 +1356,6 @@ static void ResizeArray(int const arrayNum, int const newSize)
 # define eval(INSTRUCTION) { goto *jumpTable[min<uint16_t>(INSTRUCTION, CON_OPCODE_END)]; }
 # define dispatch_unconditionally(...) { g_tw = tw = *insptr; eval((VM_DECODE_INST(tw))) }
 # define dispatch(...) { if (!vm_execution_depth || vm.flags & (VM_RETURN|VM_KILL|VM_NOEXECUTE)) return; dispatch_unconditionally(__VA_ARGS__); }
-# define abort_after_error(...) return
 # define vInstructionPointer(KEYWORDID) &&VINST_ ## KEYWORDID
 # define COMMA ,
 # define JUMP_TABLE_ARRAY_LITERAL { TRANSFORM_SCRIPT_KEYWORDS_LIST(vInstructionPointer, COMMA) }
@@ -1359,9 +1365,13 @@ static void ResizeArray(int const arrayNum, int const newSize)
 # define dispatch_unconditionally(...) continue
 # define dispatch(...) continue
 # define eval(INSTRUCTION) switch(INSTRUCTION)
-# define abort_after_error(...) continue // non-threaded dispatch handles this in the loop condition in VM_Execute()
 #endif
 
+// Errors leave VM_Execute directly in both variants. A continue would only get back to the
+// loop condition if the error was raised at the top level of a handler; inside a loop of the
+// handler itself it resumed that loop instead.
+#define abort_after_error(...) return
+
 #if defined _MSC_VER
 #define VM_ASSERT(condition, fmt, ...)           \
     do                                           \
@@ -2409,6 +2419,9 @@ GAMEEXEC_STATIC void VM_Execute(int const loop /*= false*/)
 
                     VM_SetStruct(wallLabel.flags, (intptr_t *)((char *)&wall[wallNum] + wallLabel.offset), newValue);
 
+                    if (labelNum == WALL_X || labelNum == WALL_Y)
+                        sectorGridUpdateSector(sectorofwall(wallNum));
+
                     dispatch();
                 }
 
@@ -6506,9 +6519,8 @@ void G_SaveMapState(void)
         }
         else if (aGameVars[i].flags & GAMEVAR_PERACTOR)
         {
-            if (!save->vars[i])
-                save->vars[i] = (intptr_t *)Xaligned_alloc(ACTOR_VAR_ALIGNMENT, MAXSPRITES * sizeof(intptr_t));
-            Bmemcpy(&save->vars[i][0], aGameVars[i].pValues, sizeof(intptr_t) * MAXSPRITES);
+            ALIGNED_FREE_AND_NULL(save->vars[i]);
+            save->vars[i] = Gv_PackActorVar(i);
         }
         else
             save->vars[i] = (intptr_t *)aGameVars[i].global;
@@ -6565,6 +6577,8 @@ void G_RestoreMapState(void)
 #endif
         numsectors = pSavedState->numsectors;
         Bmemcpy(&sector[0],&pSavedState->sector[0],sizeof(sectortype)*MAXSECTORS);
+        // the restored walls need not be in the cells they were registered in.
+        sectorGridInvalidate();
         Bmemcpy(&sprite[0],&pSavedState->sprite[0],sizeof(spritetype)*MAXSPRITES);
         Bmemcpy(&spriteext[0],&pSavedState->spriteext[0],sizeof(spriteext_t)*MAXSPRITES);
 
@@ -6640,7 +6654,7 @@ void G_RestoreMapState(void)
             {
                 if (!pSavedState->vars[i])
                     continue;
-                Bmemcpy(aGameVars[i].pValues, pSavedState->vars[i], sizeof(intptr_t) * MAXSPRITES);
+                Gv_UnpackActorVar(i, pSavedState->vars[i]);
             }
             else
                 aGameVars[i].global = (intptr_t)pSavedState->vars[i];
@@ -110,6 +110,127 @@ void Gv_Clear(void)
         hash_free(i);
 }
 
+// Per-actor snapshots (map states and savegames) only hold the values of
+// sprites that exist, as 32-bit values if all of them fit. On restore, free
+// slots get the default value, which is what A_ResetVars gives them on spawn.
+// GAMEVAR_NODEFAULT values survive respawns, so those vars are stored in full.
+enum
+{
+    PACKEDVAR_WIDE       = 1,  // values are stored as intptr_t
+    PACKEDVAR_ALLSPRITES = 2,  // no sprite list, values for all MAXSPRITES slots
+};
+
+struct packedactorvar_t
+{
+    int32_t size;  // of the entire block, including this header
+    int32_t flags;
+    int32_t count;
+    int32_t pad;
+    // followed by int16_t sprites[count] (unless PACKEDVAR_ALLSPRITES), padded to 8 bytes,
+    // then count int32_t or intptr_t values.
+};
+
+static size_t Gv_PackedListSize(packedactorvar_t const *block)
+{
+    return (block->flags & PACKEDVAR_ALLSPRITES) ? 0 : (block->count * sizeof(int16_t) + 7) & ~7;
+}
+
+intptr_t *Gv_PackActorVar(int const gameVar)
+{
+    static int16_t liveSprites[MAXSPRITES];
+
+    auto const &var = aGameVars[gameVar];
+    bool const allSprites = (var.flags & GAMEVAR_NODEFAULT) != 0;
+    bool wide = false;
+    int count = 0;
+
+    for (int i = 0; i < MAXSPRITES; i++)
+    {
+        if (!allSprites && sprite[i].statnum == MAXSTATUS)
+            continue;
+        liveSprites[count++] = i;
+        wide |= (var.pValues[i] != (int32_t)var.pValues[i]);
+    }
+
+    packedactorvar_t header = { 0, (wide ? PACKEDVAR_WIDE : 0) | (allSprites ? PACKEDVAR_ALLSPRITES : 0), count, 0 };
+    size_t const listSize = Gv_PackedListSize(&header);
+    header.size = sizeof(packedactorvar_t) + listSize + count * (wide ? sizeof(intptr_t) : sizeof(int32_t));
+
+    auto const block = (packedactorvar_t *)Xaligned_alloc(ACTOR_VAR_ALIGNMENT, header.size);
+    *block = header;
+
+    auto const data = (char *)(block + 1);
+    if (!allSprites)
+        Bmemcpy(data, liveSprites, count * sizeof(int16_t));
+
+    if (wide)
+    {
+        auto const values = (intptr_t *)(data + listSize);
+        for (int j = 0; j < count; j++)
+            values[j] = var.pValues[liveSprites[j]];
+    }
+    else
+    {
+        auto const values = (int32_t *)(data + listSize);
+        for (int j = 0; j < count; j++)
+            values[j] = (int32_t)var.pValues[liveSprites[j]];
+    }
+
+    return (intptr_t *)block;
+}
+
+void Gv_UnpackActorVar(int const gameVar, intptr_t const *const packed)
+{
+    auto &var = aGameVars[gameVar];
+    auto const block = (packedactorvar_t const *)packed;
+    auto const data = (char const *)(block + 1);
+    auto const sprites = (int16_t const *)data;
+    bool const allSprites = (block->flags & PACKEDVAR_ALLSPRITES) != 0;
+    size_t const listSize = Gv_PackedListSize(block);
+
+    if (!allSprites)
+    {
+        for (int i = 0; i < MAXSPRITES; i++)
+            var.pValues[i] = var.defaultValue;
+    }
+
+    for (int j = 0; j < block->count; j++)
+    {
+        int const spriteNum = (allSprites ? j : sprites[j]) & (MAXSPRITES-1);
+        var.pValues[spriteNum] = (block->flags & PACKEDVAR_WIDE) ? ((intptr_t const *)(data + listSize))[j]
+                                                                  : ((int32_t const *)(data + listSize))[j];
+    }
+}
+
+static void Gv_WritePackedActorVar(FileWriter &fil, intptr_t const *const packed)
+{
+    fil.Write(packed, ((packedactorvar_t const *)packed)->size);
+}
+
+static intptr_t *Gv_ReadPackedActorVar(FileReader &kFile)
+{
+    packedactorvar_t header;
+
+    if (kFile.Read(&header, sizeof(header)) != sizeof(header) || (unsigned)header.count > MAXSPRITES)
+        return nullptr;
+
+    size_t const size = sizeof(packedactorvar_t) + Gv_PackedListSize(&header)
+                        + header.count * ((header.flags & PACKEDVAR_WIDE) ? sizeof(intptr_t) : sizeof(int32_t));
+    if ((size_t)header.size != size)
+        return nullptr;
+
+    auto const block = (packedactorvar_t *)Xaligned_alloc(ACTOR_VAR_ALIGNMENT, size);
+    *block = header;
+
+    if (kFile.Read(block + 1, size - sizeof(header)) != (FileReader::Size)(size - sizeof(header)))
+    {
+        Xaligned_free(block);
+        return nullptr;
+    }
+
+    return (intptr_t *)block;
+}
+
 // Note that this entire function is totally architecture dependent and needs to be fixed (which won't be easy...)
 int Gv_ReadSave(FileReader &kFile)
 {
@@ -121,6 +242,11 @@ int Gv_ReadSave(FileReader &kFile)
     Gv_Free(); // nuke 'em from orbit, it's the only way to be sure...
 
     if (kFile.Read(&g_gameVarCount,sizeof(g_gameVarCount)) != sizeof(g_gameVarCount)) goto corrupt;
+    if ((unsigned)g_gameVarCount > MAXGAMEVARS)
+    {
+        g_gameVarCount = 0;
+        goto corrupt;
+    }
     for (bssize_t i=0; i<g_gameVarCount; i++)
     {
         char *const olabel = aGameVars[i].szLabel;
@@ -142,13 +268,22 @@ int Gv_ReadSave(FileReader &kFile)
         else if (aGameVars[i].flags & GAMEVAR_PERACTOR)
         {
             aGameVars[i].pValues = (intptr_t*)Xaligned_alloc(ACTOR_VAR_ALIGNMENT, MAXSPRITES * sizeof(intptr_t));
-            if (kFile.Read(aGameVars[i].pValues,sizeof(intptr_t) * MAXSPRITES) != sizeof(intptr_t) * MAXSPRITES) goto corrupt;
+
+            auto const packed = Gv_ReadPackedActorVar(kFile);
+            if (!packed) goto corrupt;
+            Gv_UnpackActorVar(i, packed);
+            Xaligned_free(packed);
         }
     }
 
     Gv_InitWeaponPointers();
 
     if (kFile.Read(&g_gameArrayCount,sizeof(g_gameArrayCount)) != sizeof(g_gameArrayCount)) goto corrupt;
+    if ((unsigned)g_gameArrayCount > MAXGAMEARRAYS)
+    {
+        g_gameArrayCount = 0;
+        goto corrupt;
+    }
     for (bssize_t i=0; i<g_gameArrayCount; i++)
     {
         char *const olabel = aGameArrays[i].szLabel;
@@ -205,8 +340,8 @@ int Gv_ReadSave(FileReader &kFile)
             }
             else if (aGameVars[j].flags & GAMEVAR_PERACTOR)
             {
-                sv.vars[j] = (intptr_t *) Xaligned_alloc(ACTOR_VAR_ALIGNMENT, MAXSPRITES * sizeof(intptr_t));
-                if (kFile.Read(sv.vars[j], sizeof(intptr_t) * MAXSPRITES) != sizeof(intptr_t) * MAXSPRITES) return -10;
+                sv.vars[j] = Gv_ReadPackedActorVar(kFile);
+                if (!sv.vars[j]) return -10;
             }
         }
 
@@ -247,7 +382,11 @@ void Gv_WriteSave(FileWriter &fil)
         if (aGameVars[i].flags & GAMEVAR_PERPLAYER)
 			fil.Write(aGameVars[i].pValues, sizeof(intptr_t) * MAXPLAYERS);
         else if (aGameVars[i].flags & GAMEVAR_PERACTOR)
-			fil.Write(aGameVars[i].pValues, sizeof(intptr_t) * MAXSPRITES);
+        {
+            auto const packed = Gv_PackActorVar(i);
+            Gv_WritePackedActorVar(fil, packed);
+            Xaligned_free(packed);
+        }
     }
 
 	fil.Write(&g_gameArrayCount,sizeof(g_gameArrayCount));
@@ -285,7 +424,7 @@ void Gv_WriteSave(FileWriter &fil)
             if (aGameVars[j].flags & GAMEVAR_PERPLAYER)
 				fil.Write(sv.vars[j], sizeof(intptr_t) * MAXPLAYERS);
             else if (aGameVars[j].flags & GAMEVAR_PERACTOR)
-				fil.Write(sv.vars[j], sizeof(intptr_t) * MAXSPRITES);
+                Gv_WritePackedActorVar(fil, sv.vars[j]);
         }
 
 		fil.Write(sv.arraysiz, sizeof(sv.arraysiz));
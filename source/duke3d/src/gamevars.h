@@ -157,6 +157,8 @@ void Gv_DumpValues(void);
 void Gv_InitWeaponPointers(void);
 void Gv_RefreshPointers(void);
 void Gv_ResetVars(void);
+intptr_t *Gv_PackActorVar(int const gameVar);
+void Gv_UnpackActorVar(int const gameVar, intptr_t const *const packed);
 int Gv_ReadSave(FileReader &kFile);
 void Gv_WriteSave(FileWriter &fil);
 void Gv_Clear(void);
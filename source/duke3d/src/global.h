@@ -30,6 +30,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "quotes.h"
 #include "sector.h"
 #include "sounds.h"
+#include "interpolation.h"
 #include "menu/menu.h"
 
 BEGIN_DUKE_NS
@@ -46,11 +47,8 @@ BEGIN_DUKE_NS
 // duke3d global soup :(
 
 
-G_EXTERN int32_t g_interpolationCnt;
 G_EXTERN int32_t g_interpolationLock;
-G_EXTERN int32_t oldipos[MAXINTERPOLATIONS];
-G_EXTERN int32_t *curipos[MAXINTERPOLATIONS];
-G_EXTERN int32_t bakipos[MAXINTERPOLATIONS];
+G_EXTERN TInterpolator<int32_t> g_interpolations;
 
 
 G_EXTERN int32_t duke3d_globalflags;
@@ -191,17 +189,15 @@ EXTERN_INLINE_HEADER void G_RestoreInterpolations(void);
 
 EXTERN_INLINE void G_UpdateInterpolations(void)  //Stick at beginning of G_DoMoveThings
 {
-    for (bssize_t i=g_interpolationCnt-1; i>=0; i--) oldipos[i] = *curipos[i];
+    g_interpolations.Update();
 }
 
 EXTERN_INLINE void G_RestoreInterpolations(void)  //Stick at end of drawscreen
 {
-    int32_t i=g_interpolationCnt-1;
-
     if (--g_interpolationLock)
         return;
 
-    for (; i>=0; i--) *curipos[i] = bakipos[i];
+    g_interpolations.Restore();
 }
 
 #endif
@@ -44,6 +44,9 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "mapinfo.h"
 
 #include "m_crc32.h"
+#ifdef _DEBUG
+#include "stats.h"
+#endif
 
 BEGIN_DUKE_NS
 
@@ -467,6 +470,24 @@ static TArray<netmapstate_t> g_cl_InterpolatedMapStateHistory;
 static TArray<netmapstate_t> g_mapStateHistory;
 static TArray<uint8_t> tempnetbuf;
 
+// the revision in which each entry of a map state history last changed,
+// so that writing a delta can skip everything that hasn't changed since the "from" revision
+// without comparing it field by field.
+// The same is kept for every field, so that an entry that did change only compares
+// the fields that changed since the "from" revision.
+typedef struct netchanges_s
+{
+    uint32_t wall[MAXWALLS];
+    uint32_t sector[MAXSECTORS];
+    uint32_t actor[MAXSPRITES];
+
+    uint32_t wallField[MAXWALLS][ARRAY_SIZE(WallFields)];
+    uint32_t sectorField[MAXSECTORS][ARRAY_SIZE(SectorFields)];
+    uint32_t actorField[MAXSPRITES][ARRAY_SIZE(ActorFields)];
+} netchanges_t;
+
+static netchanges_t g_mapStateChanges;
+
 // Remember that this constant needs to be one bit longer than a struct index, so it can't be mistaken for a valid wall, sprite, or sector index
 static const int32_t cSTOP_PARSING_CODE = ((1 << NETINDEX_BITS) - 1);
 
@@ -1426,37 +1447,47 @@ static void Net_CopyAllActorDataToNet(int32_t spriteIndex, const spritetype* gam
 
 static void Net_AddActorsToSnapshot(netmapstate_t* snapshot)
 {
-
-    int32_t gameIndex = 0;
-
     NET_75_CHECK++; // we may want to only send over sprites that are visible, this might be a good optimization
                     // to do later.
 
     NET_75_CHECK++; // Verify: Does the netcode need to worry about spriteext and spritesmooth beyond index (MAXSPRITES - 1)?
 
-    NET_75_CHECK++; // may be able to significantly improve performance by using headspritestat[] etc. lists
-                    // i.e., replace with for(all stat) { for(all sprites in stat) { } }, ignoring net Non Relevant Stats,
-                    // also then ioSnapshot->maxActorIndex could be something much less than MAXSPRITES
+    uint8_t     liveSprites[(MAXSPRITES + 7) >> 3];
+    int32_t     gameIndex = 0;
+    int32_t     statIndex = 0;
 
-    snapshot->maxActorIndex = 0;
+    Bmemset(liveSprites, 0, sizeof(liveSprites));
 
-    // note that Numsprites should NOT be the upper bound, if sprites are deleted in the middle
-    // the max index to check will be > than Numsprites.
-    for (gameIndex = 0; gameIndex < (MAXSPRITES); gameIndex++)
+    // only sprites that are in a stat list need to be copied from the game arrays.
+    for (statIndex = 0; statIndex < MAXSTATUS; statIndex++)
     {
-        const spritetype*       gameSpr = &sprite[gameIndex];
+        for (gameIndex = headspritestat[statIndex]; gameIndex >= 0; gameIndex = nextspritestat[gameIndex])
+        {
+            netactor_t* netSprite = &snapshot->actor[gameIndex];
 
-        const actor_t*          gameAct = &actor[gameIndex];
-        const spriteext_t*      gameExt = &spriteext[gameIndex];
-        const spritesmooth_t*   gameSmooth = &spritesmooth[gameIndex];
+            Net_CopyAllActorDataToNet(gameIndex, &sprite[gameIndex], &actor[gameIndex], &spriteext[gameIndex], &spritesmooth[gameIndex], netSprite);
 
-        netactor_t*       netSprite = &snapshot->actor[gameIndex];
+            liveSprites[gameIndex >> 3] |= 1 << (gameIndex & 7);
+        }
+    }
 
+    // Every other sprite gets the same deleted entry, so that whatever a deleted sprite left behind
+    // in the game arrays never shows up as a change.
+    netactor_t deletedActor = cNullNetActor;
 
-        Net_CopyAllActorDataToNet(gameIndex, gameSpr, gameAct, gameExt, gameSmooth, netSprite);
+    deletedActor.spr_statnum = cLocSprite_DeletedSpriteStat;
+    deletedActor.spr_sectnum = MAXSECTORS;
 
+    for (gameIndex = 0; gameIndex < MAXSPRITES; gameIndex++)
+    {
+        if (!(liveSprites[gameIndex >> 3] & (1 << (gameIndex & 7))))
+        {
+            deletedActor.netIndex = gameIndex;
+            snapshot->actor[gameIndex] = deletedActor;
+        }
     }
 
+    NET_75_CHECK++; // For now every snapshot will have MAXSPRITES entries, the delta parser depends on that.
     snapshot->maxActorIndex = MAXSPRITES;
 
 }
@@ -1491,6 +1522,78 @@ static void Net_AddWorldToSnapshot(netmapstate_t* snapshot)
     Net_AddActorsToSnapshot(snapshot);
 }
 
+// stores revision for every field that differs between from and to (or for every field if from is NULL),
+// returns whether there was any.
+static bool Net_UpdateFieldChanges(uint32_t* fieldChanges, uint32_t revision, const void* from, const void* to, const netField_t* fields, int32_t numFields)
+{
+    bool changed = false;
+
+    for (int32_t fieldIndex = 0; fieldIndex < numFields; fieldIndex++)
+    {
+        if (from)
+        {
+            const int32_t* fromField = (int32_t const *)((int8_t const *)from + fields[fieldIndex].offset);
+            const int32_t* toField   = (int32_t const *)((int8_t const *)to   + fields[fieldIndex].offset);
+
+            if (*fromField == *toField)
+            {
+                continue;
+            }
+        }
+
+        fieldChanges[fieldIndex] = revision;
+        changed = true;
+    }
+
+    return changed;
+}
+
+// compares a freshly built map state with the revision before it and records which entries changed.
+static void Net_UpdateMapStateChanges(netchanges_t* changes, const netmapstate_t* previous, const netmapstate_t* current)
+{
+    const uint32_t  revision = current->revisionNumber;
+
+    // after a rollover or a reset there's nothing to compare with, everything counts as changed.
+    const bool      havePrevious = (revision > cStartingRevisionIndex) && (previous->revisionNumber + 1 == revision);
+
+    int32_t index = 0;
+
+    for (index = 0; index < numwalls; index++)
+    {
+        if (Net_UpdateFieldChanges(changes->wallField[index], revision, havePrevious ? &previous->wall[index] : NULL, &current->wall[index], WallFields, ARRAY_SIZE(WallFields)))
+        {
+            changes->wall[index] = revision;
+        }
+    }
+
+    for (index = 0; index < numsectors; index++)
+    {
+        if (Net_UpdateFieldChanges(changes->sectorField[index], revision, havePrevious ? &previous->sector[index] : NULL, &current->sector[index], SectorFields, ARRAY_SIZE(SectorFields)))
+        {
+            changes->sector[index] = revision;
+        }
+    }
+
+    for (index = 0; index < MAXSPRITES; index++)
+    {
+        const netactor_t* previousActor = &previous->actor[index];
+        const netactor_t* currentActor  = &current->actor[index];
+
+        // deleted sprites all look the same, see Net_AddActorsToSnapshot()
+        const bool bothDeleted = (previousActor->spr_statnum == cLocSprite_DeletedSpriteStat) && (currentActor->spr_statnum == cLocSprite_DeletedSpriteStat);
+
+        if (havePrevious && bothDeleted)
+        {
+            continue;
+        }
+
+        if (Net_UpdateFieldChanges(changes->actorField[index], revision, havePrevious ? previousActor : NULL, currentActor, ActorFields, ARRAY_SIZE(ActorFields)))
+        {
+            changes->actor[index] = revision;
+        }
+    }
+}
+
 
 
 
@@ -2730,7 +2833,7 @@ static void SafeStrncpyz(char *dest, const char *src, int destsize)
 
 // Write a bit (bitValue) to a byte array (dataBuffer) at bit offset bitOffset,
 // this function increments bitOffset for you.
-static void PutBit(int32_t bitValue, uint8_t *dataBuffer, int32_t *bitOffset)
+EDUKE32_UNUSED static void PutBit(int32_t bitValue, uint8_t *dataBuffer, int32_t *bitOffset)
 {
     int32_t bitOffsetValue = *bitOffset;
 
@@ -2752,7 +2855,7 @@ static void PutBit(int32_t bitValue, uint8_t *dataBuffer, int32_t *bitOffset)
 
 // Get a single bit (return value) from a byte array (dataBuffer) at bit offset bitOffset
 // this function increments bitOffset for you.
-static int32_t GetBit(uint8_t *dataBuffer, int32_t *bitOffset)
+EDUKE32_UNUSED static int32_t GetBit(uint8_t *dataBuffer, int32_t *bitOffset)
 {
     int32_t bitValue = -1;
 
@@ -2772,45 +2875,66 @@ static int32_t GetBit(uint8_t *dataBuffer, int32_t *bitOffset)
 //Note: This function increments bitOffset for you
 static void PutBits(int32_t value, uint8_t *dataBuffer, int32_t *bitOffset, int16_t numberOfBits)
 {
-    int16_t bitIndex;
-
     if (numberOfBits > 32)
     {
         Net_Error_Disconnect("PutBits: Attempted to write more than 32 bits to the buffer.");
         numberOfBits = 32;
     }
 
-    for (bitIndex = 0; bitIndex < numberOfBits; bitIndex++)
+    uint32_t bits = value;
+    int32_t  bitOffsetValue = *bitOffset;
+
+    // same bit order as PutBit(), but up to a byte at a time
+    while (numberOfBits > 0)
     {
-        int32_t bitValue = value & (1 << bitIndex);
+        const int32_t byteIndex = bitOffsetValue >> 3;
+        const int32_t bitIndex = bitOffsetValue & 7;
+        const int32_t bitsInByte = min<int32_t>(8 - bitIndex, numberOfBits);
+
+        // reset this byte to 0 on the first bit
+        if (bitIndex == 0)
+        {
+            dataBuffer[byteIndex] = 0;
+        }
 
-        PutBit((bitValue != 0), dataBuffer, bitOffset);
+        dataBuffer[byteIndex] |= (bits & ((1u << bitsInByte) - 1)) << bitIndex;
 
+        bits >>= bitsInByte;
+        bitOffsetValue += bitsInByte;
+        numberOfBits -= bitsInByte;
     }
 
+    *bitOffset = bitOffsetValue;
 }
 
 //Note: this function increments bitOffset for you
 static int32_t GetBits(uint8_t *dataBuffer, int32_t *bitOffset, int16_t numberOfBits)
 {
-    int32_t value = 0;
-    int16_t bitIndex;
-
     if (numberOfBits > 32)
     {
         Net_Error_Disconnect("GetBits: Attempted to read more than 32 bits from the buffer.");
         numberOfBits = 32;
     }
 
-    for (bitIndex = 0; bitIndex < numberOfBits; bitIndex++)
+    uint32_t value = 0;
+    int32_t  valueBit = 0;
+    int32_t  bitOffsetValue = *bitOffset;
+
+    while (valueBit < numberOfBits)
     {
-        int32_t tBitValue = GetBit(dataBuffer, bitOffset);
+        const int32_t byteIndex = bitOffsetValue >> 3;
+        const int32_t bitIndex = bitOffsetValue & 7;
+        const int32_t bitsInByte = min<int32_t>(8 - bitIndex, numberOfBits - valueBit);
 
-        value |= (tBitValue << bitIndex);
+        value |= (uint32_t)((dataBuffer[byteIndex] >> bitIndex) & ((1u << bitsInByte) - 1)) << valueBit;
 
+        valueBit += bitsInByte;
+        bitOffsetValue += bitsInByte;
     }
 
-    return value;
+    *bitOffset = bitOffsetValue;
+
+    return (int32_t)value;
 }
 
 
@@ -3091,7 +3215,8 @@ EDUKE32_UNUSED static void NetBuffer_ReadData(NetBuffer_t *netBuffer, void *data
 // net struct -> Buffer functions
 //----------------------------------------------------------------------------------------------------------
 
-static void NetBuffer_WriteDeltaNetWall(NetBuffer_t *netBuffer, const netWall_t *from, const netWall_t *to)
+// if fieldChanges is not NULL, fields that haven't changed after baseRevision are skipped without comparing them.
+static void NetBuffer_WriteDeltaNetWall(NetBuffer_t *netBuffer, const netWall_t *from, const netWall_t *to, const uint32_t *fieldChanges, uint32_t baseRevision)
 {
     const   int32_t         cMaxStructs = MAXWALLS;
     const   int32_t         cFieldsInStruct = ARRAY_SIZE(WallFields);
@@ -3122,6 +3247,11 @@ static void NetBuffer_WriteDeltaNetWall(NetBuffer_t *netBuffer, const netWall_t
 
     for (fieldIndex = 0, fieldPtr = WallFields; fieldIndex < cFieldsInStruct; fieldIndex++, fieldPtr++)
     {
+        if (fieldChanges && fieldChanges[fieldIndex] <= baseRevision)
+        {
+            continue;
+        }
+
         fromField   = (int32_t const *)((int8_t const *)from  + fieldPtr->offset);
         toField     = (int32_t const *)((int8_t const *)to    + fieldPtr->offset);
 
@@ -3147,7 +3277,7 @@ static void NetBuffer_WriteDeltaNetWall(NetBuffer_t *netBuffer, const netWall_t
 
         //                                                              // Bit(s) meaning
         //                                                              //-------------------
-        if (*fromField == *toField)
+        if ((fieldChanges && fieldChanges[fieldIndex] <= baseRevision) || *fromField == *toField)
         {
             NetBuffer_WriteBits(netBuffer, 0, 1);                       // field not changed
             continue;
@@ -3168,7 +3298,8 @@ static void NetBuffer_WriteDeltaNetWall(NetBuffer_t *netBuffer, const netWall_t
     }
 }
 
-static void NetBuffer_WriteDeltaNetSector(NetBuffer_t *netBuffer, const netSector_t *from, const netSector_t *to)
+// if fieldChanges is not NULL, fields that haven't changed after baseRevision are skipped without comparing them.
+static void NetBuffer_WriteDeltaNetSector(NetBuffer_t *netBuffer, const netSector_t *from, const netSector_t *to, const uint32_t *fieldChanges, uint32_t baseRevision)
 {
     const   int32_t         cMaxStructs = MAXSECTORS;
     const   int32_t         cFieldsInStruct = ARRAY_SIZE(SectorFields);
@@ -3199,6 +3330,11 @@ static void NetBuffer_WriteDeltaNetSector(NetBuffer_t *netBuffer, const netSecto
 
     for (fieldIndex = 0, fieldPtr = SectorFields; fieldIndex < cFieldsInStruct; fieldIndex++, fieldPtr++)
     {
+        if (fieldChanges && fieldChanges[fieldIndex] <= baseRevision)
+        {
+            continue;
+        }
+
         fromField   = (int32_t const *)((int8_t const *)from    + fieldPtr->offset);
         toField     = (int32_t const *)((int8_t const *)to      + fieldPtr->offset);
 
@@ -3224,7 +3360,7 @@ static void NetBuffer_WriteDeltaNetSector(NetBuffer_t *netBuffer, const netSecto
 
         //                                                              // Bit(s) meaning
         //                                                              //-------------------
-        if (*fromField == *toField)
+        if ((fieldChanges && fieldChanges[fieldIndex] <= baseRevision) || *fromField == *toField)
         {
             NetBuffer_WriteBits(netBuffer, 0, 1);                       // field not changed
             continue;
@@ -3245,7 +3381,8 @@ static void NetBuffer_WriteDeltaNetSector(NetBuffer_t *netBuffer, const netSecto
     }
 }
 
-static void NetBuffer_WriteDeltaNetActor(NetBuffer_t* netBuffer, const netactor_t *from, const netactor_t* to, int8_t writeDeletedActors)
+// if fieldChanges is not NULL, fields that haven't changed after baseRevision are skipped without comparing them.
+static void NetBuffer_WriteDeltaNetActor(NetBuffer_t* netBuffer, const netactor_t *from, const netactor_t* to, int8_t writeDeletedActors, const uint32_t *fieldChanges, uint32_t baseRevision)
 {
     const   int32_t         cMaxStructs = MAXSPRITES;
     const   int32_t         cFieldsInStruct = ARRAY_SIZE(ActorFields);
@@ -3268,6 +3405,9 @@ static void NetBuffer_WriteDeltaNetActor(NetBuffer_t* netBuffer, const netactor_
     {
         // The actor was deleted in the "From" snapshot, but it's there in the "To" snapshot, so that means it has been inserted in the "To" snapshot.
         from = &cNullNetActor;
+
+        // the field changes describe the "From" snapshot, not the null actor.
+        fieldChanges = NULL;
     }
 
     if (to == NULL)
@@ -3294,6 +3434,11 @@ static void NetBuffer_WriteDeltaNetActor(NetBuffer_t* netBuffer, const netactor_
 
     for (fieldIndex = 0, fieldPtr = ActorFields; fieldIndex < cFieldsInStruct; fieldIndex++, fieldPtr++)
     {
+        if (fieldChanges && fieldChanges[fieldIndex] <= baseRevision)
+        {
+            continue;
+        }
+
         fromField   = (int32_t const *)((int8_t const *)from    + fieldPtr->offset);
         toField     = (int32_t const *)((int8_t const *)to      + fieldPtr->offset);
 
@@ -3342,7 +3487,7 @@ static void NetBuffer_WriteDeltaNetActor(NetBuffer_t* netBuffer, const netactor_
         fromField   = (int32_t const *)((int8_t const *)from    + fieldPtr->offset);
         toField     = (int32_t const *)((int8_t const *)to      + fieldPtr->offset);
 
-        if (*fromField == *toField)
+        if ((fieldChanges && fieldChanges[fieldIndex] <= baseRevision) || *fromField == *toField)
         {
             NetBuffer_WriteBits(netBuffer, 0, 1);                                       // {0}              field not changed
             continue;
@@ -3379,7 +3524,8 @@ static void NetBuffer_WriteDeltaNetActor(NetBuffer_t* netBuffer, const netactor_
 }
 
 
-static void Net_WriteNetActorsToBuffer(NetBuffer_t* netBuffer, const netmapstate_t* from, const netmapstate_t* to)
+// if changes is not NULL, actors and fields that haven't changed after baseRevision are skipped without comparing them.
+static void Net_WriteNetActorsToBuffer(NetBuffer_t* netBuffer, const netmapstate_t* from, const netmapstate_t* to, const netchanges_t* changes, uint32_t baseRevision)
 {
     const netactor_t* fromActor = NULL;
 
@@ -3404,6 +3550,11 @@ static void Net_WriteNetActorsToBuffer(NetBuffer_t* netBuffer, const netmapstate
         actorIndex < fromMaxIndex
         )
     {
+        if (changes && changes->actor[actorIndex] <= baseRevision)
+        {
+            actorIndex++;
+            continue;
+        }
 
         // load actor pointers using actor indexes
         if (actorIndex >= to->maxActorIndex)
@@ -3435,7 +3586,7 @@ static void Net_WriteNetActorsToBuffer(NetBuffer_t* netBuffer, const netmapstate
             }
         }
 
-        NetBuffer_WriteDeltaNetActor(netBuffer, fromActor, toActor, 0);
+        NetBuffer_WriteDeltaNetActor(netBuffer, fromActor, toActor, 0, changes ? changes->actorField[actorIndex] : NULL, baseRevision);
 
         actorIndex++;
 
@@ -3443,7 +3594,9 @@ static void Net_WriteNetActorsToBuffer(NetBuffer_t* netBuffer, const netmapstate
 }
 
 
-static void Net_WriteWorldToBuffer(NetBuffer_t* netBuffer, const netmapstate_t* fromSnapshot, const netmapstate_t* toSnapshot)
+// changes and baseRevision are only valid if fromSnapshot is the map state of baseRevision,
+// and toSnapshot is a later revision of the same history. Otherwise pass NULL for changes.
+static void Net_WriteWorldToBuffer(NetBuffer_t* netBuffer, const netmapstate_t* fromSnapshot, const netmapstate_t* toSnapshot, const netchanges_t* changes, uint32_t baseRevision)
 {
     int32_t index = 0;
 
@@ -3451,10 +3604,15 @@ static void Net_WriteWorldToBuffer(NetBuffer_t* netBuffer, const netmapstate_t*
     {
         Bassert(index < MAXWALLS);
 
+        if (changes && changes->wall[index] <= baseRevision)
+        {
+            continue;
+        }
+
         const netWall_t* fromWall = &fromSnapshot->wall[index];
         const netWall_t* toWall = &toSnapshot->wall[index];
 
-        NetBuffer_WriteDeltaNetWall(netBuffer, fromWall, toWall);
+        NetBuffer_WriteDeltaNetWall(netBuffer, fromWall, toWall, changes ? changes->wallField[index] : NULL, baseRevision);
 
     }
 
@@ -3466,15 +3624,20 @@ static void Net_WriteWorldToBuffer(NetBuffer_t* netBuffer, const netmapstate_t*
     {
         Bassert(index < MAXSECTORS);
 
+        if (changes && changes->sector[index] <= baseRevision)
+        {
+            continue;
+        }
+
         const netSector_t* fromSector = &fromSnapshot->sector[index];
         const netSector_t* toSector = &toSnapshot->sector[index];
 
-        NetBuffer_WriteDeltaNetSector(netBuffer, fromSector, toSector);
+        NetBuffer_WriteDeltaNetSector(netBuffer, fromSector, toSector, changes ? changes->sectorField[index] : NULL, baseRevision);
     }
 
     NetBuffer_WriteBits(netBuffer, cSTOP_PARSING_CODE, NETINDEX_BITS);
 
-    Net_WriteNetActorsToBuffer(netBuffer, fromSnapshot, toSnapshot);
+    Net_WriteNetActorsToBuffer(netBuffer, fromSnapshot, toSnapshot, changes, baseRevision);
 
     NetBuffer_WriteBits(netBuffer, cSTOP_PARSING_CODE, NETINDEX_BITS); // end of actors/sprites
 
@@ -4235,12 +4398,15 @@ static void Net_SendWorldUpdate(uint32_t fromRevisionNumber, uint32_t toRevision
 
     netmapstate_t*  toMapState = &g_mapStateHistory[toRevisionNumber % NET_REVISIONS];
     netmapstate_t*  fromMapState = NULL;
+    netchanges_t*   changes = NULL;
 
     NET_75_CHECK++; // during the rollover state it might be a good idea to init the map state history?
                     // maybe not? I do init map states before using them, so it might not be needed.
 
+    // the client reads revision 0 as the initial map state, not as a slot in the history
+    uint32_t        playerHasInitialState = (fromRevisionNumber == cInitialMapStateRevisionNumber);
 
-    if (playerRevisionIsTooOld || revisionInRolloverState)
+    if (playerRevisionIsTooOld || revisionInRolloverState || playerHasInitialState)
     {
         fromMapState = &g_mapStartState;
         fromRevisionNumberToSend = cInitialMapStateRevisionNumber;
@@ -4251,6 +4417,11 @@ static void Net_SendWorldUpdate(uint32_t fromRevisionNumber, uint32_t toRevision
 
         fromMapState = &g_mapStateHistory[tFromRevisionIndex];
         fromRevisionNumberToSend = fromRevisionNumber;
+
+        if (fromMapState->revisionNumber == fromRevisionNumber)
+        {
+            changes = &g_mapStateChanges;
+        }
     }
 
 
@@ -4263,7 +4434,7 @@ static void Net_SendWorldUpdate(uint32_t fromRevisionNumber, uint32_t toRevision
     NetBuffer_WriteDword(bufferPtr, fromRevisionNumberToSend);
     NetBuffer_WriteDword(bufferPtr, toRevisionNumber);
 
-    Net_WriteWorldToBuffer(bufferPtr, fromMapState, toMapState);
+    Net_WriteWorldToBuffer(bufferPtr, fromMapState, toMapState, changes, fromRevisionNumberToSend);
 
     if (sendToPlayerIndex > ((int32_t) g_netServer->peerCount))
     {
@@ -4290,6 +4461,8 @@ static void Net_CopySnapshotToGameArrays(netmapstate_t* srv_snapshot, netmapstat
     // remember that we need to correct any incorrect guesses the client made.
     // don't do memcpy either, e.g., sizeof(netWall_t) != sizeof(walltype)
 
+    int32_t movedSector = -1;
+
     for (index = 0; index < numwalls; index++)
     {
         netWall_t*  srvWall = &(srv_snapshot->wall[index]);
@@ -4307,11 +4480,29 @@ static void Net_CopySnapshotToGameArrays(netmapstate_t* srv_snapshot, netmapstat
         }
 
         walltype*   gameWall = &(wall[index]);
+        vec2_t const oldPos = { gameWall->x, gameWall->y };
 
         Net_CopyWallFromNet(srvWall, gameWall);
 
+        // moving sectors can leave the cells they are registered in.
+        // a sector's walls are contiguous, so each one is updated once all of its walls have been copied.
+        if (gameWall->x != oldPos.x || gameWall->y != oldPos.y)
+        {
+            int32_t const sectNum = sectorofwall(index);
+
+            if (sectNum != movedSector)
+            {
+                if (movedSector >= 0)
+                    sectorGridUpdateSector(movedSector);
+
+                movedSector = sectNum;
+            }
+        }
     }
 
+    if (movedSector >= 0)
+        sectorGridUpdateSector(movedSector);
+
     for (index = 0; index < numsectors; index++)
     {
         netSector_t*  srvSector = &(srv_snapshot->sector[index]);
@@ -4623,6 +4814,8 @@ void Net_SendMapUpdate(void)
 
     toMapState->revisionNumber = g_netMapRevisionNumber;
 
+    Net_UpdateMapStateChanges(&g_mapStateChanges, &g_mapStateHistory[(g_netMapRevisionNumber - 1) % NET_REVISIONS], toMapState);
+
     int32_t playerIndex = 0;
 
     for (TRAVERSE_CONNECT(playerIndex))
@@ -4641,6 +4834,244 @@ void Net_SendMapUpdate(void)
 }
 
 
+#ifdef _DEBUG
+//------------------------------------------------------------------------------------------------------------------------
+// Snapshot benchmark
+//
+// Runs the server's side of the world updates in a local game, as if there were a number of clients
+// whose acknowledged revisions are 1 to BENCH_MAXLAG updates behind. Every delta is also written
+// without the change tracking, to check that both are identical, and read back the way a client would.
+
+#define BENCH_MAXLAG        4
+#define BENCH_REVISIONS     (BENCH_MAXLAG + 2)
+
+typedef struct netbench_s
+{
+    netmapstate_t           history[BENCH_REVISIONS];
+    netmapstate_t           decoded;
+    netchanges_t            changes;
+
+    TArray<uint8_t>         buffer;
+    TArray<uint8_t>         fullBuffer;
+
+    uint32_t                revision;
+    int32_t                 numPlayers;
+    int32_t                 numUpdates;
+    int32_t                 updatesDone;
+
+    uint64_t                bytes;
+    int32_t                 mismatches;
+
+    cycle_t                 buildTime;
+    cycle_t                 writeTime;
+    cycle_t                 fullWriteTime;
+    cycle_t                 readTime;
+} netbench_t;
+
+static netbench_t* g_netBench;
+
+static bool Net_BenchFieldsEqual(const void* a, const void* b, const netField_t* fields, int32_t numFields)
+{
+    for (int32_t fieldIndex = 0; fieldIndex < numFields; fieldIndex++)
+    {
+        const int32_t* aField = (int32_t const *)((int8_t const *)a + fields[fieldIndex].offset);
+        const int32_t* bField = (int32_t const *)((int8_t const *)b + fields[fieldIndex].offset);
+
+        // floats only need to survive by value, -0.0f is sent as 0.
+        if (fields[fieldIndex].bits == 0 ? (*(float const *)aField != *(float const *)bField) : (*aField != *bField))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool Net_BenchMapStatesEqual(const netmapstate_t* a, const netmapstate_t* b)
+{
+    int32_t index = 0;
+
+    for (index = 0; index < numwalls; index++)
+    {
+        if (a->wall[index].netIndex != b->wall[index].netIndex || !Net_BenchFieldsEqual(&a->wall[index], &b->wall[index], WallFields, ARRAY_SIZE(WallFields)))
+            return false;
+    }
+
+    for (index = 0; index < numsectors; index++)
+    {
+        if (a->sector[index].netIndex != b->sector[index].netIndex || !Net_BenchFieldsEqual(&a->sector[index], &b->sector[index], SectorFields, ARRAY_SIZE(SectorFields)))
+            return false;
+    }
+
+    for (index = 0; index < MAXSPRITES; index++)
+    {
+        if (a->actor[index].netIndex != b->actor[index].netIndex || !Net_BenchFieldsEqual(&a->actor[index], &b->actor[index], ActorFields, ARRAY_SIZE(ActorFields)))
+            return false;
+    }
+
+    return true;
+}
+
+static void Net_PrintBenchmark(netbench_t* bench)
+{
+    const int32_t   numDeltas = bench->updatesDone * bench->numPlayers;
+
+    Printf("bench_netsnapshot: %d updates x %d players, %d walls, %d sectors, %d sprites\n", bench->updatesDone, bench->numPlayers, numwalls, numsectors, Numsprites);
+
+    if (numDeltas > 0)
+    {
+        Printf("  bytes/update/player:       %.1f\n", (double)bench->bytes / numDeltas);
+        Printf("  build snapshot:            %.3f ms/update\n", bench->buildTime.TimeMS() / bench->updatesDone);
+        Printf("  write delta:               %.3f ms/update\n", bench->writeTime.TimeMS() / bench->updatesDone);
+        Printf("  write delta, full compare: %.3f ms/update\n", bench->fullWriteTime.TimeMS() / bench->updatesDone);
+        Printf("  read delta (client):       %.3f ms/update\n", bench->readTime.TimeMS() / bench->updatesDone);
+    }
+
+    if (bench->mismatches)
+    {
+        Printf(TEXTCOLOR_RED "  %d mismatches!\n", bench->mismatches);
+    }
+}
+
+// called every time a world update would be sent if this were a server
+void Net_BenchmarkMapUpdate(void)
+{
+    netbench_t* bench = g_netBench;
+
+    if (!bench)
+    {
+        return;
+    }
+
+    bench->revision = Net_GetNextRevisionNumber(bench->revision);
+
+    netmapstate_t*  toMapState = &bench->history[bench->revision % BENCH_REVISIONS];
+    netmapstate_t*  previousMapState = &bench->history[(bench->revision - 1) % BENCH_REVISIONS];
+
+    bench->buildTime.Clock();
+
+    Net_InitMapState(toMapState);
+    Net_AddWorldToSnapshot(toMapState);
+
+    toMapState->revisionNumber = bench->revision;
+
+    Net_UpdateMapStateChanges(&bench->changes, previousMapState, toMapState);
+
+    bench->buildTime.Unclock();
+
+    // wait until every simulated client has a revision to start from
+    if (bench->revision <= cStartingRevisionIndex + BENCH_MAXLAG)
+    {
+        bench->buildTime.Reset();
+        return;
+    }
+
+    for (int32_t playerIndex = 0; playerIndex < bench->numPlayers; playerIndex++)
+    {
+        const uint32_t  fromRevision = bench->revision - 1 - (playerIndex % BENCH_MAXLAG);
+        netmapstate_t*  fromMapState = &bench->history[fromRevision % BENCH_REVISIONS];
+
+        NetBuffer_t     buffer;
+        NetBuffer_t     fullBuffer;
+        NetBuffer_t     readBuffer;
+
+        NetBuffer_Init(&buffer, bench->buffer.Data(), MAX_WORLDBUFFER);
+        NetBuffer_Init(&fullBuffer, bench->fullBuffer.Data(), MAX_WORLDBUFFER);
+
+        bench->writeTime.Clock();
+        NetBuffer_WriteDword(&buffer, fromRevision);
+        NetBuffer_WriteDword(&buffer, bench->revision);
+        Net_WriteWorldToBuffer(&buffer, fromMapState, toMapState, &bench->changes, fromRevision);
+        bench->writeTime.Unclock();
+
+        bench->fullWriteTime.Clock();
+        NetBuffer_WriteDword(&fullBuffer, fromRevision);
+        NetBuffer_WriteDword(&fullBuffer, bench->revision);
+        Net_WriteWorldToBuffer(&fullBuffer, fromMapState, toMapState, NULL, 0);
+        bench->fullWriteTime.Unclock();
+
+        if (buffer.CurSize != fullBuffer.CurSize || memcmp(buffer.Data, fullBuffer.Data, buffer.CurSize) != 0)
+        {
+            bench->mismatches++;
+        }
+
+        NetBuffer_Init(&readBuffer, bench->buffer.Data(), MAX_WORLDBUFFER);
+        readBuffer.CurSize = buffer.CurSize;
+
+        bench->readTime.Clock();
+        NetBuffer_ReadDWord(&readBuffer);
+        NetBuffer_ReadDWord(&readBuffer);
+        NetBuffer_ReadWorldSnapshotFromBuffer(&readBuffer, fromMapState, &bench->decoded);
+        bench->readTime.Unclock();
+
+        if (!Net_BenchMapStatesEqual(&bench->decoded, toMapState))
+        {
+            bench->mismatches++;
+        }
+
+        // plus the packet type byte
+        bench->bytes += buffer.CurSize + 1;
+    }
+
+    if (++bench->updatesDone >= bench->numUpdates)
+    {
+        Net_PrintBenchmark(bench);
+
+        delete bench;
+        g_netBench = NULL;
+    }
+}
+
+int osdcmd_bench_netsnapshot(CCmdFuncPtr parm)
+{
+    if (g_netServer || g_netClient)
+    {
+        Printf("bench_netsnapshot: only available in a local game\n");
+        return OSDCMD_OK;
+    }
+
+    if (numsectors <= 0 || numwalls <= 0)
+    {
+        Printf("bench_netsnapshot: no map loaded\n");
+        return OSDCMD_OK;
+    }
+
+    if (g_netBench)
+    {
+        Printf("bench_netsnapshot: already running\n");
+        return OSDCMD_OK;
+    }
+
+    netbench_t* bench = new netbench_t;
+
+    bench->numPlayers = (parm->numparms > 0) ? clamp(atoi(parm->parms[0]), 1, MAXPLAYERS) : MAXPLAYERS;
+    bench->numUpdates = (parm->numparms > 1) ? max(1, atoi(parm->parms[1])) : 50;
+    bench->revision = cInitialMapStateRevisionNumber;
+    bench->updatesDone = 0;
+    bench->bytes = 0;
+    bench->mismatches = 0;
+    bench->buffer.Resize(MAX_WORLDBUFFER);
+    bench->fullBuffer.Resize(MAX_WORLDBUFFER);
+    bench->buildTime.Reset();
+    bench->writeTime.Reset();
+    bench->fullWriteTime.Reset();
+    bench->readTime.Reset();
+
+    for (auto& mapState : bench->history)
+    {
+        Net_InitMapState(&mapState);
+    }
+
+    Bmemset(&bench->changes, 0, sizeof(bench->changes));
+
+    g_netBench = bench;
+
+    Printf("bench_netsnapshot: recording %d world updates for %d players\n", bench->numUpdates, bench->numPlayers);
+    return OSDCMD_OK;
+}
+#endif
+
+
 void DumpMapStateHistory()
 {
     const char* fileName = NULL;
@@ -5147,6 +5578,8 @@ void Net_InitMapStateHistory()
 
     g_mapStartState.revisionNumber = cInitialMapStateRevisionNumber;
 
+    Bmemset(&g_mapStateChanges, 0, sizeof(g_mapStateChanges));
+
     g_netMapRevisionNumber    = cInitialMapStateRevisionNumber;  // Net_InitMapStateHistory()
     g_cl_InterpolatedRevision = cInitialMapStateRevisionNumber;
 }
@@ -281,6 +281,10 @@ void    Net_SendMapVoteCancel(int32_t failed);
 
 void    Net_StoreClientState(void);
 
+#ifdef _DEBUG
+void    Net_BenchmarkMapUpdate(void);
+#endif
+
 //////////
 
 void    Net_ResetPrediction(void);
@@ -348,6 +352,7 @@ void Net_PrintLag(FString& output);
 #define Net_WaitForInitialSnapshot(...) ((void)0)
 #define Net_SendMapUpdate(...) ((void)0)
 #define Net_StoreClientState(...) ((void)0)
+#define Net_BenchmarkMapUpdate(...) ((void)0)
 #define Net_InitMapStateHistory(...) ((void)0)
 #define Net_AddWorldToInitialSnapshot(...) ((void)0)
 #define DumpMapStateHistory(...) ((void)0)
@@ -544,6 +544,9 @@ static int osdcmd_password(CCmdFuncPtr parm)
 }
 
 int osdcmd_listplayers(CCmdFuncPtr parm);
+#ifdef _DEBUG
+int osdcmd_bench_netsnapshot(CCmdFuncPtr parm);
+#endif
 
 
 
@@ -611,6 +614,42 @@ static int osdcmd_printtimes(CCmdFuncPtr UNUSED(parm))
                 1000*g_actorMaxMs[i]);
         }
 
+    if (haveac)
+    {
+        uint32_t totalCalls = 0;
+        double totalMs = 0, minMs = 0, maxMs = 0;
+
+        for (int i=0; i<MAXTILES; i++)
+        {
+            if (!g_actorCalls[i])
+                continue;
+
+            minMs = totalCalls ? min(minMs, g_actorMinMs[i]) : g_actorMinMs[i];
+            maxMs = max(maxMs, g_actorMaxMs[i]);
+            totalCalls += g_actorCalls[i];
+            totalMs += g_actorTotalMs[i];
+        }
+
+        Printf("%17s, %8u, %9.3f, %9.3f, %9.3f, %9.3f,\n", "all actors", totalCalls, totalMs,
+            1000*minMs, 1000*totalMs/totalCalls, 1000*maxMs);
+    }
+
+    return OSDCMD_OK;
+}
+
+static int osdcmd_resettimes(CCmdFuncPtr UNUSED(parm))
+{
+    UNREFERENCED_CONST_PARAMETER(parm);
+
+    Bmemset(g_eventCalls, 0, sizeof(g_eventCalls));
+    Bmemset(g_eventTotalMs, 0, sizeof(g_eventTotalMs));
+    Bmemset(g_actorCalls, 0, sizeof(g_actorCalls));
+    Bmemset(g_actorTotalMs, 0, sizeof(g_actorTotalMs));
+    Bmemset(g_actorMaxMs, 0, sizeof(g_actorMaxMs));
+
+    for (double & actorMinMs : g_actorMinMs)
+        actorMinMs = 1e308;
+
     return OSDCMD_OK;
 }
 
@@ -621,6 +660,9 @@ int32_t registerosdcommands(void)
     C_RegisterFunction("connect","connect: connects to a multiplayer game", osdcmd_connect);
     C_RegisterFunction("disconnect","disconnect: disconnects from the local multiplayer game", osdcmd_disconnect);
     C_RegisterFunction("dumpmapstates", "Dumps current snapshots to CL/Srv_MapStates.bin", osdcmd_dumpmapstate);
+#ifdef _DEBUG
+    C_RegisterFunction("bench_netsnapshot", "bench_netsnapshot [players] [updates]: measures world update size and time in a local game", osdcmd_bench_netsnapshot);
+#endif
 #if 0
     C_RegisterFunction("kick","kick <id>: kicks a multiplayer client.  See listplayers.", osdcmd_kick);
     C_RegisterFunction("kickban","kickban <id>: kicks a multiplayer client and prevents them from reconnecting.  See listplayers.", osdcmd_kickban);
@@ -647,6 +689,7 @@ int32_t registerosdcommands(void)
 
 
     C_RegisterFunction("printtimes", "printtimes: prints VM timing statistics", osdcmd_printtimes);
+    C_RegisterFunction("resettimes", "resettimes: clears VM timing statistics", osdcmd_resettimes);
 
     C_RegisterFunction("restartmap", "restartmap: restarts the current map", osdcmd_restartmap);
 	C_RegisterFunction("addlogvar","addlogvar <gamevar>: prints the value of a gamevar", osdcmd_addlogvar);
@@ -839,7 +839,7 @@ static void P_PrepForNewLevel(int playerNum, int gameMode)
     g_curViewscreen    = -1;
     g_cyclerCnt        = 0;
     g_earthquakeTime   = 0;
-    g_interpolationCnt = 0;
+    g_interpolations.Clear();
 
     randomseed  = 1996;
     screenpeek  = myconnectindex;
@@ -1882,7 +1882,7 @@ int G_EnterLevel(int gameMode)
 
     G_ClearFIFO();
 
-    for (int i=g_interpolationCnt-1; i>=0; i--) bakipos[i] = *curipos[i];
+    g_interpolations.Backup();
 
     G_ResetTimers(0);  // Here we go
 
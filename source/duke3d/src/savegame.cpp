@@ -100,7 +100,7 @@ void G_ResetInterpolations(void)
 {
     int32_t k, i;
 
-    g_interpolationCnt = 0;
+    g_interpolations.Clear();
 
     k = headspritestat[STAT_EFFECTOR];
     while (k >= 0)
@@ -134,7 +134,7 @@ void G_ResetInterpolations(void)
         k = nextspritestat[k];
     }
 
-    for (i=g_interpolationCnt-1; i>=0; i--) bakipos[i] = *curipos[i];
+    g_interpolations.Backup();
     for (i = g_animateCnt-1; i>=0; i--)
         G_SetInterpolation(g_animatePtr[i]);
 }
@@ -539,11 +539,15 @@ bool G_SavePlayer(FSaveGameNode *sv)
 		fw.Close();
 		bool res = FinishSavegameWrite();
 
-		if (!g_netServer && ud.multimode < 2)
+		if (res && !g_netServer && ud.multimode < 2)
 		{
-			Printf("Saved: %s\n", fn.GetChars());
-			quoteMgr.InitializeQuote(QUOTE_RESERVED4, "Game Saved");
-			P_DoQuote(QUOTE_RESERVED4, g_player[myconnectindex].ps);
+			OnSavegameWritten([fn](bool ok)
+			{
+				if (!ok) return;
+				Printf("Saved: %s\n", fn.GetChars());
+				quoteMgr.InitializeQuote(QUOTE_RESERVED4, "Game Saved");
+				P_DoQuote(QUOTE_RESERVED4, g_player[myconnectindex].ps);
+			});
 		}
 
 		ready2send = 1;
@@ -33,7 +33,7 @@ BEGIN_DUKE_NS
 #else
 # define SV_MAJOR_VER 1
 #endif
-#define SV_MINOR_VER 7
+#define SV_MINOR_VER 8
 
 #pragma pack(push,1)
 struct savehead_t
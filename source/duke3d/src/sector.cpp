@@ -343,6 +343,7 @@ void G_DoSectorAnimations(void)
         }
 
         *g_animatePtr[animNum] = animPos;
+        sectorGridUpdateWallPtr(g_animatePtr[animNum]);
     }
 }
 
@@ -82,12 +82,7 @@ TArray<uint8_t> DukeSoundEngine::ReadSound(int lumpnum)
 
 void cacheAllSounds(void)
 {
-    auto& sfx = soundEngine->GetSounds();
-    int i = 0;
-    for(auto &snd : sfx)
-    {
-        soundEngine->CacheSound(&snd);
-    }
+    soundEngine->CacheAllSounds();
 }
 
 //==========================================================================
@@ -72,6 +72,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <time.h>
 #include <assert.h>
 #include "gamecvars.h"
+#include "timedemo.h"
 #include "savegamehelp.h"
 #include "c_dispatch.h"
 #include "raze_sound.h"
@@ -1358,6 +1359,10 @@ uint8_t ReadPlaybackInputs()
         fclose(vcrfp);
         vcrfp = NULL;
         bPlayback = kFalse;
+
+        if (TIMEDEMO_GetDemo())
+            TIMEDEMO_DemoEnded();
+
         return kFalse;
     }
 }
@@ -1517,6 +1522,7 @@ static void GameDisplay(void)
 
 static void GameMove(void)
 {
+    FTimeDemoSection timedemo(TDS_Game);
     FixPalette();
 
     if (levelnum == kMap20)
@@ -1863,6 +1869,18 @@ int GameInterface::app_main()
 
     int nMenu = 0; // TEMP
 
+    // -timedemo plays the recording like -playback and quits when it runs out, see ReadPlaybackInputs.
+    const char* timedemo = TIMEDEMO_GetDemo();
+    if (timedemo)
+    {
+        vcrfp = fopen(timedemo, "rb");
+        if (vcrfp == NULL) {
+            I_Error("Can't open demo %s for reading", timedemo);
+        }
+        bPlayback = kTrue;
+        doTitle = kFalse;
+    }
+
 
     if (nNetPlayerCount && forcelevel == -1) {
         forcelevel = 1;
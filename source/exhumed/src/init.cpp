@@ -252,6 +252,7 @@ void SnapSectors(short nSectorA, short nSectorB, short b)
 
     int nCount = 0;
 
+    sectorGridBeginUpdate();
     while (num1 > nCount)
     {
         short dx = nWallB;
@@ -318,6 +319,7 @@ void SnapSectors(short nSectorA, short nSectorB, short b)
         nCount++;
         nWallA++;
     }
+    sectorGridEndUpdate();
 
     if (b) {
         sector[nSectorB].ceilingz = sector[nSectorA].floorz;
@@ -1046,12 +1046,14 @@ void MoveSector(short nSector, int nAngle, int *nXVel, int *nYVel)
             }
         }
 
+        sectorGridBeginUpdate();
         for (int i = 0; i < nWalls; i++)
         {
             dragpoint(startwall, xvect + pStartWall->x, yvect + pStartWall->y, 0);
             pStartWall++;
             startwall++;
         }
+        sectorGridEndUpdate();
 
         pBlockInfo->x += xvect;
         pBlockInfo->y += yvect;
@@ -29,6 +29,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "mmulti.h"
 #include "savegamehelp.h"
 #include "sound.h"
+#include "view.h"
 
 BEGIN_PS_NS
 
@@ -40,6 +41,7 @@ static TArray<SavegameHelper*> sghelpers(TArray<SavegameHelper*>::NoInit);
 
 bool GameInterface::SaveGame(FSaveGameNode* sv)
 {
+    viewSaveInterpolations();
     for (auto sgh : sghelpers) sgh->Save();
     SaveTextureState();
     FinishSavegameWrite();
@@ -50,6 +52,7 @@ bool GameInterface::LoadGame(FSaveGameNode* sv)
 {
 
     for (auto sgh : sghelpers) sgh->Load();
+    viewLoadInterpolations();
     LoadTextureState();
     FinishSavegameRead();
 
@@ -38,6 +38,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "runlist.h"
 #include "v_video.h"
 #include "glbackend/glbackend.h"
+#include "interpolation.h"
 #include <string.h>
 
 BEGIN_PS_NS
@@ -77,63 +78,62 @@ short enemy;
 short nEnemyPal = 0;
 
 #define MAXINTERPOLATIONS MAXSPRITES
-int32_t g_interpolationCnt;
-int32_t oldipos[MAXINTERPOLATIONS];
-int32_t* curipos[MAXINTERPOLATIONS];
-int32_t bakipos[MAXINTERPOLATIONS];
+TInterpolator<int32_t> interpolations;
+
+// Savegames keep the layout of the original fixed size arrays.
+static int32_t g_interpolationCnt;
+static int32_t oldipos[MAXINTERPOLATIONS];
+static int32_t* curipos[MAXINTERPOLATIONS];
+static int32_t bakipos[MAXINTERPOLATIONS];
 
 int viewSetInterpolation(int32_t *const posptr)
 {
-    if (g_interpolationCnt >= MAXINTERPOLATIONS)
+    if (interpolations.Size() >= MAXINTERPOLATIONS)
         return 1;
 
-    for (bssize_t i = 0; i < g_interpolationCnt; ++i)
-        if (curipos[i] == posptr)
-            return 0;
-
-    curipos[g_interpolationCnt] = posptr;
-    oldipos[g_interpolationCnt] = *posptr;
-    g_interpolationCnt++;
+    interpolations.Set(posptr);
     return 0;
 }
 
 void viewStopInterpolation(const int32_t * const posptr)
 {
-    for (bssize_t i = 0; i < g_interpolationCnt; ++i)
-        if (curipos[i] == posptr)
-        {
-            g_interpolationCnt--;
-            oldipos[i] = oldipos[g_interpolationCnt];
-            bakipos[i] = bakipos[g_interpolationCnt];
-            curipos[i] = curipos[g_interpolationCnt];
-        }
+    interpolations.Stop(posptr);
 }
 
 void viewDoInterpolations(int smoothRatio)
 {
-    int32_t ndelta = 0;
-
-    for (bssize_t i = 0, j = 0; i < g_interpolationCnt; ++i)
-    {
-        int32_t const odelta = ndelta;
-        bakipos[i] = *curipos[i];
-        ndelta = (*curipos[i]) - oldipos[i];
-        if (odelta != ndelta)
-            j = mulscale16(ndelta, smoothRatio);
-        *curipos[i] = oldipos[i] + j;
-    }
+    interpolations.Do(smoothRatio);
 }
 
 void viewUpdateInterpolations(void)  //Stick at beginning of G_DoMoveThings
 {
-    for (bssize_t i=g_interpolationCnt-1; i>=0; i--) oldipos[i] = *curipos[i];
+    interpolations.Update();
 }
 
 void viewRestoreInterpolations(void)  //Stick at end of drawscreen
 {
-    int32_t i=g_interpolationCnt-1;
+    interpolations.Restore();
+}
+
+void viewSaveInterpolations(void)
+{
+    g_interpolationCnt = interpolations.Size();
+    for (int32_t i = 0; i < g_interpolationCnt; i++)
+    {
+        curipos[i] = interpolations.GetPointer(i);
+        oldipos[i] = interpolations.GetOldValue(i);
+        bakipos[i] = interpolations.GetBackupValue(i);
+    }
+}
+
+void viewLoadInterpolations(void)
+{
+    interpolations.Clear();
+    if (g_interpolationCnt < 0 || g_interpolationCnt > MAXINTERPOLATIONS)
+        return;
 
-    for (; i>=0; i--) *curipos[i] = bakipos[i];
+    for (int32_t i = 0; i < g_interpolationCnt; i++)
+        interpolations.Add(curipos[i], oldipos[i], bakipos[i]);
 }
 
 void InitView()
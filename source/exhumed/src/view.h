@@ -46,6 +46,8 @@ void viewStopInterpolation(const int32_t * const posptr);
 void viewDoInterpolations(int smoothRatio);
 void viewUpdateInterpolations(void);
 void viewRestoreInterpolations(void);
+void viewSaveInterpolations(void);
+void viewLoadInterpolations(void);
 
 extern fix16_t nDestVertPan[];
 extern short dVertPan[];
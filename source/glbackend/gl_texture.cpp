@@ -44,6 +44,19 @@
 #include "texturemanager.h"
 #include "v_video.h"
 
+//===========================================================================
+// 
+//	Upscaling is only done for true color textures. Indexed ones get
+//	their colors from the palette shader and need to stay unfiltered.
+//
+//===========================================================================
+
+static int GetScaleFlags(FGameTexture* tex, int translation)
+{
+	if (translation & 0x80000000) return 0;
+	return shouldUpscale(tex, UF_Texture) ? CTF_Upscale : 0;
+}
+
 //===========================================================================
 // 
 //	Retrieve the texture to be used.
@@ -89,7 +102,7 @@ bool GLInstance::SetTexture(int picnum, FGameTexture* tex, int paletteid, int sa
 
 	GLInterface.SetBasepalTint(texpick.basepalTint);
 	auto &mat = renderState.mMaterial;
-	mat.mMaterial = FMaterial::ValidateTexture(tex, 0); // todo allow scaling
+	mat.mMaterial = FMaterial::ValidateTexture(tex, GetScaleFlags(tex, texpick.translation));
 	mat.mClampMode = sampler;
 	mat.mTranslation = texpick.translation;
 	mat.mOverrideShader = 0;
@@ -103,6 +116,35 @@ bool GLInstance::SetTexture(int picnum, FGameTexture* tex, int paletteid, int sa
 	return true;
 }
 
+//===========================================================================
+// 
+//	Starts preparing the buffers that ApplyMaterial will need for this
+//	texture so that the expensive parts can run in the background.
+//
+//===========================================================================
+
+void GLInstance::PrecacheTexture(int picnum, FGameTexture* tex, int paletteid)
+{
+	TexturePick texpick;
+	if (!PickTexture(picnum, tex, paletteid, texpick)) return;
+
+	// Only upscaling is worth doing in the background.
+	int scaleflags = GetScaleFlags(tex, texpick.translation);
+	if (!(scaleflags & CTF_Upscale)) return;
+
+	auto mat = FMaterial::ValidateTexture(tex, scaleflags);
+	if (!mat) return;
+
+	MaterialLayerInfo* layer;
+	mat->GetLayer(0, texpick.translation, &layer);
+	layer->layerTexture->PrepareTexBuffer(texpick.translation, layer->scaleFlags | CTF_ProcessData);
+	for (int i = 1; i < mat->NumLayers(); i++)
+	{
+		mat->GetLayer(i, 0, &layer);
+		layer->layerTexture->PrepareTexBuffer(0, layer->scaleFlags | CTF_ProcessData);
+	}
+}
+
 //===========================================================================
 // 
 // stand-ins for the texture system. Nothing of this is used right now, but needs to be present to satisfy the linker
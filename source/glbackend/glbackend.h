@@ -494,6 +494,7 @@ public:
 	}
 
 	bool SetTexture(int globalpicnum, FGameTexture* tex, int palette, int sampleroverride);
+	void PrecacheTexture(int globalpicnum, FGameTexture* tex, int palette);
 };
 
 extern GLInstance GLInterface;
@@ -33,6 +33,7 @@ class BitReader
 		~BitReader();
 		uint32_t GetBit();
 		uint32_t GetBits(uint32_t n);
+		uint32_t PeekBits(uint32_t n);
 		void SkipBits(uint32_t n);
 
 		uint32_t GetSize();
@@ -50,6 +51,37 @@ class BitReader
 		void FillCache();
 };
 
+// The cache holds the whole chunk plus 8 bytes of zero padding, so up to 32 bits can always be
+// fetched with a single 64 bit read. Reading past the end of the chunk returns zero bits.
+
+inline uint32_t BitReader::PeekBits(uint32_t n)
+{
+	uint32_t byte = currentOffset >> 3;
+
+	if (byte >= totalSize)
+		return 0;
+
+	uint64_t word = B_LITTLE64(B_UNBUF64(&Cache[byte])) >> (currentOffset & 7);
+	return (uint32_t)word & (uint32_t)((1ull << n) - 1);
+}
+
+inline uint32_t BitReader::GetBits(uint32_t n)
+{
+	uint32_t ret = PeekBits(n);
+	currentOffset += n;
+	return ret;
+}
+
+inline uint32_t BitReader::GetBit()
+{
+	return GetBits(1);
+}
+
+inline void BitReader::SkipBits(uint32_t n)
+{
+	currentOffset += n;
+}
+
 } // close namespace SmackerCommon
 
 #endif
\ No newline at end of file
@@ -33,6 +33,7 @@ class FileStream
 		bool Open(const char *fileName);
 		bool Is_Open();
 		void Close();
+		bool LoadIntoMemory();
 
 		int32_t ReadBytes(uint8_t *data, uint32_t nBytes);
 
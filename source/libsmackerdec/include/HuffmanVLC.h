@@ -32,7 +32,25 @@ struct VLC
     uint32_t code;
 };
 
-typedef std::vector< std::vector<VLC> > VLCtable;
+// Codes are stored by length. Codes up to lookupBits long are also entered in a lookup table
+// indexed by the next lookupBits bits of the stream, as (symbol << 5) | length. Longer codes,
+// which Smacker files practically never use, have 0 in the table and are searched as before.
+struct VLCtable
+{
+	std::vector< std::vector<VLC> > codes;
+	std::vector<uint32_t> lookup;
+	uint32_t lookupBits;
+
+	VLCtable() : lookupBits(0) {}
+};
+
+const uint32_t kVLCMaxLookupBits = 11;
+
+#ifdef _DEBUG
+// Set by bench_smacker to build no lookup tables at all, so that every code goes through
+// the searches the tables replaced.
+extern bool VLC_NoLookup;
+#endif
 
 uint16_t VLC_GetCodeBits(BitReader &bits, VLCtable &table);
 void     VLC_InitTable  (VLCtable &table, uint32_t maxLength, uint32_t size, int *lengths, uint32_t *bits);
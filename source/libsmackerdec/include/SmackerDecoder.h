@@ -79,6 +79,7 @@ float             Smacker_GetFrameRate         (SmackerHandle &handle);
 void              Smacker_GetPalette           (SmackerHandle &handle, uint8_t *palette);
 void              Smacker_GetFrame             (SmackerHandle &handle, uint8_t *frame);
 void              Smacker_GotoFrame            (SmackerHandle &handle, uint32_t frameNum);
+bool              Smacker_LoadIntoMemory       (SmackerHandle &handle);
 
 const int kMaxAudioTracks = 7;
 
@@ -121,6 +122,7 @@ class SmackerDecoder
 		float GetFrameRate();
 		void GetNextFrame();
 		void GotoFrame(uint32_t frameNum);
+		bool LoadIntoMemory();
 
 	private:
 		SmackerCommon::FileStream file;
@@ -145,6 +147,11 @@ class SmackerDecoder
 		std::vector<int> full_tbl;
 		std::vector<int> type_tbl;
 
+		std::vector<uint32_t> mmap_lookup;
+		std::vector<uint32_t> mclr_lookup;
+		std::vector<uint32_t> full_lookup;
+		std::vector<uint32_t> type_lookup;
+
 		int mmap_last[3], mclr_last[3], full_last[3], type_last[3];
 
 		std::vector<uint32_t> frameSizes;
@@ -158,7 +165,8 @@ class SmackerDecoder
 		int DecodeHeaderTree(SmackerCommon::BitReader &bits, std::vector<int> &recodes, int *last, int size);
 		int DecodeTree(SmackerCommon::BitReader &bits, HuffContext *hc, uint32_t prefix, int length);
 		int DecodeBigTree(SmackerCommon::BitReader &bits, HuffContext *hc, DBCtx *ctx);
-		int GetCode(SmackerCommon::BitReader &bits, std::vector<int> &recode, int *last);
+		void BuildLookup(std::vector<int> &recode, std::vector<uint32_t> &lookup);
+		int GetCode(SmackerCommon::BitReader &bits, std::vector<int> &recode, std::vector<uint32_t> &lookup, int *last);
 		int ReadPacket();
 		int DecodeFrame(uint32_t frameSize);
 		void GetFrameSize(uint32_t &width, uint32_t &height);
@@ -19,6 +19,7 @@
 
 #include "BitReader.h"
 #include <assert.h>
+#include <string.h>
 
 namespace SmackerCommon {
 
@@ -29,8 +30,9 @@ BitReader::BitReader(SmackerCommon::FileStream &file, uint32_t size)
 	this->currentOffset = 0;
 	this->bytesRead = 0;
 
-    this->Cache.Resize(size);
+    this->Cache.Resize(size + 8);
     file.ReadBytes(this->Cache.Data(), size);
+    memset(this->Cache.Data() + size, 0, 8);
 }
 
 BitReader::~BitReader()
@@ -51,40 +53,5 @@ uint32_t BitReader::GetPosition()
 	return currentOffset;
 }
 
-uint32_t BitReader::GetBit()
-{
-	uint32_t ret = (Cache[currentOffset>>3]>>(currentOffset&7))&1;
-    currentOffset++;
-	return ret;
-}
-
-uint32_t BitReader::GetBits(uint32_t n)
-{
-	uint32_t ret = 0;
-
-	int bitsTodo = n;
-
-	uint32_t theShift = 0;
-
-	while (bitsTodo)
-	{
-		uint32_t bit = GetBit();
-		bit <<= theShift;
-
-		theShift++;
-
-		ret |= bit;
-
-		bitsTodo--;
-	}
-
-	return ret;
-}
-
-void BitReader::SkipBits(uint32_t n)
-{
-	GetBits(n);
-}
-
 } // close namespace SmackerCommon
 
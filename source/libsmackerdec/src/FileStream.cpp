@@ -48,6 +48,23 @@ void FileStream::Close()
 	file.Close();
 }
 
+// Replaces the file with a copy in memory, so that it can be read from another thread
+// without going through the file system.
+bool FileStream::LoadIntoMemory()
+{
+	auto pos = file.Tell();
+	file.Seek(0, FileReader::SeekSet);
+
+	bool ok = file.OpenMemoryArray([this](TArray<uint8_t> &buffer)
+	{
+		buffer = file.Read();
+		return buffer.Size() == (unsigned)file.GetLength();
+	});
+
+	file.Seek(pos, FileReader::SeekSet);
+	return ok;
+}
+
 int32_t FileStream::ReadBytes(uint8_t *data, uint32_t nBytes)
 {
 	uint32_t nCount = (uint32_t)file.Read(data, static_cast<int32_t>(nBytes));
@@ -18,26 +18,37 @@
  */
 
 #include <HuffmanVLC.h>
+#include <algorithm>
 
 namespace SmackerCommon {
 
 uint16_t VLC_GetCodeBits(BitReader &bits, VLCtable &table)
 {
+	if (table.lookupBits)
+	{
+		uint32_t entry = table.lookup[bits.PeekBits(table.lookupBits)];
+		if (entry)
+		{
+			bits.SkipBits(entry & 31);
+			return entry >> 5;
+		}
+	}
+
 	uint32_t codeBits = 0;
 
 	// search each length array
-	for (uint32_t i = 0; i < table.size(); i++)
+	for (uint32_t i = 0; i < table.codes.size(); i++)
 	{
 		// get and add a new bit to codeBits
 		uint32_t theBit = bits.GetBit() << i;
 		codeBits |= theBit;
 
 		// search for a code match
-		for (uint32_t j = 0; j < table[i].size(); j++)
+		for (uint32_t j = 0; j < table.codes[i].size(); j++)
 		{
-			if (codeBits == table[i][j].code)
+			if (codeBits == table.codes[i][j].code)
 			{
-				return table[i][j].symbol;
+				return table.codes[i][j].symbol;
 			}
 		}
 	}
@@ -46,9 +57,13 @@ uint16_t VLC_GetCodeBits(BitReader &bits, VLCtable &table)
 	return 0;
 }
 
+#ifdef _DEBUG
+bool VLC_NoLookup;
+#endif
+
 void VLC_InitTable(VLCtable &table, uint32_t maxLength, uint32_t size, int *lengths, uint32_t *bits)
 {
-	table.resize(maxLength);
+	table.codes.resize(maxLength);
 
 	for (uint32_t i = 0; i < size; i++)
 	{
@@ -59,13 +74,37 @@ void VLC_InitTable(VLCtable &table, uint32_t maxLength, uint32_t size, int *leng
 		uint32_t codeLength = lengths[i];
 
 		if (codeLength)
-			table[codeLength - 1].push_back(newCode);
+			table.codes[codeLength - 1].push_back(newCode);
+	}
+
+#ifdef _DEBUG
+	if (VLC_NoLookup)
+	{
+		table.lookupBits = 0;
+		table.lookup.clear();
+		return;
+	}
+#endif
+
+	// Codes are read LSB first, so a code of length n fills every entry whose low n bits match it.
+	table.lookupBits = std::min(maxLength, kVLCMaxLookupBits);
+	table.lookup.assign(size_t(1) << table.lookupBits, 0);
+
+	for (uint32_t length = 1; length <= table.lookupBits; length++)
+	{
+		for (auto &code : table.codes[length - 1])
+		{
+			for (uint32_t index = code.code; index < table.lookup.size(); index += 1 << length)
+			{
+				table.lookup[index] = (code.symbol << 5) | length;
+			}
+		}
 	}
 }
 
 uint32_t VLC_GetSize(VLCtable &table)
 {
-	return table.size();
+	return table.codes.size();
 }
 
 } // close namespace SmackerCommon
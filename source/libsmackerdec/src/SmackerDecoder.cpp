@@ -49,6 +49,11 @@
 #include <algorithm>
 #include "compat.h"
 #include "baselayer.h"
+#ifdef _DEBUG
+#include "c_dispatch.h"
+#include "m_crc32.h"
+#include "stats.h"
+#endif
 
 std::vector<class SmackerDecoder*> classInstances;
 
@@ -163,6 +168,13 @@ void Smacker_GotoFrame(SmackerHandle &handle, uint32_t frameNum)
 	classInstances[handle.instanceIndex]->GotoFrame(frameNum);
 }
 
+/* Read the rest of the file into memory, after which the decoder may be used from any thread.
+ */
+bool Smacker_LoadIntoMemory(SmackerHandle &handle)
+{
+	return classInstances[handle.instanceIndex]->LoadIntoMemory();
+}
+
 SmackerDecoder::SmackerDecoder()
 {
 	isVer4 = false;
@@ -236,6 +248,9 @@ const int kFlagRingFrame = 0x01;
 const int kTreeBits = 9;
 const int kSMKnode = 0x80000000;
 
+// header tree lookups: (index into the recode table << 5) | number of bits
+const int kLookupBits = 10;
+
 const char *kSMK2iD = "SMK2";
 const char *kSMK4iD = "SMK4";
 
@@ -269,14 +284,62 @@ static void last_reset(std::vector<int> &recode, int *last) {
     recode[last[0]] = recode[last[1]] = recode[last[2]] = 0;
 }
 
+/**
+ * Build the lookup table for a header tree
+ *
+ * For every possible value of the next kLookupBits bits, this stores where walking the tree
+ * with them ends up. That is a leaf for all but the longest codes, so GetCode can usually
+ * skip the walk. Leaves are stored by index since their values change with the code history.
+ */
+void SmackerDecoder::BuildLookup(std::vector<int> &recode, std::vector<uint32_t> &lookup)
+{
+	// invalid paths end up at this leaf
+	int errorLeaf = recode.size();
+	recode.push_back(0);
+
+#ifdef _DEBUG
+	// an entry of 0 starts the walk at the root without consuming any bits
+	if (SmackerCommon::VLC_NoLookup)
+	{
+		lookup.assign(1 << kLookupBits, 0);
+		return;
+	}
+#endif
+
+	lookup.resize(1 << kLookupBits);
+
+	for (int i = 0; i < (1 << kLookupBits); i++)
+	{
+		int index = 0;
+		int length = 0;
+
+		while (length < kLookupBits && (recode[index] & kSMKnode))
+		{
+			if ((i >> length) & 1)
+				index += recode[index] & (~kSMKnode);
+			index++;
+			length++;
+
+			if (index >= errorLeaf)
+			{
+				index = errorLeaf;
+				break;
+			}
+		}
+
+		lookup[i] = (index << 5) | length;
+	}
+}
+
 /* get code and update history */
-int SmackerDecoder::GetCode(SmackerCommon::BitReader &bits, std::vector<int> &recode, int *last)
+int SmackerDecoder::GetCode(SmackerCommon::BitReader &bits, std::vector<int> &recode, std::vector<uint32_t> &lookup, int *last)
 {
-	int *table = &recode[0];
+	uint32_t entry = lookup[bits.PeekBits(kLookupBits)];
+	bits.SkipBits(entry & 31);
 
-    int v, b;
+	int *table = &recode[entry >> 5];
 
-    b = bits.GetPosition();
+    int v;
 
     while (*table & kSMKnode)
 	{
@@ -285,7 +348,6 @@ int SmackerDecoder::GetCode(SmackerCommon::BitReader &bits, std::vector<int> &re
         table++;
     }
     v = *table;
-    b = bits.GetPosition() - b;
 
     if (v != recode[last[0]]) {
         recode[last[2]] = recode[last[1]];
@@ -696,6 +758,11 @@ bool SmackerDecoder::DecodeHeaderTrees()
 	uint32_t left = bits.GetSize() - bits.GetPosition();
 	bits.SkipBits(left);
 
+	BuildLookup(mmap_tbl, mmap_lookup);
+	BuildLookup(mclr_tbl, mclr_lookup);
+	BuildLookup(full_tbl, full_lookup);
+	BuildLookup(type_tbl, type_lookup);
+
 	return true;
 }
 
@@ -704,6 +771,11 @@ void SmackerDecoder::GetNextFrame()
 	ReadPacket();
 }
 
+bool SmackerDecoder::LoadIntoMemory()
+{
+	return file.LoadIntoMemory();
+}
+
 int SmackerDecoder::ReadPacket()
 {
 	// test-remove
@@ -818,7 +890,7 @@ int SmackerDecoder::DecodeFrame(uint32_t frameSize)
 		int type, run, mode;
         uint16_t pix;
 
-        type = GetCode(bits, type_tbl, type_last);
+        type = GetCode(bits, type_tbl, type_lookup, type_last);
         run = block_runs[(type >> 2) & 0x3F];
         switch (type & 3)
 		{
@@ -827,8 +899,8 @@ int SmackerDecoder::DecodeFrame(uint32_t frameSize)
 			{
                 int clr, map;
                 int hi, lo;
-                clr = GetCode(bits, mclr_tbl, mclr_last);
-                map = GetCode(bits, mmap_tbl, mmap_last);
+                clr = GetCode(bits, mclr_tbl, mclr_lookup, mclr_last);
+                map = GetCode(bits, mmap_tbl, mmap_lookup, mmap_last);
 
                 out = picture + (blk / bw) * (stride * 4) + (blk % bw) * 4;
 
@@ -862,12 +934,12 @@ int SmackerDecoder::DecodeFrame(uint32_t frameSize)
                 case 0:
                     for (i = 0; i < 4; i++)
 					{
-                        pix = GetCode(bits, full_tbl, full_last);
+                        pix = GetCode(bits, full_tbl, full_lookup, full_last);
 // FIX                        AV_WL16(out+2, pix);
 						out[2] = pix & 0xff;
 						out[3] = pix >> 8;
 
-                        pix = GetCode(bits, full_tbl, full_last);
+                        pix = GetCode(bits, full_tbl, full_lookup, full_last);
 // FIX                        AV_WL16(out, pix);
 						out[0] = pix & 0xff;
 						out[1] = pix >> 8;
@@ -875,14 +947,14 @@ int SmackerDecoder::DecodeFrame(uint32_t frameSize)
                     }
                     break;
                 case 1:
-                    pix = GetCode(bits, full_tbl, full_last);
+                    pix = GetCode(bits, full_tbl, full_lookup, full_last);
                     out[0] = out[1] = pix & 0xFF;
                     out[2] = out[3] = pix >> 8;
                     out += stride;
                     out[0] = out[1] = pix & 0xFF;
                     out[2] = out[3] = pix >> 8;
                     out += stride;
-                    pix = GetCode(bits, full_tbl, full_last);
+                    pix = GetCode(bits, full_tbl, full_lookup, full_last);
                     out[0] = out[1] = pix & 0xFF;
                     out[2] = out[3] = pix >> 8;
                     out += stride;
@@ -894,8 +966,8 @@ int SmackerDecoder::DecodeFrame(uint32_t frameSize)
                     for (i = 0; i < 2; i++)
 					{
                         uint16_t pix1, pix2;
-                        pix2 = GetCode(bits, full_tbl, full_last);
-                        pix1 = GetCode(bits, full_tbl, full_last);
+                        pix2 = GetCode(bits, full_tbl, full_lookup, full_last);
+                        pix1 = GetCode(bits, full_tbl, full_lookup, full_last);
 
 // FIX                        AV_WL16(out, pix1);
 // FIX                        AV_WL16(out+2, pix2);
@@ -1155,3 +1227,78 @@ uint32_t SmackerDecoder::GetAudioData(uint32_t trackIndex, int16_t *audioBuffer)
 
 	return track->bytesReadThisFrame;
 }
+
+#ifdef _DEBUG
+/**
+ * Decode a file as fast as possible and checksum every frame's picture, palette and audio
+ */
+static bool BenchDecode(const char *fileName, bool noLookup, TArray<uint32_t> &checksums, double &time)
+{
+	SmackerDecoder decoder;
+	cycle_t timer;
+
+	// the header tree tables are built when the file is opened, the audio tables for every frame
+	SmackerCommon::VLC_NoLookup = noLookup;
+	timer.Reset();
+	timer.Clock();
+
+	bool opened = decoder.Open(fileName);
+
+	uint32_t nFrames = opened ? decoder.GetNumFrames() : 0;
+	TArray<uint8_t> frame(opened ? decoder.frameWidth * decoder.frameHeight : 0, true);
+	TArray<uint8_t> audio;
+	uint8_t palette[768];
+
+	if (opened)
+		audio.Resize(std::max(decoder.GetAudioTrackDetails(0).idealBufferSize, 1u));
+	checksums.Resize(nFrames);
+
+	for (uint32_t i = 0; i < nFrames; i++)
+	{
+		decoder.GetNextFrame();
+		decoder.GetFrame(frame.Data());
+		decoder.GetPalette(palette);
+		uint32_t audioBytes = std::min(decoder.GetAudioData(0, (int16_t*)audio.Data()), audio.Size());
+
+		uint32_t crc = Bcrc32(frame.Data(), frame.Size(), 0);
+		crc = Bcrc32(palette, 768, crc);
+		checksums[i] = Bcrc32(audio.Data(), audioBytes, crc);
+	}
+
+	timer.Unclock();
+	SmackerCommon::VLC_NoLookup = false;
+
+	time = timer.TimeMS();
+	return opened;
+}
+
+/**
+ * Compares decoding with the Huffman lookup tables against the bit by bit searches they replaced
+ */
+CCMD(bench_smacker)
+{
+	if (argv.argc() < 2)
+	{
+		Printf("Usage: bench_smacker <file.smk>\n");
+		return;
+	}
+
+	TArray<uint32_t> searchChecksums, lookupChecksums;
+	double searchTime, lookupTime;
+
+	if (!BenchDecode(argv[1], true, searchChecksums, searchTime) || !BenchDecode(argv[1], false, lookupChecksums, lookupTime))
+		return;
+
+	int mismatches = 0;
+	for (unsigned i = 0; i < searchChecksums.Size(); i++)
+		if (searchChecksums[i] != lookupChecksums[i])
+			mismatches++;
+
+	unsigned nFrames = searchChecksums.Size();
+	Printf("bench_smacker: %s, %u frames\n", argv[1], nFrames);
+	Printf("  bit by bit:    %.3f ms, %.1f fps\n", searchTime, searchTime > 0 ? nFrames * 1000. / searchTime : 0.);
+	Printf("  lookup tables: %.3f ms, %.1f fps\n", lookupTime, lookupTime > 0 ? nFrames * 1000. / lookupTime : 0.);
+	if (mismatches)
+		Printf(TEXTCOLOR_RED "  %d mismatches!\n", mismatches);
+}
+#endif
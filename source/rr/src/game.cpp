@@ -40,6 +40,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "cmdline.h"
 #include "palette.h"
 #include "gamecvars.h"
+#include "timedemo.h"
 #include "gameconfigfile.h"
 #include "printf.h"
 #include "m_argv.h"
@@ -7424,6 +7425,7 @@ GAME_STATIC GAME_INLINE int32_t G_MoveLoop()
 
 int G_DoMoveThings(void)
 {
+    FTimeDemoSection timedemo(TDS_Game);
     if (DEER)
         sub_579A0();
     ud.camerasprite = -1;
@@ -443,6 +443,40 @@ static int osdcmd_printtimes(CCmdFuncPtr UNUSED(parm))
                 1000*g_actorMaxMs[i]);
         }
 
+    if (haveac)
+    {
+        uint32_t totalCalls = 0;
+        double totalMs = 0, minMs = 0, maxMs = 0;
+
+        for (int i=0; i<MAXTILES; i++)
+        {
+            if (!g_actorCalls[i])
+                continue;
+
+            minMs = totalCalls ? min(minMs, g_actorMinMs[i]) : g_actorMinMs[i];
+            maxMs = max(maxMs, g_actorMaxMs[i]);
+            totalCalls += g_actorCalls[i];
+            totalMs += g_actorTotalMs[i];
+        }
+
+        Printf("%17s, %8u, %9.3f, %9.3f, %9.3f, %9.3f,\n", "all actors", totalCalls, totalMs,
+            1000*minMs, 1000*totalMs/totalCalls, 1000*maxMs);
+    }
+
+    return OSDCMD_OK;
+}
+
+static int osdcmd_resettimes(CCmdFuncPtr UNUSED(parm))
+{
+    UNREFERENCED_CONST_PARAMETER(parm);
+
+    Bmemset(g_actorCalls, 0, sizeof(g_actorCalls));
+    Bmemset(g_actorTotalMs, 0, sizeof(g_actorTotalMs));
+    Bmemset(g_actorMaxMs, 0, sizeof(g_actorMaxMs));
+
+    for (double & actorMinMs : g_actorMinMs)
+        actorMinMs = 1e308;
+
     return OSDCMD_OK;
 }
 
@@ -484,6 +518,7 @@ int32_t registerosdcommands(void)
 #endif
 
     C_RegisterFunction("printtimes", "printtimes: prints VM timing statistics", osdcmd_printtimes);
+    C_RegisterFunction("resettimes", "resettimes: clears VM timing statistics", osdcmd_resettimes);
 
     C_RegisterFunction("restartmap", "restartmap: restarts the current map", osdcmd_restartmap);
 
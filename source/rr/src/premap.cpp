@@ -575,7 +575,8 @@ void G_CacheMapData(void)
 
     starttime = timerGetTicks();
 
-    cacheAllSounds();
+    // the sounds get decoded while the textures are loaded.
+    startCachingAllSounds();
     G_PrecacheSprites();
 
     for (i=0; i<numwalls; i++)
@@ -660,6 +661,8 @@ void G_CacheMapData(void)
 
     Bmemset(gotpic, 0, sizeof(gotpic));
 
+    cacheAllSounds();
+
     endtime = timerGetTicks();
     Printf("Cache time: %dms\n", endtime-starttime);
 }
@@ -1156,7 +1159,7 @@ static void resetprestat(int playerNum, int gameMode)
     tempwallptr        = 0;
     g_curViewscreen    = -1;
     g_earthquakeTime   = 0;
-    g_interpolationCnt = 0;
+    g_interpolations.Clear();
 
     if (RRRA)
     {
@@ -2474,7 +2477,7 @@ int G_EnterLevel(int gameMode)
 
     G_ClearFIFO();
 
-    for (i=g_interpolationCnt-1; i>=0; i--) bakipos[i] = *curipos[i];
+    g_interpolations.Backup();
 
     g_player[myconnectindex].ps->over_shoulder_on = 0;
 
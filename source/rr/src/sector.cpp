@@ -461,6 +461,7 @@ void G_DoSectorAnimations(void)
         }
 
         *g_animatePtr[animNum] = animPos;
+        sectorGridUpdateWallPtr(g_animatePtr[animNum]);
     }
 }
 
@@ -4846,6 +4847,7 @@ void G_DoFurniture(int wallNum, int sectNum, int playerNum)
     {
         if (!S_CheckSoundPlaying(g_player[playerNum].ps->i, 389))
             A_PlaySound(389, g_player[playerNum].ps->i);
+        sectorGridBeginUpdate();
         for (i = startwall; i < endwall; i++)
         {
             int32_t x, y;
@@ -4867,10 +4869,12 @@ void G_DoFurniture(int wallNum, int sectNum, int playerNum)
                     break;
             }
         }
+        sectorGridEndUpdate();
     }
     else
     {
         speed -= 2;
+        sectorGridBeginUpdate();
         for (i = startwall; i < endwall; i++)
         {
             int32_t x, y;
@@ -4892,6 +4896,7 @@ void G_DoFurniture(int wallNum, int sectNum, int playerNum)
                     break;
             }
         }
+        sectorGridEndUpdate();
     }
 }
 
@@ -4986,6 +4991,7 @@ void G_DoJailDoor(void)
             {
                 startWall = sector[g_jailDoorSect[i]].wallptr;
                 endWall = startWall + sector[g_jailDoorSect[i]].wallnum - 1;
+                sectorGridBeginUpdate();
                 for (j = startWall; j <= endWall; j++)
                 {
                     int32_t x, y;
@@ -5008,6 +5014,7 @@ void G_DoJailDoor(void)
                     }
                     dragpoint(j, x, y, 0);
                 }
+                sectorGridEndUpdate();
             }
         }
         if (g_jailDoorOpen[i] == 3)
@@ -5037,6 +5044,7 @@ void G_DoJailDoor(void)
             {
                 startWall = sector[g_jailDoorSect[i]].wallptr;
                 endWall = startWall + sector[g_jailDoorSect[i]].wallnum - 1;
+                sectorGridBeginUpdate();
                 for (j = startWall; j <= endWall; j++)
                 {
                     int32_t x, y;
@@ -5059,6 +5067,7 @@ void G_DoJailDoor(void)
                     }
                     dragpoint(j, x, y, 0);
                 }
+                sectorGridEndUpdate();
             }
         }
     }
@@ -5103,6 +5112,7 @@ void G_MoveMineCart(void)
             {
                 startWall = sector[g_mineCartSect[i]].wallptr;
                 endWall = startWall + sector[g_mineCartSect[i]].wallnum - 1;
+                sectorGridBeginUpdate();
                 for (j = startWall; j <= endWall; j++)
                 {
                     int32_t x, y;
@@ -5125,6 +5135,7 @@ void G_MoveMineCart(void)
                     }
                     dragpoint(j, x, y, 0);
                 }
+                sectorGridEndUpdate();
             }
         }
         if (g_mineCartOpen[i] == 2)
@@ -5154,6 +5165,7 @@ void G_MoveMineCart(void)
             {
                 startWall = sector[g_mineCartSect[i]].wallptr;
                 endWall = startWall + sector[g_mineCartSect[i]].wallnum - 1;
+                sectorGridBeginUpdate();
                 for (j = startWall; j <= endWall; j++)
                 {
                     int32_t x, y;
@@ -5176,6 +5188,7 @@ void G_MoveMineCart(void)
                     }
                     dragpoint(j, x, y, 0);
                 }
+                sectorGridEndUpdate();
             }
         }
         startWall = sector[g_mineCartChildSect[i]].wallptr;
@@ -79,14 +79,14 @@ TArray<uint8_t> DukeSoundEngine::ReadSound(int lumpnum)
 //
 //==========================================================================
 
+void startCachingAllSounds(void)
+{
+    soundEngine->StartCachingAllSounds();
+}
+
 void cacheAllSounds(void)
 {
-    auto& sfx = soundEngine->GetSounds();
-    int i = 0;
-    for(auto &snd : sfx)
-    {
-        soundEngine->CacheSound(&snd);
-    }
+    soundEngine->CacheAllSounds();
 }
 
 //==========================================================================
@@ -55,6 +55,7 @@ int A_CheckAnySoundPlaying(int spriteNum);
 int S_CheckSoundPlaying(int soundNum);
 inline int S_CheckSoundPlaying(int sprnum, int soundNum) { return S_CheckSoundPlaying(soundNum); }
 inline void S_ClearSoundLocks(void) {}
+void startCachingAllSounds(void);
 void cacheAllSounds(void);
 void S_MenuSound(void);
 void S_PlayLevelMusicOrNothing(unsigned int);
@@ -44,7 +44,7 @@ Prepared for public release: 03/28/2005 - Charlie Wiederhold, 3D Realms
 #include "anim.h"
 #include "../glbackend/glbackend.h"
 #include "v_2ddrawer.h"
-#include "animtexture.h"
+#include "movieplayer.h"
 
 #include "common_game.h"
 
@@ -241,33 +241,27 @@ playanm(short anim_num)
     DSPRINTF(ds,"PlayAnm");
     MONO_PRINT(ds);
 
-    TArray<uint8_t> buffer;
-    auto fr = fileSystem.OpenFileReader(ANIMname[ANIMnum]);
+    // the frames are decoded on the player's thread, but shown at the pace set by the callbacks below.
+    auto decoder = OpenMovieDecoder(ANIMname[ANIMnum]);
 
-    if (!fr.isOpen())
+    if (!decoder)
         goto ENDOFANIMLOOP;
 
-    buffer = fr.ReadPadded(1);
-    fr.Close();
-
-    DSPRINTF(ds,"PlayAnm - Palette Stuff");
-    MONO_PRINT(ds);
-
-    ANIM_LoadAnim(buffer.Data(), buffer.Size()-1);
-    ANIMnumframes = ANIM_NumFrames();
-    numframes = ANIMnumframes;
-
-
     videoClearViewableArea(0L);
 
     {
-        AnimTextures animtex;
-        animtex.SetSize(320, 200);
+        MoviePlayer player(decoder);
+        FGameTexture* tex = nullptr;
+
+        // ANM frames are numbered from 1
+        ANIMnumframes = player.GetFrameCount() + 1;
+        numframes = ANIMnumframes;
+
         if (ANIMnum == 1)
         {
             // draw the first frame
-            animtex.SetFrame(ANIM_GetPalette(), ANIM_DrawFrame(1));
-            rotatesprite_fs(160 << 16, 100 << 16, 65536, 0, -1, 0, 0, 2 | 8 | 64, animtex.GetFrame());
+            tex = player.NextFrame();
+            if (tex) rotatesprite_fs(160 << 16, 100 << 16, 65536, 0, -1, 0, 0, 2 | 8 | 64, tex);
         }
 
         SoundState = 0;
@@ -310,8 +304,9 @@ playanm(short anim_num)
             }
 
 	        videoClearViewableArea(0L);
-            animtex.SetFrame(ANIM_GetPalette(), ANIM_DrawFrame(i));
-            rotatesprite_fs(160 << 16, 100 << 16, 65536, 0, -1, 0, 0, 2 | 8 | 64, animtex.GetFrame());
+            if (i > 1 || !tex)
+                tex = player.NextFrame();
+            if (tex) rotatesprite_fs(160 << 16, 100 << 16, 65536, 0, -1, 0, 0, 2 | 8 | 64, tex);
             videoNextPage();
             handleevents();
             if (inputState.CheckAllInput())
@@ -332,6 +327,5 @@ ENDOFANIMLOOP:
     videoNextPage();
 
     inputState.ClearAllInput();
-    ANIM_FreeAnim();
 }
 END_SW_NS
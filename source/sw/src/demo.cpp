@@ -42,6 +42,7 @@ Prepared for public release: 03/28/2005 - Charlie Wiederhold, 3D Realms
 
 #include "player.h"
 #include "menus.h"
+#include "timedemo.h"
 
 BEGIN_SW_NS
 
@@ -548,7 +549,11 @@ DemoPlayBack(void)
 
         // demo is over
         if (DemoDone)
+        {
+            if (TIMEDEMO_GetDemo())
+                TIMEDEMO_DemoEnded();
             break;
+        }
 
         if (QuitFlag)
         {
@@ -1751,7 +1751,7 @@ PostDraw(void)
     {
         if (User[i])
         {
-            FreeMem(User[i]);
+            UserPool.Free(User[i]);
             User[i] = NULL;
         }
 
@@ -1865,7 +1865,7 @@ void PreDrawStackedWater(void)
                 if (New >= 0)
                 {
                     // spawn a user
-                    User[New] = nu = (USERp)CallocMem(sizeof(USER), 1);
+                    User[New] = nu = UserPool.Alloc(New);
                     ASSERT(nu != NULL);
 
                     nu->xchange = -989898;
@@ -103,6 +103,7 @@ Things required to make savegames work:
 #include "secrets.h"
 
 #include "osdcmds.h"
+#include "timedemo.h"
 
 //#include "crc32.h"
 
@@ -786,6 +787,19 @@ bool InitGame()
 
     LoadDemoRun();
 
+    // -timedemo replaces the demo loop with just the given demo, DemoPlayBack quits once it is done.
+    const char* timedemo = TIMEDEMO_GetDemo();
+    if (timedemo)
+    {
+        if (strlen(timedemo) >= sizeof(DemoName[0]))
+            I_Error("Demo file name %s is too long", timedemo);
+
+        memset(DemoName, '\0', sizeof(DemoName));
+        strcpy(DemoName[0], timedemo);
+        DemoMode = TRUE;
+        DemoPlaying = TRUE;
+    }
+
 	TileFiles.LoadArtSet("tiles%03d.art");
 
     Connect();
@@ -926,7 +940,8 @@ void InitLevelGlobals(void)
     AnimCnt = 0;
     left_foot = FALSE;
     screenpeek = myconnectindex;
-    numinterpolations = short_numinterpolations = 0;
+    interpolations.Clear();
+    short_interpolations.Clear();
 
     gNet.TimeLimitClock = gNet.TimeLimit;
 
@@ -968,6 +983,7 @@ InitLevel(void)
         Mus_Stop();
 
     InitLevelGlobals2();
+    FAF_InvalidateLevelSectors();
     if (DemoMode)
     {
         Level = 0;
@@ -1179,6 +1195,7 @@ TerminateLevel(void)
 //HEAP_CHECK();
 
     DemoTerm();
+    FAF_InvalidateLevelSectors();
 
     // Free any track points
     for (ndx = 0; ndx < MAX_TRACKS; ndx++)
@@ -1231,7 +1248,7 @@ TerminateLevel(void)
         {
             ////DSPRINTF(ds,"Sect User Free %d",sectu-SectUser);
             //MONO_PRINT(ds);
-            FreeMem(*sectu);
+            SectUserPool.Free(*sectu);
             *sectu = NULL;
         }
     }
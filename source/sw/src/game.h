@@ -47,6 +47,7 @@ Prepared for public release: 03/28/2005 - Charlie Wiederhold, 3D Realms
 #include "pragmas.h"
 #include "gamecvars.h"
 #include "raze_sound.h"
+#include "sidepool.h"
 
 BEGIN_SW_NS
 
@@ -1739,6 +1740,7 @@ typedef struct
 
 
 extern USERp User[MAXSPRITES];
+extern TSidePool<USER, MAXSPRITES> UserPool;
 
 typedef struct
 {
@@ -1850,6 +1852,7 @@ typedef struct
 } SECT_USER, *SECT_USERp;
 
 extern SECT_USERp SectUser[MAXSECTORS];
+extern TSidePool<SECT_USER, MAXSECTORS> SectUserPool;
 SECT_USERp SpawnSectUser(short sectnum);
 
 
@@ -2470,6 +2473,7 @@ void computergetinput(int snum,SW_PACKET *syn); // jplayer.c
 
 void DrawOverlapRoom(int tx,int ty,int tz,fix16_t tq16ang,fix16_t tq16horiz,short tsectnum);    // rooms.c
 void SetupMirrorTiles(void);    // rooms.c
+void FAF_InvalidateLevelSectors(void); // rooms.c
 SWBOOL FAF_Sector(short sectnum); // rooms.c
 int GetZadjustment(short sectnum,short hitag);  // rooms.c
 
@@ -33,82 +33,36 @@ Prepared for public release: 03/28/2005 - Charlie Wiederhold, 3D Realms
 
 BEGIN_SW_NS
 
-int numinterpolations = 0;
-int oldipos[MAXINTERPOLATIONS];
-int bakipos[MAXINTERPOLATIONS];
-int *curipos[MAXINTERPOLATIONS];
+TInterpolator<int> interpolations;
 
 void setinterpolation(int *posptr)
 {
-    int i;
-
-    if (numinterpolations >= MAXINTERPOLATIONS)
+    if (interpolations.Size() >= MAXINTERPOLATIONS)
         return;
 
-    for (i = numinterpolations - 1; i >= 0; i--)
-    {
-        if (curipos[i] == posptr)
-            return;
-    }
-
-    curipos[numinterpolations] = posptr;
-    oldipos[numinterpolations] = *posptr;
-    numinterpolations++;
+    interpolations.Set(posptr);
 }
 
 void stopinterpolation(int *posptr)
 {
-    int i;
-
-    for (i = numinterpolations - 1; i >= 0; i--)
-    {
-        if (curipos[i] == posptr)
-        {
-            numinterpolations--;
-            oldipos[i] = oldipos[numinterpolations];
-            bakipos[i] = bakipos[numinterpolations];
-            curipos[i] = curipos[numinterpolations];
-        }
-    }
+    interpolations.Stop(posptr);
 }
 
 void updateinterpolations(void)                  // Stick at beginning of domovethings
 {
-    int i;
-
-    for (i = numinterpolations - 1; i >= 0; i--)
-        oldipos[i] = *curipos[i];
+    interpolations.Update();
 }
 
 // must call restore for every do interpolations
 // make sure you don't exit
 void dointerpolations(int smoothratio)                      // Stick at beginning of drawscreen
 {
-    int i, j, odelta, ndelta;
-
-    ndelta = 0;
-    j = 0;
-
-    for (i = numinterpolations - 1; i >= 0; i--)
-    {
-        bakipos[i] = *curipos[i];
-
-        odelta = ndelta;
-        ndelta = (*curipos[i]) - oldipos[i];
-
-        if (odelta != ndelta)
-            j = mulscale16(ndelta, smoothratio);
-
-        *curipos[i] = oldipos[i] + j;
-    }
+    interpolations.Do(smoothratio);
 }
 
 void restoreinterpolations(void)                 // Stick at end of drawscreen
 {
-    int i;
-
-    for (i = numinterpolations - 1; i >= 0; i--)
-        *curipos[i] = bakipos[i];
+    interpolations.Restore();
 }
 
 END_SW_NS
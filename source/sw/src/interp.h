@@ -29,20 +29,15 @@ Prepared for public release: 03/28/2005 - Charlie Wiederhold, 3D Realms
 #define INTERP_H
 
 #include "build.h"
+#include "interpolation.h"
 
 BEGIN_SW_NS
 
 #define SHORT_MAXINTERPOLATIONS 256
-extern short short_numinterpolations;
-extern short short_oldipos[SHORT_MAXINTERPOLATIONS];
-extern short short_bakipos[SHORT_MAXINTERPOLATIONS];
-extern short *short_curipos[SHORT_MAXINTERPOLATIONS];
+extern TInterpolator<short> short_interpolations;
 
 #define MAXINTERPOLATIONS MAXSPRITES
-extern int numinterpolations;
-extern int oldipos[MAXINTERPOLATIONS];
-extern int bakipos[MAXINTERPOLATIONS];
-extern int *curipos[MAXINTERPOLATIONS];
+extern TInterpolator<int> interpolations;
 
 void setinterpolation(int *posptr);
 void stopinterpolation(int *posptr);
@@ -33,82 +33,36 @@ Prepared for public release: 03/28/2005 - Charlie Wiederhold, 3D Realms
 
 BEGIN_SW_NS
 
-short short_numinterpolations = 0;
-short short_oldipos[SHORT_MAXINTERPOLATIONS];
-short short_bakipos[SHORT_MAXINTERPOLATIONS];
-short *short_curipos[SHORT_MAXINTERPOLATIONS];
+TInterpolator<short> short_interpolations;
 
 void short_setinterpolation(short *posptr)
 {
-    int i;
-
-    if (short_numinterpolations >= SHORT_MAXINTERPOLATIONS)
+    if (short_interpolations.Size() >= SHORT_MAXINTERPOLATIONS)
         return;
 
-    for (i = short_numinterpolations - 1; i >= 0; i--)
-    {
-        if (short_curipos[i] == posptr)
-            return;
-    }
-
-    short_curipos[short_numinterpolations] = posptr;
-    short_oldipos[short_numinterpolations] = *posptr;
-    short_numinterpolations++;
+    short_interpolations.Set(posptr);
 }
 
 void short_stopinterpolation(short *posptr)
 {
-    int i;
-
-    for (i = short_numinterpolations - 1; i >= 0; i--)
-    {
-        if (short_curipos[i] == posptr)
-        {
-            short_numinterpolations--;
-            short_oldipos[i] = short_oldipos[short_numinterpolations];
-            short_bakipos[i] = short_bakipos[short_numinterpolations];
-            short_curipos[i] = short_curipos[short_numinterpolations];
-        }
-    }
+    short_interpolations.Stop(posptr);
 }
 
 void short_updateinterpolations(void)                  // Stick at beginning of domovethings
 {
-    int i;
-
-    for (i = short_numinterpolations - 1; i >= 0; i--)
-        short_oldipos[i] = *short_curipos[i];
+    short_interpolations.Update();
 }
 
 // must call restore for every do interpolations
 // make sure you don't exit
 void short_dointerpolations(int smoothratio)                      // Stick at beginning of drawscreen
 {
-    int i, j, odelta, ndelta;
-
-    ndelta = 0;
-    j = 0;
-
-    for (i = short_numinterpolations - 1; i >= 0; i--)
-    {
-        short_bakipos[i] = *short_curipos[i];
-
-        odelta = ndelta;
-        ndelta = (*short_curipos[i]) - short_oldipos[i];
-
-        if (odelta != ndelta)
-            j = mulscale16(ndelta, smoothratio);
-
-        *short_curipos[i] = short_oldipos[i] + j;
-    }
+    short_interpolations.Do(smoothratio);
 }
 
 void short_restoreinterpolations(void)                 // Stick at end of drawscreen
 {
-    int i;
-
-    for (i = short_numinterpolations - 1; i >= 0; i--)
-        *short_curipos[i] = short_bakipos[i];
+    short_interpolations.Restore();
 }
 
 END_SW_NS
@@ -42,6 +42,7 @@ Prepared for public release: 03/28/2005 - Charlie Wiederhold, 3D Realms
 
 #include "common_game.h"
 #include "gamecontrol.h"
+#include "timedemo.h"
 #include "trigger.h"
 
 #include "savedef.h"
@@ -7878,6 +7879,7 @@ void PauseMultiPlay(void)
 void
 domovethings(void)
 {
+    FTimeDemoSection timedemo(TDS_Game);
     extern SWBOOL DebugAnim;
 #if DEBUG
     extern SWBOOL DebugPanel;
@@ -8322,7 +8324,7 @@ InitMultiPlayerInfo(void)
         ASSERT(start0 >= 0);
         if (User[start0])
         {
-            FreeMem(User[start0]);
+            UserPool.Free(User[start0]);
             User[start0] = NULL;
         }
         sprite[start0].picnum = ST1;
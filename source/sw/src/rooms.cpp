@@ -24,6 +24,7 @@ Prepared for public release: 03/28/2005 - Charlie Wiederhold, 3D Realms
 */
 //-------------------------------------------------------------------------
 #include "ns.h"
+#include <algorithm>
 #include "build.h"
 
 #include "names2.h"
@@ -760,14 +761,127 @@ updatesectorz(int x, int y, int z, short *sectnum)
 
 short GlobStackSect[2];
 
+static SWBOOL
+FAF_SectorHasLevel(short sectnum, short match)
+{
+    short SpriteNum, Next;
+    SPRITEp sp;
+
+    TRAVERSE_SPRITE_SECT(headspritesect[sectnum], SpriteNum, Next)
+    {
+        sp = &sprite[SpriteNum];
+
+        if (sp->statnum == STAT_FAF &&
+            (sp->hitag >= VIEW_LEVEL1 && sp->hitag <= VIEW_LEVEL6)
+            && sp->lotag == match)
+        {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+// Sectors holding a VIEW_LEVEL marker, grouped by match tag and sorted like
+// the scan over all sectors. Built on first use once the level's markers
+// have been moved to STAT_FAF by SpriteSetup, and invalidated whenever a
+// level is set up, terminated or loaded from a savegame. The markers are
+// placed by the map and never move between sectors, which debug builds
+// check against the sectors recorded here.
+static TMap<int, TArray<short>> FAFLevelSectors;
+struct FAFLevelMarker
+{
+    short SpriteNum, sectnum;
+};
+static TArray<FAFLevelMarker> FAFLevelMarkers;
+static SWBOOL FAFLevelSectorsValid;
+
+void
+FAF_InvalidateLevelSectors(void)
+{
+    FAFLevelSectorsValid = FALSE;
+}
+
+static SWBOOL
+FAF_LevelMarkersUnmoved(void)
+{
+    for (auto &marker : FAFLevelMarkers)
+    {
+        if (sprite[marker.SpriteNum].statnum != STAT_FAF || sprite[marker.SpriteNum].sectnum != marker.sectnum)
+            return FALSE;
+    }
+    return TRUE;
+}
+
+static TArray<short> *
+FAF_GetLevelSectors(short match)
+{
+    if (!FAFLevelSectorsValid)
+    {
+        short i, nexti;
+        SPRITEp sp;
+
+        FAFLevelSectors.Clear();
+        FAFLevelMarkers.Clear();
+        TRAVERSE_SPRITE_STAT(headspritestat[STAT_FAF], i, nexti)
+        {
+            sp = &sprite[i];
+
+            if (sp->hitag >= VIEW_LEVEL1 && sp->hitag <= VIEW_LEVEL6 && sp->sectnum >= 0)
+            {
+                auto &list = FAFLevelSectors[sp->lotag];
+                if (list.Find(sp->sectnum) == list.Size())
+                    list.Push(sp->sectnum);
+                FAFLevelMarkers.Push({ i, sp->sectnum });
+            }
+        }
+
+        decltype(FAFLevelSectors)::Iterator it(FAFLevelSectors);
+        decltype(FAFLevelSectors)::Pair *pair;
+        while (it.NextPair(pair))
+            std::sort(pair->Value.begin(), pair->Value.end(), [](short a, short b) { return a > b; });
+
+        FAFLevelSectorsValid = TRUE;
+    }
+
+    ASSERT(FAF_LevelMarkersUnmoved());
+    return FAFLevelSectors.CheckKey(match);
+}
+
+// Collects the sectors containing (x, y) that hold a VIEW_LEVEL marker for
+// match, in descending sector order. Returns how many there are, even if
+// that is more than maxlist.
+static int
+FAF_FindLevelSectors(short match, int x, int y, short *list, int maxlist)
+{
+    auto candidates = FAF_GetLevelSectors(match);
+    int sln = 0;
+
+    if (!candidates)
+        return 0;
+
+    for (short sectnum : *candidates)
+    {
+        if (!sectorGridInBox(sectnum, x, y) || inside(x, y, sectnum) != 1)
+            continue;
+
+        if (!FAF_SectorHasLevel(sectnum, match))
+            continue;
+
+        if (sln < maxlist)
+            list[sln] = sectnum;
+        sln++;
+    }
+
+    return sln;
+}
+
 void
 GetUpperLowerSector(short match, int x, int y, short *upper, short *lower)
 {
     int i;
     short sectorlist[16];
     int sln = 0;
-    short SpriteNum, Next;
-    SPRITEp sp;
 
     // keep a list of the last stacked sectors the view was in and
     // check those fisrt
@@ -777,21 +891,7 @@ GetUpperLowerSector(short match, int x, int y, short *upper, short *lower)
         // will not hurt if GlobStackSect is invalid - inside checks for this
         if (inside(x, y, GlobStackSect[i]) == 1)
         {
-            SWBOOL found = FALSE;
-
-            TRAVERSE_SPRITE_SECT(headspritesect[GlobStackSect[i]], SpriteNum, Next)
-            {
-                sp = &sprite[SpriteNum];
-
-                if (sp->statnum == STAT_FAF &&
-                    (sp->hitag >= VIEW_LEVEL1 && sp->hitag <= VIEW_LEVEL6)
-                    && sp->lotag == match)
-                {
-                    found = TRUE;
-                }
-            }
-
-            if (!found)
+            if (!FAF_SectorHasLevel(GlobStackSect[i], match))
                 continue;
 
             sectorlist[sln] = GlobStackSect[i];
@@ -799,38 +899,13 @@ GetUpperLowerSector(short match, int x, int y, short *upper, short *lower)
         }
     }
 
-    // didn't find it yet so test ALL sectors
+    // didn't find it yet so test all sectors that can match
     if (sln < 2)
     {
-        sln = 0;
-        for (i = numsectors - 1; i >= 0; i--)
-        {
-            if (inside(x, y, (short) i) == 1)
-            {
-                SWBOOL found = FALSE;
+        sln = FAF_FindLevelSectors(match, x, y, sectorlist, SIZ(sectorlist));
 
-                TRAVERSE_SPRITE_SECT(headspritesect[i], SpriteNum, Next)
-                {
-                    sp = &sprite[SpriteNum];
-
-                    if (sp->statnum == STAT_FAF &&
-                        (sp->hitag >= VIEW_LEVEL1 && sp->hitag <= VIEW_LEVEL6)
-                        && sp->lotag == match)
-                    {
-                        found = TRUE;
-                    }
-                }
-
-                if (!found)
-                    continue;
-
-                if (sln < (int)SIZ(GlobStackSect))
-                    GlobStackSect[sln] = i;
-                if (sln < (int)SIZ(sectorlist))
-                    sectorlist[sln] = i;
-                sln++;
-            }
-        }
+        for (i = 0; i < sln && i < (int)SIZ(GlobStackSect); i++)
+            GlobStackSect[i] = sectorlist[i];
     }
 
     // might not find ANYTHING if not tagged right
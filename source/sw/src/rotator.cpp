@@ -411,6 +411,7 @@ int DoRotatorMove(short SpriteNum)
     endwall = startwall + sector[sp->sectnum].wallnum - 1;
 
     // move points
+    sectorGridBeginUpdate();
     for (w = startwall, ndx = 0; w <= endwall; w++)
     {
         vec2_t const orig = { r->origx[ndx], r->origy[ndx] };
@@ -419,6 +420,7 @@ int DoRotatorMove(short SpriteNum)
         dragpoint(w, nxy.x, nxy.y, 0);
         ndx++;
     }
+    sectorGridEndUpdate();
 
     if (kill)
     {
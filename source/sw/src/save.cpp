@@ -210,6 +210,59 @@ int LoadSymCodeInfo(MFILE_READ fil, void **ptr)
     return Saveable_RestoreCodeSym(&sym, ptr);
 }
 
+// The interpolations are stored in the layout of the original fixed size
+// arrays, whose counter had the same type as the values.
+template <typename T>
+static int SaveInterpolations(MFILE_WRITE fil, TInterpolator<T> &interp, int maxcount)
+{
+    T count = (T)interp.Size();
+    TArray<T> oldvals(maxcount, true), bakvals(maxcount, true);
+    int i, saveisshot = 0;
+
+    memset(oldvals.Data(), 0, maxcount * sizeof(T));
+    memset(bakvals.Data(), 0, maxcount * sizeof(T));
+    for (i = 0; i < count; i++)
+    {
+        oldvals[i] = interp.GetOldValue(i);
+        bakvals[i] = interp.GetBackupValue(i);
+    }
+
+    MWRITE(&count,sizeof(count),1,fil);
+    MWRITE(oldvals.Data(),sizeof(T),maxcount,fil);
+    MWRITE(bakvals.Data(),sizeof(T),maxcount,fil);
+    for (i = count - 1; i >= 0; i--)
+        saveisshot |= SaveSymDataInfo(fil, interp.GetPointer(i));
+
+    return saveisshot;
+}
+
+template <typename T>
+static int LoadInterpolations(MFILE_READ fil, TInterpolator<T> &interp, int maxcount)
+{
+    T count = 0;
+    TArray<T> oldvals(maxcount, true), bakvals(maxcount, true);
+    TArray<T *> pointers(maxcount, true);
+    int i, saveisshot = 0;
+
+    MREAD(&count,sizeof(count),1,fil);
+    MREAD(oldvals.Data(),sizeof(T),maxcount,fil);
+    MREAD(bakvals.Data(),sizeof(T),maxcount,fil);
+    if (count < 0 || count > maxcount)
+        return 1;
+
+    for (i = count - 1; i >= 0; i--)
+        saveisshot |= LoadSymDataInfo(fil, (void **)&pointers[i]);
+
+    interp.Clear();
+    if (!saveisshot)
+    {
+        for (i = 0; i < count; i++)
+            interp.Add(pointers[i], oldvals[i], bakvals[i]);
+    }
+
+    return saveisshot;
+}
+
 
 
 bool GameInterface::SaveGame(FSaveGameNode *sv)
@@ -593,24 +646,12 @@ bool GameInterface::SaveGame(FSaveGameNode *sv)
     MWRITE(&MoveSkip8,sizeof(MoveSkip8),1,fil);
 
     // long interpolations
-    MWRITE(&numinterpolations,sizeof(numinterpolations),1,fil);
-    MWRITE(oldipos,sizeof(oldipos),1,fil);
-    MWRITE(bakipos,sizeof(bakipos),1,fil);
-    for (i = numinterpolations - 1; i >= 0; i--)
-    {
-        saveisshot |= SaveSymDataInfo(fil, curipos[i]);
-        assert(!saveisshot);
-    }
+    saveisshot |= SaveInterpolations(fil, interpolations, MAXINTERPOLATIONS);
+    assert(!saveisshot);
 
     // short interpolations
-    MWRITE(&short_numinterpolations,sizeof(short_numinterpolations),1,fil);
-    MWRITE(short_oldipos,sizeof(short_oldipos),1,fil);
-    MWRITE(short_bakipos,sizeof(short_bakipos),1,fil);
-    for (i = short_numinterpolations - 1; i >= 0; i--)
-    {
-        saveisshot |= SaveSymDataInfo(fil, short_curipos[i]);
-        assert(!saveisshot);
-    }
+    saveisshot |= SaveInterpolations(fil, short_interpolations, SHORT_MAXINTERPOLATIONS);
+    assert(!saveisshot);
 
     // SO interpolations
 	saveisshot |= so_writeinterpolations(fil);
@@ -801,23 +842,26 @@ bool GameInterface::LoadGame(FSaveGameNode* sv)
 #endif
 
     //Sector User information
+    memset(SectUser, 0, sizeof(SectUser));
+    SectUserPool.Clear();
     for (i = 0; i < numsectors; i++)
     {
         MREAD(&sectnum,sizeof(sectnum),1,fil);
         if (sectnum != -1)
         {
-            SectUser[sectnum] = sectu = (SECT_USERp)CallocMem(sizeof(SECT_USER), 1);
+            SectUser[sectnum] = sectu = SectUserPool.Alloc(sectnum);
             MREAD(sectu,sizeof(SECT_USER),1,fil);
         }
     }
 
     //User information
     memset(User, 0, sizeof(User));
+    UserPool.Clear();
 
     MREAD(&SpriteNum, sizeof(SpriteNum),1,fil);
     while (SpriteNum != -1)
     {
-        User[SpriteNum] = u = (USERp)CallocMem(sizeof(USER), 1);
+        User[SpriteNum] = u = UserPool.Alloc(SpriteNum);
         MREAD(u,sizeof(USER),1,fil);
 
         if (u->WallShade)
@@ -980,19 +1024,11 @@ bool GameInterface::LoadGame(FSaveGameNode* sv)
     MREAD(&MoveSkip8,sizeof(MoveSkip8),1,fil);
 
     // long interpolations
-    MREAD(&numinterpolations,sizeof(numinterpolations),1,fil);
-    MREAD(oldipos,sizeof(oldipos),1,fil);
-    MREAD(bakipos,sizeof(bakipos),1,fil);
-    for (i = numinterpolations - 1; i >= 0; i--)
-        saveisshot |= LoadSymDataInfo(fil, (void **)&curipos[i]);
+    saveisshot |= LoadInterpolations(fil, interpolations, MAXINTERPOLATIONS);
     if (saveisshot) { MCLOSE_READ(fil); return false; }
 
     // short interpolations
-    MREAD(&short_numinterpolations,sizeof(short_numinterpolations),1,fil);
-    MREAD(short_oldipos,sizeof(short_oldipos),1,fil);
-    MREAD(short_bakipos,sizeof(short_bakipos),1,fil);
-    for (i = short_numinterpolations - 1; i >= 0; i--)
-        saveisshot |= LoadSymDataInfo(fil, (void **)&short_curipos[i]);
+    saveisshot |= LoadInterpolations(fil, short_interpolations, SHORT_MAXINTERPOLATIONS);
     if (saveisshot) { MCLOSE_READ(fil); return false; }
 
     // SO interpolations
@@ -1135,6 +1171,7 @@ bool GameInterface::LoadGame(FSaveGameNode* sv)
         PlayClock = SavePlayClock;
     }
     InitNetVars();
+    FAF_InvalidateLevelSectors();
 
     SetupAspectRatio();
     SetRedrawScreen(Player + myconnectindex);
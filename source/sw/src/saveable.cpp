@@ -23,15 +23,104 @@
 
 #include "ns.h"
 
+#include <algorithm>
+#include <set>
 #include "compat.h"
 #include "tarray.h"
 #include "debugbreak.h"
+#ifdef _DEBUG
+#include "c_dispatch.h"
+#include "printf.h"
+#include "v_text.h"
+#include "stats.h"
+#endif
 BEGIN_SW_NS
 
 #include "saveable.h"
 
 static TArray<saveable_module*> saveablemodules;
 
+// Lookup tables built by Saveable_Init, so that saving doesn't have to scan
+// every module's tables for each pointer. Both return the same symbol the
+// linear scan would, i.e. the first one in module and table order.
+struct codesymentry
+{
+    void *ptr;
+    unsigned int module, index;
+
+    bool operator<(const codesymentry &other) const
+    {
+        if (ptr != other.ptr) return ptr < other.ptr;
+        if (module != other.module) return module < other.module;
+        return index < other.index;
+    }
+};
+
+// The data tables are split into segments at every start and end of a table
+// entry. Each segment stores the first entry covering it, or module 0 if none.
+struct datasegment
+{
+    uintptr_t start;
+    unsigned int module, index;
+};
+
+static TArray<codesymentry> codesymindex;
+static TArray<datasegment> datasymindex;
+
+static void Saveable_BuildIndex(void)
+{
+    codesymindex.Clear();
+    datasymindex.Clear();
+
+    struct dataevent
+    {
+        uintptr_t pos;
+        bool start;
+        unsigned int module, index;
+    };
+    TArray<dataevent> events;
+
+    for (unsigned m = 0; m < saveablemodules.Size(); m++)
+    {
+        auto module = saveablemodules[m];
+
+        for (unsigned i = 0; i < module->numcode; i++)
+            codesymindex.Push({ module->code[i], 1+m, i });
+
+        for (unsigned i = 0; i < module->numdata; i++)
+        {
+            if (module->data[i].size == 0) continue;
+            uintptr_t const base = (uintptr_t)module->data[i].base;
+            events.Push({ base, true, 1+m, i });
+            events.Push({ base + module->data[i].size, false, 1+m, i });
+        }
+    }
+
+    std::sort(codesymindex.begin(), codesymindex.end());
+    std::sort(events.begin(), events.end(), [](const dataevent &a, const dataevent &b) { return a.pos < b.pos; });
+
+    std::set<std::pair<unsigned int, unsigned int>> active;
+
+    for (unsigned e = 0; e < events.Size();)
+    {
+        uintptr_t const pos = events[e].pos;
+
+        for (; e < events.Size() && events[e].pos == pos; e++)
+        {
+            auto const key = std::make_pair(events[e].module, events[e].index);
+            if (events[e].start)
+                active.insert(key);
+            else
+                active.erase(key);
+        }
+
+        if (active.empty())
+            datasymindex.Push({ pos, 0, 0 });
+        else
+            datasymindex.Push({ pos, active.begin()->first, active.begin()->second });
+    }
+}
+
 void Saveable_Init(void)
 {
     if (saveablemodules.Size() > 0) return;
@@ -80,9 +169,13 @@ void Saveable_Init(void)
 
     MODULE(sector)
     MODULE(text)
+
+    Saveable_BuildIndex();
 }
 
-int Saveable_FindCodeSym(void *ptr, savedcodesym *sym)
+#ifdef _DEBUG
+// The lookups before the index, kept as the reference for bench_saveable.
+static int Saveable_FindCodeSymLinear(void *ptr, savedcodesym *sym)
 {
     unsigned m,i;
 
@@ -106,11 +199,10 @@ int Saveable_FindCodeSym(void *ptr, savedcodesym *sym)
         }
     }
 
-    debug_break();
     return -1;
 }
 
-int Saveable_FindDataSym(void *ptr, saveddatasym *sym)
+static int Saveable_FindDataSymLinear(void *ptr, saveddatasym *sym)
 {
     unsigned m,i;
 
@@ -138,9 +230,63 @@ int Saveable_FindDataSym(void *ptr, saveddatasym *sym)
         }
     }
 
-    debug_break();
     return -1;
 }
+#endif
+
+int Saveable_FindCodeSym(void *ptr, savedcodesym *sym)
+{
+    if (!ptr)
+    {
+        sym->module = 0;    // module 0 is the "null module" for null pointers
+        sym->index  = 0;
+        return 0;
+    }
+
+    codesymentry const key = { ptr, 0, 0 };
+    auto const end = codesymindex.Data() + codesymindex.Size();
+    auto const entry = std::lower_bound(codesymindex.Data(), end, key);
+
+    if (entry == end || entry->ptr != ptr)
+    {
+        debug_break();
+        return -1;
+    }
+
+    sym->module = entry->module;
+    sym->index  = entry->index;
+
+    return 0;
+}
+
+int Saveable_FindDataSym(void *ptr, saveddatasym *sym)
+{
+    if (!ptr)
+    {
+        sym->module = 0;
+        sym->index  = 0;
+        sym->offset = 0;
+        return 0;
+    }
+
+    // The last segment starting at or before ptr.
+    auto const segment = std::upper_bound(datasymindex.Data(), datasymindex.Data() + datasymindex.Size(), (uintptr_t)ptr,
+                                          [](uintptr_t p, const datasegment &seg) { return p < seg.start; });
+
+    if (segment == datasymindex.Data() || segment[-1].module == 0)
+    {
+        debug_break();
+        return -1;
+    }
+
+    auto const &seg = segment[-1];
+
+    sym->module = seg.module;
+    sym->index  = seg.index;
+    sym->offset = (intptr_t)ptr - (intptr_t)saveablemodules[seg.module-1]->data[seg.index].base;
+
+    return 0;
+}
 
 int Saveable_RestoreCodeSym(savedcodesym *sym, void **ptr)
 {
@@ -194,4 +340,107 @@ int Saveable_RestoreDataSym(saveddatasym *sym, void **ptr)
 
     return 0;
 }
+
+#ifdef _DEBUG
+//
+// bench_saveable
+//
+// Resolves every code symbol and a few addresses inside every data symbol
+// with both the linear scan and the index, and checks that both agree.
+// Then times the full round trip a save and load put each pointer through,
+// symbol lookup followed by restoring it, and checks that every pointer
+// comes back unchanged.
+//
+CCMD(bench_saveable)
+{
+    Saveable_Init();
+
+    int const repeats = argv.argc() > 1 ? max(1, (int)strtol(argv[1], nullptr, 10)) : 10;
+    TArray<void *> codeptrs, dataptrs;
+
+    for (auto module : saveablemodules)
+    {
+        for (unsigned i = 0; i < module->numcode; i++)
+            codeptrs.Push(module->code[i]);
+
+        for (unsigned i = 0; i < module->numdata; i++)
+        {
+            auto const base = (char *)module->data[i].base;
+            auto const size = module->data[i].size;
+            if (size == 0) continue;
+            dataptrs.Push(base);
+            dataptrs.Push(base + size / 2);
+            dataptrs.Push(base + size - 1);
+        }
+    }
+
+    cycle_t lineartime, indextime;
+    lineartime.Reset();
+    indextime.Reset();
+
+    TArray<savedcodesym> linearcode(codeptrs.Size(), true), indexcode(codeptrs.Size(), true);
+    TArray<saveddatasym> lineardata(dataptrs.Size(), true), indexdata(dataptrs.Size(), true);
+
+    lineartime.Clock();
+    for (int r = 0; r < repeats; r++)
+    {
+        for (unsigned i = 0; i < codeptrs.Size(); i++)
+            Saveable_FindCodeSymLinear(codeptrs[i], &linearcode[i]);
+        for (unsigned i = 0; i < dataptrs.Size(); i++)
+            Saveable_FindDataSymLinear(dataptrs[i], &lineardata[i]);
+    }
+    lineartime.Unclock();
+
+    indextime.Clock();
+    for (int r = 0; r < repeats; r++)
+    {
+        for (unsigned i = 0; i < codeptrs.Size(); i++)
+            Saveable_FindCodeSym(codeptrs[i], &indexcode[i]);
+        for (unsigned i = 0; i < dataptrs.Size(); i++)
+            Saveable_FindDataSym(dataptrs[i], &indexdata[i]);
+    }
+    indextime.Unclock();
+
+    int mismatches = 0;
+    for (unsigned i = 0; i < codeptrs.Size(); i++)
+        if (linearcode[i].module != indexcode[i].module || linearcode[i].index != indexcode[i].index)
+            mismatches++;
+    for (unsigned i = 0; i < dataptrs.Size(); i++)
+        if (lineardata[i].module != indexdata[i].module || lineardata[i].index != indexdata[i].index || lineardata[i].offset != indexdata[i].offset)
+            mismatches++;
+
+    cycle_t roundtriptime;
+    roundtriptime.Reset();
+    int roundtriperrors = 0;
+
+    roundtriptime.Clock();
+    for (int r = 0; r < repeats; r++)
+    {
+        for (unsigned i = 0; i < codeptrs.Size(); i++)
+        {
+            savedcodesym sym;
+            void *ptr = nullptr;
+            if (Saveable_FindCodeSym(codeptrs[i], &sym) || Saveable_RestoreCodeSym(&sym, &ptr) || ptr != codeptrs[i])
+                roundtriperrors++;
+        }
+        for (unsigned i = 0; i < dataptrs.Size(); i++)
+        {
+            saveddatasym sym;
+            void *ptr = nullptr;
+            if (Saveable_FindDataSym(dataptrs[i], &sym) || Saveable_RestoreDataSym(&sym, &ptr) || ptr != dataptrs[i])
+                roundtriperrors++;
+        }
+    }
+    roundtriptime.Unclock();
+
+    Printf("bench_saveable: %u code and %u data pointers x %d\n", codeptrs.Size(), dataptrs.Size(), repeats);
+    Printf("  linear scan: %.3f ms\n", lineartime.TimeMS());
+    Printf("  index:       %.3f ms\n", indextime.TimeMS());
+    Printf("  round trip:  %.3f ms\n", roundtriptime.TimeMS());
+    if (mismatches)
+        Printf(TEXTCOLOR_RED "  %d mismatches!\n", mismatches);
+    if (roundtriperrors)
+        Printf(TEXTCOLOR_RED "  %d pointers did not survive the round trip!\n", roundtriperrors);
+}
+#endif
 END_SW_NS
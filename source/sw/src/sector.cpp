@@ -48,6 +48,7 @@ Prepared for public release: 03/28/2005 - Charlie Wiederhold, 3D Realms
 #include "text.h"
 #include "gstrings.h"
 #include "secrets.h"
+#include "stats.h"
 
 BEGIN_SW_NS
 
@@ -90,6 +91,19 @@ int lavaradx[32][128], lavarady[32][128], lavaradcnt[32];
 SECT_USERp SectUser[MAXSECTORS];
 USERp User[MAXSPRITES];
 
+// USER and SECT_USER records are kept in the slot of their sprite or sector.
+TSidePool<USER, MAXSPRITES> UserPool;
+TSidePool<SECT_USER, MAXSECTORS> SectUserPool;
+
+ADD_STAT(swpools)
+{
+    FString out;
+    out.Format("User: %d used, %d peak, highest slot %d, %u allocs  SectUser: %d used, %d peak, highest slot %d",
+        UserPool.GetNumUsed(), UserPool.GetHighWater(), UserPool.GetHighestSlot(), UserPool.GetAllocations(),
+        SectUserPool.GetNumUsed(), SectUserPool.GetHighWater(), SectUserPool.GetHighestSlot());
+    return out;
+}
+
 ANIM Anim[MAXANIM];
 short AnimCnt = 0;
 
@@ -2840,6 +2854,7 @@ DoSineWaveWall(void)
     int New;
     short sw_num;
 
+    sectorGridBeginUpdate();
     for (sw_num = 0; sw_num < MAX_SINE_WAVE; sw_num++)
     {
         for (sw = &SineWall[sw_num][0]; sw->wall >= 0 && sw < &SineWall[sw_num][MAX_SINE_WALL_POINTS]; sw++)
@@ -2861,6 +2876,7 @@ DoSineWaveWall(void)
             }
         }
     }
+    sectorGridEndUpdate();
 }
 
 void
@@ -387,6 +387,8 @@ int DoSlidorMoveWalls(short SpriteNum, int amt)
     w = startwall = sector[sprite[SpriteNum].sectnum].wallptr;
     endwall = startwall + sector[sprite[SpriteNum].sectnum].wallnum - 1;
 
+    sectorGridBeginUpdate();
+
     do
     {
         switch (wall[w].lotag)
@@ -489,6 +491,9 @@ int DoSlidorMoveWalls(short SpriteNum, int amt)
     }
     while (w != startwall);
 
+    sectorGridUpdateSector(sprite[SpriteNum].sectnum);
+    sectorGridEndUpdate();
+
     return 0;
 }
 
@@ -502,10 +502,7 @@ void InitFX(void)
         }
     }
     soundEngine->HashSounds();
-    for (auto& sfx : S_sfx)
-    {
-        soundEngine->CacheSound(&sfx);
-    }
+    soundEngine->CacheAllSounds();
 }
 
 
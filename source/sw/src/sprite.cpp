@@ -800,7 +800,7 @@ KillSprite(int16_t SpriteNum)
             FreeMem(u->rotator);
         }
 
-        FreeMem(User[SpriteNum]);
+        UserPool.Free(User[SpriteNum]);
         User[SpriteNum] = 0;
     }
 
@@ -891,7 +891,7 @@ SpawnUser(short SpriteNum, short id, STATEp state)
 
     ASSERT(!Prediction);
 
-    User[SpriteNum] = u = (USERp) CallocMem(sizeof(USER), 1);
+    User[SpriteNum] = u = UserPool.Alloc(SpriteNum);
 
     PRODUCTION_ASSERT(u != NULL);
 
@@ -957,7 +957,7 @@ GetSectUser(short sectnum)
     if (SectUser[sectnum])
         return SectUser[sectnum];
 
-    sectu = SectUser[sectnum] = (SECT_USERp) CallocMem(sizeof(SECT_USER), 1);
+    sectu = SectUser[sectnum] = SectUserPool.Alloc(sectnum);
 
     ASSERT(sectu != NULL);
 
@@ -1686,6 +1686,7 @@ void PreMapCombineFloors(void)
                     sectlist[sectlistend++] = nextsector;
             }
 
+            sectorGridUpdateSector(dasect);
         }
 
         TRAVERSE_CONNECT(pnum)
@@ -1826,6 +1827,7 @@ SpriteSetup(void)
 
     // Clear Sprite Extension structure
     memset(&SectUser[0], 0, sizeof(SectUser));
+    SectUserPool.Clear();
 
     // Clear all extra bits - they are set by sprites
     for (i = 0; i < numsectors; i++)
@@ -2916,6 +2918,8 @@ SpriteSetup(void)
                 case VIEW_LEVEL6:
                 {
                     change_sprite_stat(SpriteNum, STAT_FAF);
+                    // actors set up before this one may already have looked up stacked sectors
+                    FAF_InvalidateLevelSectors();
                     break;
                 }
 
@@ -5184,7 +5188,7 @@ DoGrating(short SpriteNum)
         change_sprite_stat(SpriteNum, STAT_DEFAULT);
         if (User[SpriteNum])
         {
-            FreeMem(User[SpriteNum]);
+            UserPool.Free(User[SpriteNum]);
             User[SpriteNum] = 0;
         }
     }
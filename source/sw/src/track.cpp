@@ -1730,6 +1730,8 @@ MovePoints(SECTOR_OBJECTp sop, short delta_ang, int nx, int ny)
     if (TEST(sop->flags, SOBJ_ZMID_FLOOR))
         sop->zmid = sector[sop->mid_sector].floorz;
 
+    sectorGridBeginUpdate();
+
     for (sectp = sop->sectp, j = 0; *sectp; sectp++, j++)
     {
         if (TEST(sop->flags, SOBJ_SPRITE_OBJ | SOBJ_DONT_ROTATE))
@@ -1778,6 +1780,8 @@ MovePoints(SECTOR_OBJECTp sop, short delta_ang, int nx, int ny)
             }
         }
 
+        sectorGridUpdateSector(*sectp - sector);
+
 PlayerPart:
 
         TRAVERSE_CONNECT(pnum)
@@ -1818,6 +1822,8 @@ PlayerPart:
         }
     }
 
+    sectorGridEndUpdate();
+
     for (i = 0; sop->sp_num[i] != -1; i++)
     {
         sp = &sprite[sop->sp_num[i]];
@@ -1969,6 +1975,8 @@ void RefreshPoints(SECTOR_OBJECTp sop, int nx, int ny, SWBOOL dynamic)
     if (dynamic && sop->PreMoveAnimator)
         (*sop->PreMoveAnimator)(sop);
 
+    sectorGridBeginUpdate();
+
     for (sectp = sop->sectp, j = 0; *sectp; sectp++, j++)
     {
         if (!TEST(sop->flags, SOBJ_SPRITE_OBJ))
@@ -2020,9 +2028,13 @@ void RefreshPoints(SECTOR_OBJECTp sop, int nx, int ny, SWBOOL dynamic)
 
                 wallcount++;
             }
+
+            sectorGridUpdateSector(*sectp - sector);
         }
     }
 
+    sectorGridEndUpdate();
+
     if (sop->spin_speed)
     {
         // same as below - ignore the objects angle
@@ -2160,6 +2172,8 @@ CollapseSectorObject(SECTOR_OBJECTp sop, int nx, int ny)
 
     // collapse the SO to a single point
     // move all points to nx,ny
+    sectorGridBeginUpdate();
+
     for (sectp = sop->sectp, j = 0; *sectp; sectp++, j++)
     {
         if (!TEST(sop->flags, SOBJ_SPRITE_OBJ))
@@ -2183,8 +2197,12 @@ CollapseSectorObject(SECTOR_OBJECTp sop, int nx, int ny)
                     wp->y = ny;
                 }
             }
+
+            sectorGridUpdateSector(*sectp - sector);
         }
     }
+
+    sectorGridEndUpdate();
 }
 
 
@@ -20555,7 +20555,7 @@ int QueueStar(short SpriteNum)
         // new star
         if (User[SpriteNum])
         {
-            FreeMem(User[SpriteNum]);
+            UserPool.Free(User[SpriteNum]);
             User[SpriteNum] = NULL;
         }
         change_sprite_stat(SpriteNum, STAT_STAR_QUEUE);
@@ -21074,7 +21074,7 @@ int QueueGeneric(short SpriteNum, short pic)
     {
         if (User[SpriteNum])
         {
-            FreeMem(User[SpriteNum]);
+            UserPool.Free(User[SpriteNum]);
             User[SpriteNum] = NULL;
         }
         change_sprite_stat(SpriteNum, STAT_GENERIC_QUEUE);